@@ -0,0 +1,122 @@
+# Host (desktop Linux) targets for the player core.
+#
+#   cmake -S app/src/main/cpp -B build && cmake --build build
+#
+# Requires FFmpeg 4.x development packages (libavformat, libavcodec, libswresample,
+# libswscale, libavutil) discoverable through pkg-config.
+
+find_package(PkgConfig REQUIRED)
+pkg_check_modules(FFMPEG REQUIRED libavformat libavcodec libswresample libswscale libavutil)
+find_package(Threads REQUIRED)
+
+set(host-core-name ffplayer-core)
+
+include_directories(
+        ${FFMPEG_INCLUDE_DIRS}
+        ${CMAKE_SOURCE_DIR}/util
+        ${CMAKE_SOURCE_DIR}/player
+        ${CMAKE_SOURCE_DIR}/player/decoder
+        ${CMAKE_SOURCE_DIR}/player/render
+        ${CMAKE_SOURCE_DIR}/player/queue
+        ${CMAKE_SOURCE_DIR}/player/sync
+        ${CMAKE_SOURCE_DIR}/player/render/audio
+        ${CMAKE_SOURCE_DIR}/player/render/video
+)
+
+link_directories(${FFMPEG_LIBRARY_DIRS})
+
+set(host-core-files
+        ${CMAKE_SOURCE_DIR}/player/MediaPlayer.cpp
+        ${CMAKE_SOURCE_DIR}/player/decoder/MediaDecoder.cpp
+        ${CMAKE_SOURCE_DIR}/player/decoder/VideoMediaDecoder.cpp
+        ${CMAKE_SOURCE_DIR}/player/decoder/AudioMediaDecoder.cpp
+        ${CMAKE_SOURCE_DIR}/player/decoder/DecoderThreadPolicy.cpp
+        ${CMAKE_SOURCE_DIR}/player/queue/AVPacketQueue.cpp
+        ${CMAKE_SOURCE_DIR}/player/queue/AVFrameQueue.cpp
+        ${CMAKE_SOURCE_DIR}/player/queue/AVPacketPool.cpp
+        ${CMAKE_SOURCE_DIR}/player/sync/MediaSync.cpp
+        ${CMAKE_SOURCE_DIR}/player/sync/Clock.cpp
+        ${CMAKE_SOURCE_DIR}/player/render/video/HeadlessRender.cpp
+        ${CMAKE_SOURCE_DIR}/player/render/video/VideoBufferPool.cpp
+        ${CMAKE_SOURCE_DIR}/player/render/video/RenderFrameBuffer.cpp
+        ${CMAKE_SOURCE_DIR}/player/render/audio/WavFileRender.cpp
+        ${CMAKE_SOURCE_DIR}/util/TraceRecorder.cpp)
+
+add_library(${host-core-name} STATIC ${host-core-files})
+
+target_link_libraries(${host-core-name}
+        ${FFMPEG_LIBRARIES}
+        ${CMAKE_THREAD_LIBS_INIT}
+        m
+        )
+
+add_executable(host-player ${CMAKE_SOURCE_DIR}/tools/HostPlayer.cpp)
+target_link_libraries(host-player ${host-core-name})
+
+# 流水线吞吐基准：pipeline-benchmark [-o result.json] [-p] <file|dir> ...
+add_executable(pipeline-benchmark ${CMAKE_SOURCE_DIR}/tools/PipelineBenchmark.cpp)
+target_link_libraries(pipeline-benchmark ${host-core-name})
+
+# 单元测试：ctest --test-dir build
+enable_testing()
+
+# CPU 颜色转换（NativeRender 使用），行内核在运行时按 CPU 选择 NEON/AVX2/SSE2/C。
+# yuv-converter-test 把当前机器支持的每个 SIMD 实现与 C 实现逐字节对比；
+# NEON 实现只能在 ARM 主机上运行，目前尚未经过该测试验证
+add_library(ffplayer-yuv STATIC ${CMAKE_SOURCE_DIR}/util/YuvConverter.cpp)
+target_link_libraries(ffplayer-yuv m)
+
+add_executable(yuv-converter-test ${CMAKE_SOURCE_DIR}/tools/YuvConverterTest.cpp)
+target_link_libraries(yuv-converter-test ffplayer-yuv)
+add_test(NAME yuv-converter COMMAND yuv-converter-test)
+
+# 同步线程与 GL 线程之间的三缓冲：20 万帧压力下不撕裂、不回退，解码缓冲引用全部归还
+add_executable(render-frame-buffer-test ${CMAKE_SOURCE_DIR}/tools/RenderFrameBufferTest.cpp)
+target_link_libraries(render-frame-buffer-test ${host-core-name})
+add_test(NAME render-frame-buffer COMMAND render-frame-buffer-test)
+
+# 视频帧缓冲池：同一段视频打开/关闭 PLAYER_OPTION_VIDEO_BUFFER_POOL 各解码一遍，输出逐字节一致。
+# 测试短片在运行时用 FFmpeg 的 MPEG-4 编码器生成
+add_executable(video-buffer-pool-test ${CMAKE_SOURCE_DIR}/tools/VideoBufferPoolTest.cpp)
+target_link_libraries(video-buffer-pool-test ${host-core-name})
+add_test(NAME video-buffer-pool COMMAND video-buffer-pool-test)
+
+# VR 球面网格：三角形带展开后与原三角形列表逐个对比。只用到 GLES3 头文件中的类型，不需要链接 GL 库
+find_path(GLES3_INCLUDE_DIR GLES3/gl3.h)
+if(GLES3_INCLUDE_DIR)
+    add_executable(sphere-mesh-test
+            ${CMAKE_SOURCE_DIR}/tools/SphereMeshTest.cpp
+            ${CMAKE_SOURCE_DIR}/player/render/video/SphereMesh.cpp)
+    target_include_directories(sphere-mesh-test PRIVATE ${GLES3_INCLUDE_DIR} ${CMAKE_SOURCE_DIR}/glm)
+    add_test(NAME sphere-mesh COMMAND sphere-mesh-test)
+endif()
+
+# GL 渲染路径的离屏测试，用 Mesa 的 surfaceless EGL 平台（llvmpipe 软件渲染即可），不需要窗口系统。
+# 没有 EGL/GLESv2 开发包时不生成，运行环境没有可用平台时测试记为跳过
+find_library(EGL_LIBRARY EGL)
+find_library(GLESV2_LIBRARY GLESv2)
+if(EGL_LIBRARY AND GLESV2_LIBRARY)
+    set(host-gl-name ffplayer-gl)
+    add_library(${host-gl-name} STATIC
+            ${CMAKE_SOURCE_DIR}/player/render/video/VideoTextureUploader.cpp
+            ${CMAKE_SOURCE_DIR}/player/render/video/VideoProgramCache.cpp
+            ${CMAKE_SOURCE_DIR}/util/GLUtils.cpp)
+    target_include_directories(${host-gl-name} PUBLIC ${CMAKE_SOURCE_DIR}/glm)
+    target_link_libraries(${host-gl-name} ${EGL_LIBRARY} ${GLESV2_LIBRARY})
+
+    # 视频纹理上传逐字节校验：RGBA/NV12/NV21/I420，紧凑/带填充/奇数行宽
+    add_executable(video-texture-uploader-test ${CMAKE_SOURCE_DIR}/tools/VideoTextureUploaderTest.cpp)
+    target_link_libraries(video-texture-uploader-test ${host-gl-name})
+    add_test(NAME video-texture-uploader COMMAND video-texture-uploader-test)
+    set_tests_properties(video-texture-uploader PROPERTIES
+            ENVIRONMENT EGL_PLATFORM=surfaceless
+            SKIP_RETURN_CODE 77)
+
+    # 程序二进制缓存：冷启动未命中、再次命中、文件截断或损坏时回退编译
+    add_executable(program-binary-cache-test ${CMAKE_SOURCE_DIR}/tools/ProgramBinaryCacheTest.cpp)
+    target_link_libraries(program-binary-cache-test ${host-gl-name})
+    add_test(NAME program-binary-cache COMMAND program-binary-cache-test)
+    set_tests_properties(program-binary-cache PROPERTIES
+            ENVIRONMENT EGL_PLATFORM=surfaceless
+            SKIP_RETURN_CODE 77)
+endif()
@@ -10,6 +10,8 @@
 #include <render/audio/OpenSLRender.h>
 #include <libavcodec/jni.h>
 #include "util/LogUtil.h"
+#include "util/TraceRecorder.h"
+#include "util/GLUtils.h"
 #include "jni.h"
 
 extern "C" {
@@ -87,11 +89,12 @@ JNIEXPORT void JNICALL Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_
 
 JNIEXPORT void JNICALL
 Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1SeekToPosition(JNIEnv *env, jobject thiz,
-                                                                      jlong player_handle, jfloat position) {
+                                                                      jlong player_handle, jfloat position,
+                                                                      jint seek_mode) {
     if(player_handle != 0)
     {
         MediaPlayer *ffMediaPlayer = reinterpret_cast<MediaPlayer *>(player_handle);
-        ffMediaPlayer->SeekToPosition(position);
+        ffMediaPlayer->SeekToPosition(position, seek_mode);
     }
 }
 
@@ -108,6 +111,40 @@ Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1GetMediaParams(JNIEnv
     return value;
 }
 
+/*
+ * Class:     com_byteflow_learnffmpeg_media_FFMediaPlayer
+ * Method:    native_GetStatsSnapshot
+ * Signature: (J)[J
+ * 布局：PLAYER_COUNTER_COUNT 个计数器，随后每个阶段 PLAYER_STAGE_STAT_NUM 个统计值
+ */
+JNIEXPORT jlongArray JNICALL
+Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1GetStatsSnapshot(JNIEnv *env, jobject thiz,
+                                                                           jlong player_handle) {
+    PlayerStatsSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    if(player_handle != 0)
+    {
+        MediaPlayer *ffMediaPlayer = reinterpret_cast<MediaPlayer *>(player_handle);
+        ffMediaPlayer->GetStatsSnapshot(&snapshot);
+    }
+
+    const int counterNum = PLAYER_COUNTER_COUNT;
+    const int stageNum = PLAYER_STAGE_COUNT * PLAYER_STAGE_STAT_NUM;
+    jlong values[counterNum + stageNum];
+    for (int i = 0; i < counterNum; ++i) {
+        values[i] = snapshot.counters[i];
+    }
+    for (int i = 0; i < stageNum; ++i) {
+        values[counterNum + i] = snapshot.stages[i / PLAYER_STAGE_STAT_NUM][i % PLAYER_STAGE_STAT_NUM];
+    }
+
+    jlongArray result = env->NewLongArray(counterNum + stageNum);
+    if(result != nullptr) {
+        env->SetLongArrayRegion(result, 0, counterNum + stageNum, values);
+    }
+    return result;
+}
+
 /*
  * Class:     com_byteflow_learnffmpeg_media_FFMediaPlayer
  * Method:    native_Pause
@@ -255,6 +292,35 @@ Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1SetTouchLoc(JNIEnv *en
     }
 }
 
+JNIEXPORT void JNICALL
+Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1SetTraceEnabled(JNIEnv *env, jclass clazz,
+                                                                          jboolean enabled) {
+    TraceRecorder::GetInstance()->SetEnabled(enabled);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1DumpTrace(JNIEnv *env, jclass clazz,
+                                                                    jstring jpath) {
+    if (jpath == nullptr) return -1;
+    const char* path = env->GetStringUTFChars(jpath, nullptr);
+    if (path == nullptr) return -1;
+    int result = TraceRecorder::GetInstance()->DumpChromeTrace(path);
+    env->ReleaseStringUTFChars(jpath, path);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_byteflow_learnffmpeg_media_FFMediaPlayer_native_1SetProgramCacheDir(JNIEnv *env, jclass clazz,
+                                                                             jstring jdir) {
+    if (jdir == nullptr) {
+        GLUtils::SetProgramCacheDir(nullptr);
+        return;
+    }
+    const char* dir = env->GetStringUTFChars(jdir, nullptr);
+    GLUtils::SetProgramCacheDir(dir);
+    env->ReleaseStringUTFChars(jdir, dir);
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
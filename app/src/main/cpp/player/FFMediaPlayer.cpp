@@ -104,7 +104,7 @@ void FFMediaPlayer::SeekToPosition(float position) {
 }
 
 long FFMediaPlayer::GetMediaParams(int paramType) {
-    LOGCATE("FFMediaPlayer::GetMediaParams paramType=%d", paramType);
+    LOGCATV("FFMediaPlayer::GetMediaParams paramType=%d", paramType);
     long value = 0;
     switch(paramType)
     {
@@ -155,7 +155,7 @@ void FFMediaPlayer::PostMessage(void *context, int msgType, float msgCode) {
         FFMediaPlayer *player = static_cast<FFMediaPlayer *>(context);
         bool isAttach = false;
         JNIEnv *env = player->GetJNIEnv(&isAttach);
-        LOGCATE("FFMediaPlayer::PostMessage env=%p", env);
+        LOGCATT("FFMediaPlayer::PostMessage env=%p", env);
         if(env == nullptr)
             return;
         jobject javaObj = player->GetJavaObj();
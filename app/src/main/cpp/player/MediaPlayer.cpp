@@ -2,26 +2,52 @@
 // Created by 字节流动 on 2020/10/17.
 //
 
+#ifdef __ANDROID__
 #include <render/video/NativeRender.h>
 #include <render/audio/OpenSLRender.h>
 #include <render/video/VideoGLRender.h>
 #include <render/video/VRGLRender.h>
+#endif
+#include <TraceRecorder.h>
 #include "MediaPlayer.h"
 
+MediaPlayer::MediaPlayer() {
+    m_PlayerState = new PlayerState();
+}
+
+MediaPlayer::~MediaPlayer() {
+    if(m_PlayerState != nullptr) {
+        delete m_PlayerState;
+        m_PlayerState = nullptr;
+    }
+}
+
+#ifdef __ANDROID__
 void MediaPlayer::Init(JNIEnv *jniEnv, jobject obj, char *url, int videoRenderType, jobject surface) {
     jniEnv->GetJavaVM(&m_JavaVM);
     m_JavaObj = jniEnv->NewGlobalRef(obj);
-    m_PlayerState = new PlayerState();
-    strcpy(m_PlayerState->m_Url, url);
     av_jni_set_java_vm(m_JavaVM, nullptr);
+    VideoRender *videoRender = nullptr;
     if(videoRenderType == VIDEO_RENDER_OPENGL) {
-        m_VideoRender = VideoGLRender::GetInstance();
+        videoRender = VideoGLRender::GetInstance();
     } else if (videoRenderType == VIDEO_RENDER_ANWINDOW) {
-        m_VideoRender = NativeRender::GetInstance(jniEnv, surface);
+        videoRender = NativeRender::GetInstance(jniEnv, surface);
     } else if (videoRenderType == VIDEO_RENDER_3D_VR) {
-        m_VideoRender = VRGLRender::GetInstance();
+        videoRender = VRGLRender::GetInstance();
     }
 
+    SetMessageCallback(this, PostMessage);
+    Init(url, videoRender, new OpenSLRender());
+    m_OwnAudioRender = true;
+}
+#endif
+
+void MediaPlayer::Init(const char *url, VideoRender *videoRender, AudioRender *audioRender) {
+    LOGCATE("MediaPlayer::Init url=%s", url);
+    strncpy(m_PlayerState->m_Url, url, MAX_PATH - 1);
+    m_VideoRender = videoRender;
+    m_AudioRender = audioRender;
+
     m_Thread = new thread(AsyncMediaPlay, this);
 }
 
@@ -36,6 +62,13 @@ void MediaPlayer::UnInit() {
 
     m_VideoRender = nullptr;
 
+    if(m_OwnAudioRender && m_AudioRender != nullptr) {
+        delete m_AudioRender;
+    }
+    m_AudioRender = nullptr;
+    m_OwnAudioRender = false;
+
+#ifdef __ANDROID__
     NativeRender::ReleaseInstance();
     VideoGLRender::ReleaseInstance();
     VRGLRender::ReleaseInstance();
@@ -44,6 +77,7 @@ void MediaPlayer::UnInit() {
     GetJNIEnv(&isAttach)->DeleteGlobalRef(m_JavaObj);
     if(isAttach)
         GetJavaVM()->DetachCurrentThread();
+#endif
 
 }
 
@@ -52,14 +86,18 @@ void MediaPlayer::Play() {
     unique_lock<mutex> lock(m_Mutex);
     m_PlayerState->m_PauseRequest = 0;
     m_PlayerState->m_AbortRequest = 0;
+    m_PlayerState->SetClocksPaused(false);
     m_Cond.notify_all();
+    m_PlayerState->NotifyStateChanged();
 }
 
 void MediaPlayer::Pause() {
     LOGCATE("MediaPlayer::Pause");
     unique_lock<mutex> lock(m_Mutex);
     m_PlayerState->m_PauseRequest = 1;
+    m_PlayerState->SetClocksPaused(true);
     m_Cond.notify_all();
+    m_PlayerState->NotifyStateChanged();
 }
 
 void MediaPlayer::Stop() {
@@ -67,35 +105,40 @@ void MediaPlayer::Stop() {
     unique_lock<mutex> lock(m_Mutex);
     m_PlayerState->m_AbortRequest = 1;
     m_Cond.notify_all();
+    m_PlayerState->NotifyStateChanged();
 }
 
 void MediaPlayer::SeekToPosition(float position) {
-    LOGCATE("MediaPlayer::SeekToPosition position=%f", position);
+    SeekToPosition(position, SEEK_MODE_DEFAULT);
+}
+
+void MediaPlayer::SeekToPosition(float position, int seekMode) {
+    LOGCATE("MediaPlayer::SeekToPosition position=%f, seekMode=%d", position, seekMode);
     if(position < 0 || m_PlayerState->m_Duration < 0) return;
 
-    unique_lock<mutex> lock(m_Mutex);
-    while(m_PlayerState->m_SeekRequest) {
-        m_Cond.wait(lock);
+    int64_t seek_pos = (int64_t) (position * AV_TIME_BASE); // s to us
+    int64_t start_time = m_AVFormatCtx ? m_AVFormatCtx->start_time : 0;
+    if (start_time > 0 && start_time != AV_NOPTS_VALUE) {
+        seek_pos += start_time;
     }
-    lock.unlock();
 
-    if(m_PlayerState->m_SeekRequest == 0) {
-        int64_t seek_pos = av_rescale(position, AV_TIME_BASE, 1); // s to us
-        int64_t start_time = m_AVFormatCtx ? m_AVFormatCtx->start_time : 0;
-        if (start_time > 0 && start_time != AV_NOPTS_VALUE) {
-            seek_pos += start_time;
-        }
-        lock.lock();
-        m_PlayerState->m_SeekRequest = 1;
-        m_PlayerState->m_SeekPosition = seek_pos;
-        m_PlayerState->m_PauseRequest = 0;
-        m_Cond.notify_all();
-        lock.unlock();
+    //解封装线程还没取走上一个请求时直接覆盖，拖动进度条产生的中间位置不再逐个执行
+    unique_lock<mutex> lock(m_Mutex);
+    if(m_PlayerState->m_SeekRequest) {
+        m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_COALESCED_SEEKS);
     }
+    m_PlayerState->m_SeekRequest = 1;
+    m_PlayerState->m_SeekPosition = seek_pos;
+    m_PlayerState->m_SeekMode = seekMode;
+    m_PlayerState->m_PauseRequest = 0;
+    m_PlayerState->SetClocksPaused(false);
+    m_Cond.notify_all();
+    lock.unlock();
+    m_PlayerState->NotifyStateChanged();
 }
 
 long MediaPlayer::GetMediaParams(int paramType) {
-    LOGCATE("MediaPlayer::GetMediaParams paramType=%d", paramType);
+    LOGCATV("MediaPlayer::GetMediaParams paramType=%d", paramType);
     long value = 0;
     switch(paramType)
     {
@@ -115,10 +158,81 @@ long MediaPlayer::GetMediaParams(int paramType) {
         case MEDIA_PARAM_ROTATE_ANGLE:
             value = m_VideoDecoder != nullptr ? m_VideoDecoder->GetRotateAngle() : 0;
             break;
+        default:
+            if (m_PlayerState == nullptr) break;
+            if (paramType >= MEDIA_PARAM_STATS_COUNTER(0) && paramType < MEDIA_PARAM_STATS_COUNTER(PLAYER_COUNTER_COUNT)) {
+                PlayerCounter counter = static_cast<PlayerCounter>(paramType - MEDIA_PARAM_STATS_COUNTER_BASE);
+                value = m_PlayerState->m_Stats.GetCounter(counter);
+            } else if (paramType >= MEDIA_PARAM_STATS_STAGE(0, 0) && paramType < MEDIA_PARAM_STATS_STAGE(PLAYER_STAGE_COUNT, 0)) {
+                int stage = (paramType - MEDIA_PARAM_STATS_STAGE_BASE) / 0x10;
+                int stat = (paramType - MEDIA_PARAM_STATS_STAGE_BASE) % 0x10;
+                if (stat < PLAYER_STAGE_STAT_NUM) {
+                    value = m_PlayerState->m_Stats.GetStageStat(static_cast<PlayerStage>(stage), static_cast<PlayerStageStat>(stat));
+                }
+            }
+            break;
     }
     return value;
 }
 
+void MediaPlayer::SetPlayerOption(int optionType, long value) {
+    LOGCATE("MediaPlayer::SetPlayerOption optionType=%d, value=%ld", optionType, value);
+    switch(optionType)
+    {
+        case PLAYER_OPTION_LOOP:
+            m_PlayerState->m_Loop = value != 0;
+            break;
+        case PLAYER_OPTION_AUTO_EXIT:
+            m_PlayerState->m_AutoExit = value != 0;
+            break;
+        case PLAYER_OPTION_FREE_RUN:
+            m_PlayerState->m_FreeRun = value != 0;
+            break;
+        case PLAYER_OPTION_VIDEO_QUEUE_MAX_BYTES:
+            m_PlayerState->m_VideoQueueMaxBytes = value;
+            break;
+        case PLAYER_OPTION_AUDIO_QUEUE_MAX_BYTES:
+            m_PlayerState->m_AudioQueueMaxBytes = value;
+            break;
+        case PLAYER_OPTION_VIDEO_QUEUE_MAX_DURATION:
+            m_PlayerState->m_VideoQueueMaxDuration = value;
+            break;
+        case PLAYER_OPTION_AUDIO_QUEUE_MAX_DURATION:
+            m_PlayerState->m_AudioQueueMaxDuration = value;
+            break;
+        case PLAYER_OPTION_QUEUE_LOW_WATER_PERCENT:
+            m_PlayerState->m_QueueLowWaterPercent = value;
+            break;
+        case PLAYER_OPTION_PACKET_POOL:
+            m_PlayerState->m_UsePacketPool = value != 0;
+            break;
+        case PLAYER_OPTION_SYNC_TYPE:
+            m_PlayerState->m_SyncType = value;
+            break;
+        case PLAYER_OPTION_VIDEO_BUFFER_POOL:
+            m_PlayerState->m_UseVideoBufferPool = value != 0;
+            break;
+        case PLAYER_OPTION_VIDEO_FRAME_SKIP:
+            m_PlayerState->m_VideoFrameSkip = value != 0;
+            break;
+        case PLAYER_OPTION_VIDEO_DECODE_THREADS:
+            m_PlayerState->m_VideoDecodeThreads = value;
+            break;
+        case PLAYER_OPTION_VIDEO_THREAD_TYPE:
+            m_PlayerState->m_VideoThreadType = value;
+            break;
+        case PLAYER_OPTION_VIDEO_THREAD_MAX_LATENCY:
+            m_PlayerState->m_VideoThreadMaxLatency = value;
+            break;
+        case PLAYER_OPTION_ACCURATE_SEEK:
+            m_PlayerState->m_AccurateSeek = value != 0;
+            break;
+        default:
+            break;
+    }
+}
+
+#ifdef __ANDROID__
 JNIEnv *MediaPlayer::GetJNIEnv(bool *isAttach) {
     JNIEnv *env;
     int status;
@@ -153,7 +267,7 @@ void MediaPlayer::PostMessage(void *context, int msgType, float msgCode) {
         MediaPlayer *player = static_cast<MediaPlayer *>(context);
         bool isAttach = false;
         JNIEnv *env = player->GetJNIEnv(&isAttach);
-        LOGCATE("MediaPlayer::PostMessage env=%p", env);
+        LOGCATT("MediaPlayer::PostMessage env=%p", env);
         if(env == nullptr)
             return;
         jobject javaObj = player->GetJavaObj();
@@ -164,9 +278,11 @@ void MediaPlayer::PostMessage(void *context, int msgType, float msgCode) {
 
     }
 }
+#endif
 
 void MediaPlayer::AsyncMediaPlay(MediaPlayer *player) {
     LOGCATE("MediaPlayer::AsyncMediaPlay line=%d", __LINE__);
+    TRACE_THREAD_NAME("demux");
     int result = -1;
     do {
         result = player->InitPlayerContext();
@@ -251,6 +367,13 @@ int MediaPlayer::InitPlayerContext() {
 
         result = 0;
 
+        m_PlayerState->m_HasAudio = m_AudioDecoder != nullptr;
+        m_PlayerState->m_HasVideo = m_VideoDecoder != nullptr;
+
+        if(m_PlayerState->m_UsePacketPool) {
+            m_PacketPool = new AVPacketPool();
+        }
+
         m_MediaSync = new MediaSync(m_PlayerState, m_VideoDecoder, m_AudioDecoder);
         m_MediaSync->SetVideoRender(m_VideoRender);
 
@@ -316,6 +439,19 @@ int MediaPlayer::PrepareDecoder(int streamIndex, int mediaType) {
             break;
         }
 
+        // 视频帧直接解码到渲染侧的缓冲池中
+        if (mediaType == AVMEDIA_TYPE_VIDEO && m_PlayerState->m_UseVideoBufferPool) {
+            m_VideoBufferPool = new VideoBufferPool();
+            m_VideoBufferPool->Attach(pCodecContext);
+        }
+
+        // 软解线程数和线程类型，打开解码器之后不能再修改
+        if (mediaType == AVMEDIA_TYPE_VIDEO) {
+            DecoderThreadPolicy::Apply(pCodecContext, m_AVFormatCtx, m_AVFormatCtx->streams[streamIndex],
+                                       m_PlayerState->m_VideoDecodeThreads, m_PlayerState->m_VideoThreadType,
+                                       m_PlayerState->m_VideoThreadMaxLatency);
+        }
+
         // 打开解码器
         result = avcodec_open2(pCodecContext, pCodec, NULL);
         if(result < 0) {
@@ -328,7 +464,11 @@ int MediaPlayer::PrepareDecoder(int streamIndex, int mediaType) {
                 m_AudioCodecCtx = pCodecContext;
                 m_AudioDecoder = new AudioMediaDecoder(pCodecContext, m_AVFormatCtx->streams[streamIndex],
                                                        streamIndex, m_PlayerState);
-                m_AudioDecoder->SetMessageCallback(this, PostMessage);
+                m_AudioDecoder->SetMessageCallback(m_MsgContext, m_MsgCallback);
+                m_AudioDecoder->SetAudioRender(m_AudioRender);
+                m_AudioDecoder->SetPacketQueueLimit(m_PlayerState->m_AudioQueueMaxBytes, m_PlayerState->m_AudioQueueMaxDuration,
+                                                    m_PlayerState->m_QueueLowWaterPercent);
+                m_AudioDecoder->SetPacketQueueCallback(this, OnPacketQueueDrained);
                 break;
             }
 
@@ -336,7 +476,10 @@ int MediaPlayer::PrepareDecoder(int streamIndex, int mediaType) {
                 m_VideoCodecCtx = pCodecContext;
                 m_VideoDecoder = new VideoMediaDecoder(m_AVFormatCtx, pCodecContext, m_AVFormatCtx->streams[streamIndex],
                                                        streamIndex, m_PlayerState);
-                m_VideoDecoder->SetMessageCallback(this, PostMessage);
+                m_VideoDecoder->SetMessageCallback(m_MsgContext, m_MsgCallback);
+                m_VideoDecoder->SetPacketQueueLimit(m_PlayerState->m_VideoQueueMaxBytes, m_PlayerState->m_VideoQueueMaxDuration,
+                                                    m_PlayerState->m_QueueLowWaterPercent);
+                m_VideoDecoder->SetPacketQueueCallback(this, OnPacketQueueDrained);
                 break;
             }
             default:
@@ -356,52 +499,96 @@ int MediaPlayer::ReadPackets() {
         }
     }
 
+    //外部时钟从第一帧的时间戳开始走
+    int64_t startTime = m_AVFormatCtx->start_time != AV_NOPTS_VALUE ? m_AVFormatCtx->start_time : 0;
+    m_PlayerState->m_ExternalClock.SetClock(startTime);
+
     int result = -1;
+    bool eofPacketSent = false;
     AVPacket avPacket, *pPacket = &avPacket;
     for (;;) {
         if (m_PlayerState->m_AbortRequest) {
             break;
         }
 
-        if(m_PlayerState->m_SysTimeBase == 0) {
-            unique_lock<mutex> lock(m_PlayerState->m_Mutex);
-            m_PlayerState->m_SysTimeBase = GetSysCurrentTime();
-        }
-
-        while (m_PlayerState->m_PauseRequest && (!m_PlayerState->m_AbortRequest))
-        {
+        if (m_PlayerState->m_PauseRequest) {
+            //暂停时时钟已冻结，等待恢复播放、seek 或退出
             unique_lock<mutex> lock(m_Mutex);
-            m_Cond.wait_for(lock, std::chrono::milliseconds(10));
-            {
-                unique_lock<mutex> playerStateLock(m_PlayerState->m_Mutex);
-                m_PlayerState->m_SysTimeBase = GetSysCurrentTime() - m_PlayerState->m_CurTimestamp;
+            while (m_PlayerState->m_PauseRequest && !m_PlayerState->m_AbortRequest && !m_PlayerState->m_SeekRequest) {
+                m_Cond.wait(lock);
             }
         }
 
         // 定位处理
         if (m_PlayerState->m_SeekRequest) {
-            int64_t seek_target = m_PlayerState->m_SeekPosition;
-            int64_t seek_min = INT64_MIN;
-            int64_t seek_max = INT64_MAX;
-            LOGCATE("MediaPlayer::ReadPackets avformat_seek_file seek_target=%ld",seek_target);
-            int seek_ret = avformat_seek_file(m_AVFormatCtx, -1, seek_min, seek_target, seek_max, 0);
+            //先取走请求再执行，执行期间到来的请求留到下一轮，只处理最新的目标
+            int64_t seek_target;
+            int seek_mode;
+            {
+                unique_lock<mutex> lock(m_Mutex);
+                seek_target = m_PlayerState->m_SeekPosition;
+                seek_mode = m_PlayerState->m_SeekMode;
+                m_PlayerState->m_SeekRequest = 0;
+            }
+            if (seek_mode == SEEK_MODE_DEFAULT && m_PlayerState->m_AccurateSeek) {
+                seek_mode = SEEK_MODE_ACCURATE;
+            }
+            int stream_index = -1;
+            int64_t seek_ts = seek_target;
+            if (seek_mode == SEEK_MODE_SCRUB && m_VideoDecoder) {
+                //拖动时直接定位到最近的关键帧，seek 之后解出的第一帧就是要显示的帧
+                AVStream *stream = m_VideoDecoder->GetStream();
+                int64_t keyFrameTs = FindNearestKeyFrame(stream, av_rescale_q(seek_target, AV_TIME_BASE_Q, stream->time_base));
+                if (keyFrameTs != AV_NOPTS_VALUE) {
+                    stream_index = m_VideoDecoder->GetStreamIndex();
+                    seek_ts = keyFrameTs;
+                    seek_target = av_rescale_q(keyFrameTs, stream->time_base, AV_TIME_BASE_Q);
+                }
+            }
+            LOGCATE("MediaPlayer::ReadPackets avformat_seek_file seek_target=%ld, seek_mode=%d", seek_target, seek_mode);
+            int seek_ret = avformat_seek_file(m_AVFormatCtx, stream_index, INT64_MIN, seek_ts, INT64_MAX, 0);
             if (seek_ret < 0) {
                 LOGCATE("MediaPlayer::ReadPackets avformat_seek_file fail");
             } else {
-                //清空缓存
+                //清空缓存，解码器和同步线程按新序号丢弃旧数据，seek 目标在送入新数据包之前设置
                 if (m_VideoDecoder) {
                     m_VideoDecoder->Flush();
+                    m_VideoDecoder->SetSeekTarget(seek_target, seek_mode);
                 }
 
                 if (m_AudioDecoder) {
                     m_AudioDecoder->Flush();
+                    m_AudioDecoder->SetSeekTarget(seek_target, seek_mode);
                 }
-                // TODO 更新外部时钟值
+                // 更新时钟：音视频时钟等新的帧到来后再设置，外部时钟直接跳到目标位置
+                m_PlayerState->m_AudioClock.Reset();
+                m_PlayerState->m_VideoClock.Reset();
+                m_PlayerState->m_ExternalClock.SetClock(seek_target);
+                m_PlayerState->m_CurTimestamp = seek_target / 1000;
+                m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_SEEKS);
+                eofPacketSent = false;
+            }
+            m_PlayerState->NotifyStateChanged();
+        }
+        // 背压：队列超过上限时阻塞，直到解码线程消费到低水位以下
+        if (IsPacketQueueFull()) {
+            unique_lock<mutex> lock(m_Mutex);
+            while (!m_PlayerState->m_AbortRequest && !m_PlayerState->m_SeekRequest && !m_PlayerState->m_PauseRequest) {
+                if (m_AudioDecoder) m_AudioDecoder->RequestPacketQueueNotify();
+                if (m_VideoDecoder) m_VideoDecoder->RequestPacketQueueNotify();
+                if (!IsPacketQueueFull()) break;
+                m_Cond.wait(lock);
             }
-            m_PlayerState->m_SeekRequest = 0;
+            continue;
         }
+
         // 读出数据包
-        result = av_read_frame(m_AVFormatCtx, pPacket);
+        int64_t readStartTime = GetSysCurrentTimeUs();
+        {
+            TRACE_SCOPE("av_read_frame");
+            result = av_read_frame(m_AVFormatCtx, pPacket);
+        }
+        m_PlayerState->m_Stats.RecordLatency(PLAYER_STAGE_DEMUX, GetSysCurrentTimeUs() - readStartTime);
         if (result < 0) {
             // 读取出错，则直接退出
             if (m_AVFormatCtx->pb && m_AVFormatCtx->pb->error) {
@@ -410,9 +597,15 @@ int MediaPlayer::ReadPackets() {
             }
             // 判断是否是结尾
             if ((result == AVERROR_EOF || avio_feof(m_AVFormatCtx->pb))) {
-                //如果到达结尾，判断队列中是否还有数据，如果没有数据则播放结束，判断是否需要循环播放
-                if (!m_PlayerState->m_PauseRequest && (!m_AudioDecoder || m_AudioDecoder->GetPacketSize() == 0)
-                    && (!m_VideoDecoder || (m_VideoDecoder->GetPacketSize() == 0
+                //送入空包，解码器输出内部缓存的尾帧（B 帧重排、帧线程中尚未输出的帧）
+                if (!eofPacketSent) {
+                    if (m_VideoDecoder) m_VideoDecoder->PushNullPacket();
+                    if (m_AudioDecoder) m_AudioDecoder->PushNullPacket();
+                    eofPacketSent = true;
+                }
+                //解码器都已排空、帧队列也已渲染完时播放结束，判断是否需要循环播放
+                if (!m_PlayerState->m_PauseRequest && (!m_AudioDecoder || m_AudioDecoder->IsFinished())
+                    && (!m_VideoDecoder || (m_VideoDecoder->IsFinished()
                                           && m_VideoDecoder->GetFrameQueueSize() == 0))) {
                     if (m_PlayerState->m_Loop) {
                         if (m_PlayerState->m_StartTime != AV_NOPTS_VALUE) {
@@ -430,9 +623,13 @@ int MediaPlayer::ReadPackets() {
             av_usleep(5 * 1000);
             continue;
         }
+        m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_DEMUXED_PACKETS);
+        eofPacketSent = false;
         if (m_AudioDecoder && pPacket->stream_index == m_AudioDecoder->GetStreamIndex()) {
+            if (m_PacketPool) m_PacketPool->Repack(pPacket);
             m_AudioDecoder->PushPacket(pPacket);
         } else if (m_VideoDecoder && pPacket->stream_index == m_VideoDecoder->GetStreamIndex()) {
+            if (m_PacketPool) m_PacketPool->Repack(pPacket);
             m_VideoDecoder->PushPacket(pPacket);
         } else {
             av_packet_unref(pPacket);
@@ -441,12 +638,70 @@ int MediaPlayer::ReadPackets() {
     return result;
 }
 
+/**
+ * 视频流索引中离 timestamp（流的 time_base）最近的关键帧时间戳，没有索引时返回 AV_NOPTS_VALUE
+ */
+int64_t MediaPlayer::FindNearestKeyFrame(AVStream *stream, int64_t timestamp) {
+    int before = av_index_search_timestamp(stream, timestamp, AVSEEK_FLAG_BACKWARD);
+    int after = av_index_search_timestamp(stream, timestamp, 0);
+    if (before < 0 && after < 0) {
+        return AV_NOPTS_VALUE;
+    }
+    if (before < 0) {
+        return stream->index_entries[after].timestamp;
+    }
+    if (after < 0) {
+        return stream->index_entries[before].timestamp;
+    }
+    int64_t beforeTs = stream->index_entries[before].timestamp;
+    int64_t afterTs = stream->index_entries[after].timestamp;
+    return timestamp - beforeTs <= afterTs - timestamp ? beforeTs : afterTs;
+}
+
+/**
+ * 任一队列超过上限，且没有队列处于低水位以下（饥饿）时才认为需要等待，
+ * 避免音视频交织较差的文件中一路队列满、另一路饿死造成死锁
+ */
+bool MediaPlayer::IsPacketQueueFull() {
+    bool full = false;
+    bool starving = false;
+    if (m_AudioDecoder) {
+        if (m_AudioDecoder->IsPacketQueueFull()) full = true;
+        else if (m_AudioDecoder->IsPacketQueueBelowLowWater()) starving = true;
+    }
+    if (m_VideoDecoder) {
+        if (m_VideoDecoder->IsPacketQueueFull()) full = true;
+        else if (m_VideoDecoder->IsPacketQueueBelowLowWater()) starving = true;
+    }
+    return full && !starving;
+}
+
+void MediaPlayer::OnPacketQueueDrained(void *context) {
+    MediaPlayer *player = static_cast<MediaPlayer *>(context);
+    unique_lock<mutex> lock(player->m_Mutex);
+    player->m_Cond.notify_all();
+}
+
 void MediaPlayer::OnPlayerReady() {
-    PostMessage(this, PLAYER_MSG_PLAYER_READY, 0);
+    if(m_MsgCallback != nullptr)
+        m_MsgCallback(m_MsgContext, PLAYER_MSG_PLAYER_READY, 0);
 }
 
 int MediaPlayer::UnInitPlayerContext() {
     LOGCATE("MediaPlayer::UnInitPlayerContext");
+    //自动退出或读包出错时，通知解码和同步线程退出
+    m_PlayerState->m_AbortRequest = 1;
+    m_PlayerState->NotifyStateChanged();
+
+    //先停止解码线程（同时终止帧队列，唤醒阻塞在队列上的同步线程），再停止同步线程
+    if(m_VideoDecoder) {
+        m_VideoDecoder->Stop();
+    }
+
+    if(m_AudioDecoder) {
+        m_AudioDecoder->Stop();
+    }
+
     if(m_MediaSync) {
         m_MediaSync->Stop();
         delete m_MediaSync;
@@ -454,17 +709,20 @@ int MediaPlayer::UnInitPlayerContext() {
     }
 
     if(m_VideoDecoder) {
-        m_VideoDecoder->Stop();
         delete m_VideoDecoder;
         m_VideoDecoder = nullptr;
     }
 
     if(m_AudioDecoder) {
-        m_AudioDecoder->Stop();
         delete m_AudioDecoder;
         m_AudioDecoder = nullptr;
     }
 
+    if(m_PacketPool != nullptr) {
+        delete m_PacketPool;
+        m_PacketPool = nullptr;
+    }
+
     if(m_AudioCodecCtx != nullptr) {
         avcodec_close(m_AudioCodecCtx);
         avcodec_free_context(&m_AudioCodecCtx);
@@ -477,6 +735,15 @@ int MediaPlayer::UnInitPlayerContext() {
         m_VideoCodecCtx = nullptr;
     }
 
+    if(m_VideoBufferPool != nullptr) {
+        LOGCATE("MediaPlayer::UnInitPlayerContext video buffer pooled=%lld, fallback=%lld",
+                (long long) m_VideoBufferPool->GetPooledCount(), (long long) m_VideoBufferPool->GetFallbackCount());
+        m_PlayerState->m_Stats.SetCounter(PLAYER_COUNTER_VIDEO_POOLED_BUFFERS, m_VideoBufferPool->GetPooledCount());
+        m_PlayerState->m_Stats.SetCounter(PLAYER_COUNTER_VIDEO_FALLBACK_BUFFERS, m_VideoBufferPool->GetFallbackCount());
+        delete m_VideoBufferPool;
+        m_VideoBufferPool = nullptr;
+    }
+
     if(m_AVFormatCtx != nullptr) {
         avformat_close_input(&m_AVFormatCtx);
         avformat_free_context(m_AVFormatCtx);
@@ -486,7 +753,8 @@ int MediaPlayer::UnInitPlayerContext() {
 }
 
 void MediaPlayer::OnPlayerDone() {
-    PostMessage(this, PLAYER_MSG_PLAYER_DONE, 0);
+    if(m_MsgCallback != nullptr)
+        m_MsgCallback(m_MsgContext, PLAYER_MSG_PLAYER_DONE, 0);
 }
 
 
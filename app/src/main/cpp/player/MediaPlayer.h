@@ -5,11 +5,17 @@
 #ifndef LEARNFFMPEG_MEDIAPLAYER_H
 #define LEARNFFMPEG_MEDIAPLAYER_H
 
+#ifdef __ANDROID__
 #include <jni.h>
+#endif
 #include <decoder/VideoMediaDecoder.h>
 #include <decoder/AudioMediaDecoder.h>
 #include <sync/MediaSync.h>
+#include <queue/AVPacketPool.h>
+#include <decoder/DecoderThreadPolicy.h>
+#include "VideoBufferPool.h"
 #include "VideoRender.h"
+#include "AudioRender.h"
 
 #define JAVA_PLAYER_EVENT_CALLBACK_API_NAME "playerEventCallback"
 
@@ -18,28 +24,79 @@
 #define MEDIA_PARAM_VIDEO_DURATION      0x0003
 #define MEDIA_PARAM_ROTATE_ANGLE        0x0004
 
+//运行统计，见 PlayerStats.h，阶段耗时单位 us
+#define MEDIA_PARAM_STATS_COUNTER_BASE  0x0100
+#define MEDIA_PARAM_STATS_STAGE_BASE    0x0200
+#define MEDIA_PARAM_STATS_COUNTER(counter)  (MEDIA_PARAM_STATS_COUNTER_BASE + (counter))            // PlayerCounter
+#define MEDIA_PARAM_STATS_STAGE(stage, stat) (MEDIA_PARAM_STATS_STAGE_BASE + (stage) * 0x10 + (stat)) // PlayerStage, PlayerStageStat
+
+//player options, set before Init
+#define PLAYER_OPTION_LOOP              0x0001
+#define PLAYER_OPTION_AUTO_EXIT         0x0002
+#define PLAYER_OPTION_FREE_RUN          0x0003
+#define PLAYER_OPTION_VIDEO_QUEUE_MAX_BYTES     0x0004
+#define PLAYER_OPTION_AUDIO_QUEUE_MAX_BYTES     0x0005
+#define PLAYER_OPTION_VIDEO_QUEUE_MAX_DURATION  0x0006  // ms
+#define PLAYER_OPTION_AUDIO_QUEUE_MAX_DURATION  0x0007  // ms
+#define PLAYER_OPTION_QUEUE_LOW_WATER_PERCENT   0x0008
+#define PLAYER_OPTION_PACKET_POOL               0x0009  // 默认 0，数据包负载使用 AVPacketPool
+#define PLAYER_OPTION_SYNC_TYPE                 0x000A  // AVSyncType
+#define PLAYER_OPTION_VIDEO_BUFFER_POOL         0x000B  // 默认 0，视频解码直接写入 VideoBufferPool，渲染器零拷贝读取
+#define PLAYER_OPTION_VIDEO_FRAME_SKIP          0x000C  // 视频落后时解码器跳过非参考帧、B 帧直至只解关键帧
+#define PLAYER_OPTION_VIDEO_DECODE_THREADS      0x000D  // 视频软解线程数，0 为自动
+#define PLAYER_OPTION_VIDEO_THREAD_TYPE         0x000E  // VideoThreadType
+#define PLAYER_OPTION_VIDEO_THREAD_MAX_LATENCY  0x000F  // 帧线程允许增加的输出延迟 ms
+#define PLAYER_OPTION_ACCURATE_SEEK             0x0010  // SEEK_MODE_DEFAULT 按 SEEK_MODE_ACCURATE 执行，seek 后第一帧即目标位置
+
 class MediaPlayer {
 public:
-    MediaPlayer(){};
-    ~MediaPlayer(){};
+    MediaPlayer();
+    ~MediaPlayer();
 
+#ifdef __ANDROID__
     void Init(JNIEnv *jniEnv, jobject obj, char *url, int renderType, jobject surface);
+#endif
+    //平台无关的初始化，渲染器由调用方创建并持有
+    void Init(const char *url, VideoRender *videoRender, AudioRender *audioRender);
     void UnInit();
 
     void Play();
     void Pause();
     void Stop();
     void SeekToPosition(float position);
+    //不等待上一次 seek 完成，尚未处理的请求被新目标覆盖；拖动进度条时用 SEEK_MODE_SCRUB，松开时用 SEEK_MODE_ACCURATE
+    void SeekToPosition(float position, int seekMode);
     long GetMediaParams(int paramType);
+    void SetPlayerOption(int optionType, long value);
+
+    //运行统计，播放结束（PLAYER_MSG_PLAYER_DONE）后仍然有效，直到 MediaPlayer 析构
+    PlayerStats *GetPlayerStats() {
+        return &m_PlayerState->m_Stats;
+    }
+
+    //一次性读取全部计数器和各阶段耗时，可在任意线程调用
+    void GetStatsSnapshot(PlayerStatsSnapshot *snapshot) {
+        m_PlayerState->m_Stats.GetSnapshot(snapshot);
+    }
+
+    void SetMessageCallback(void *context, PlayerMessageCallback callback) {
+        m_MsgContext = context;
+        m_MsgCallback = callback;
+    }
 
 private:
     static void AsyncMediaPlay(MediaPlayer *player);
     int InitPlayerContext();
     int PrepareDecoder(int streamIndex, int mediaType);
     int ReadPackets();
+    bool IsPacketQueueFull();
+    static int64_t FindNearestKeyFrame(AVStream *stream, int64_t timestamp);
+    static void OnPacketQueueDrained(void *context);
     int UnInitPlayerContext();
     void OnPlayerReady();
     void OnPlayerDone();
+
+#ifdef __ANDROID__
     JNIEnv *GetJNIEnv(bool *isAttach);
     jobject GetJavaObj();
     JavaVM *GetJavaVM();
@@ -48,13 +105,25 @@ private:
 
     JavaVM *m_JavaVM = nullptr;
     jobject m_JavaObj = nullptr;
+#endif
+
+    void * m_MsgContext = nullptr;
+    PlayerMessageCallback m_MsgCallback = nullptr;
 
     VideoMediaDecoder *m_VideoDecoder = nullptr;
     AudioMediaDecoder *m_AudioDecoder = nullptr;
 
     MediaSync *m_MediaSync = nullptr;
 
+    //数据包负载内存池
+    AVPacketPool *m_PacketPool = nullptr;
+
+    //视频帧缓冲池，解码器通过 get_buffer2 从中分配帧
+    VideoBufferPool *m_VideoBufferPool = nullptr;
+
     VideoRender *m_VideoRender = nullptr;
+    AudioRender *m_AudioRender = nullptr;
+    bool m_OwnAudioRender = false;
 
     //锁和条件变量
     mutex               m_Mutex;
@@ -6,35 +6,111 @@
 #define LEARNFFMPEG_PLAYERSTATE_H
 
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include "PlayerStats.h"
+#include <sync/Clock.h>
 
 #define MAX_PATH 1024
 using namespace std;
 
+enum SeekMode {
+    SEEK_MODE_DEFAULT,      // 定位到目标之前的关键帧，从关键帧开始播放
+    SEEK_MODE_SCRUB,        // 拖动进度条：定位到离目标最近的关键帧，解出后立即显示，不向前解码到目标位置
+    SEEK_MODE_ACCURATE      // 从目标之前的关键帧解码，目标之前的视频帧解码后丢弃（非参考帧直接跳过），音频裁到目标采样（松开进度条时使用）
+};
+
 class PlayerState {
 public:
     PlayerState() {
         memset(m_Url, 0, sizeof(MAX_PATH));
     }
     virtual ~PlayerState() {}
+
+    // 实际生效的主时钟类型：音频主时钟但没有音频流、视频主时钟但没有视频流时退回外部时钟
+    int GetMasterSyncType() {
+        if (m_SyncType == AV_SYNC_VIDEO_MASTER) {
+            return m_HasVideo ? AV_SYNC_VIDEO_MASTER : AV_SYNC_EXTERNAL_CLOCK;
+        } else if (m_SyncType == AV_SYNC_AUDIO_MASTER) {
+            return m_HasAudio ? AV_SYNC_AUDIO_MASTER : AV_SYNC_EXTERNAL_CLOCK;
+        }
+        return AV_SYNC_EXTERNAL_CLOCK;
+    }
+
+    // 主时钟 us，尚未设置时返回 AV_NOPTS_VALUE
+    int64_t GetMasterClock() {
+        switch (GetMasterSyncType()) {
+            case AV_SYNC_AUDIO_MASTER:
+                return m_AudioClock.GetClock();
+            case AV_SYNC_VIDEO_MASTER:
+                return m_VideoClock.GetClock();
+            default:
+                return m_ExternalClock.GetClock();
+        }
+    }
+
+    void SetClocksPaused(bool paused) {
+        m_AudioClock.SetPaused(paused);
+        m_VideoClock.SetPaused(paused);
+        m_ExternalClock.SetPaused(paused);
+    }
+
+    // 播放、暂停、停止、seek 等状态改变后调用，唤醒在 m_StateCond 上等待的线程
+    void NotifyStateChanged() {
+        unique_lock<mutex> lock(m_StateMutex);
+        m_StateCond.notify_all();
+    }
+
 public:
-    mutex m_Mutex;                  // 互斥锁
+    mutex m_StateMutex;             // 状态变化通知
+    condition_variable m_StateCond;
     char m_Url[MAX_PATH];           // 文件路径
     volatile int m_AbortRequest = 0;       // 退出标志
     volatile int m_PauseRequest = 0;       // 暂停标志
 
     double m_StartTime = 0;        // 播放起始时间 s
     double m_Duration  = 0;        // 播放总时长单位 s
-    int64_t m_CurTimestamp = 0;     // 当前播放视频或音频位置 ms
-    int64_t m_SysTimeBase  = 0;     // 系统时钟的对齐时间 ms
+    atomic<int64_t> m_CurTimestamp{0};  // 当前播放位置 ms，用于通知上层，音频解码、同步和解封装线程都会写
+
+    //时钟
+    Clock m_AudioClock;             // 音频时钟，已扣除音频设备中缓存的数据
+    Clock m_VideoClock;             // 视频时钟，最近一次显示帧的 pts
+    Clock m_ExternalClock;          // 外部时钟，系统单调时钟
+    int m_SyncType = AV_SYNC_AUDIO_MASTER;
+    int m_HasAudio = 0;
+    int m_HasVideo = 0;
 
-    //seek position
-    volatile int m_SeekRequest = 0; // Seek 请求
+    //seek position，m_SeekPosition 和 m_SeekMode 由 MediaPlayer::m_Mutex 保护
+    volatile int m_SeekRequest = 0; // Seek 请求，解封装线程取走请求时清零，未处理的请求被新请求覆盖
     volatile int m_SeekSuccess = 0; // Seek 标志
-    int64_t m_SeekPosition = 0;     // Seek 位置
+    int64_t m_SeekPosition = 0;     // Seek 位置 us
+    int m_SeekMode = SEEK_MODE_DEFAULT;
 
     //play mode
     int m_AutoExit = 0;             // 自动退出
     int m_Loop     = 1;             // 循环播放
+    int m_FreeRun  = 0;             // 不做音视频同步，解码出的帧立即渲染（性能测试用）
+
+    //数据包队列上限，0 表示不限制；超过上限时解封装线程阻塞，直到降到低水位以下
+    int64_t m_VideoQueueMaxBytes    = 15 * 1024 * 1024;
+    int64_t m_AudioQueueMaxBytes    = 2 * 1024 * 1024;
+    int64_t m_VideoQueueMaxDuration = 10 * 1000;    // ms
+    int64_t m_AudioQueueMaxDuration = 10 * 1000;    // ms
+    int m_QueueLowWaterPercent      = 50;           // 低水位，上限的百分比
+    int m_UsePacketPool             = 0;            // 数据包负载使用内存池，默认关闭，需用 pipeline-benchmark -p 对比后按需开启
+    int m_UseVideoBufferPool        = 0;            // 视频帧缓冲由 VideoBufferPool 分配，默认关闭，需用 video-buffer-pool-test 验证后按需开启
+    int m_VideoFrameSkip            = 1;            // 视频落后于主时钟时解码器逐级跳帧（skip_frame）
+    int m_AccurateSeek              = 0;            // 普通 seek 也解码到精确位置，见 SEEK_MODE_ACCURATE
+
+    //视频软解线程策略，见 DecoderThreadPolicy
+    int m_VideoDecodeThreads        = 0;            // 0 表示按分辨率和大核数自动选择
+    int m_VideoThreadType           = 0;            // VideoThreadType
+    int m_VideoThreadMaxLatency     = 100;          // 帧线程允许增加的输出延迟 ms
+
+    //运行统计
+    PlayerStats m_Stats;
 };
 
 
@@ -0,0 +1,167 @@
+#ifndef LEARNFFMPEG_PLAYERSTATS_H
+#define LEARNFFMPEG_PLAYERSTATS_H
+
+#include <atomic>
+#include <LatencyHistogram.h>
+
+//流水线各阶段，单次耗时统计单位 us
+enum PlayerStage {
+    PLAYER_STAGE_DEMUX,         // av_read_frame
+    PLAYER_STAGE_VIDEO_DECODE,  // 视频 send_packet + receive_frame
+    PLAYER_STAGE_AUDIO_DECODE,  // 音频 send_packet + receive_frame
+    PLAYER_STAGE_VIDEO_CONVERT, // 视频 sws_scale / 构造 NativeImage
+    PLAYER_STAGE_AUDIO_CONVERT, // 音频 swr_convert 重采样
+    PLAYER_STAGE_VIDEO_RENDER,  // 视频提交渲染，ANativeWindow 渲染包含 YUV 转 RGBA
+    PLAYER_STAGE_AUDIO_RENDER,  // 音频提交渲染
+    PLAYER_STAGE_COUNT
+};
+
+//计数器，PEAK 类为高水位（只增不减的最大值）
+enum PlayerCounter {
+    PLAYER_COUNTER_DEMUXED_PACKETS,
+    PLAYER_COUNTER_DECODED_VIDEO_FRAMES,
+    PLAYER_COUNTER_DECODED_AUDIO_FRAMES,
+    PLAYER_COUNTER_RENDERED_VIDEO_FRAMES,
+    PLAYER_COUNTER_DROPPED_VIDEO_FRAMES,         // MediaSync 因落后于主时钟丢弃的帧
+    PLAYER_COUNTER_AUDIO_UNDERRUNS,              // 音频设备取数据时缓冲已空的次数
+    PLAYER_COUNTER_VIDEO_PACKET_QUEUE_PEAK_BYTES,
+    PLAYER_COUNTER_AUDIO_PACKET_QUEUE_PEAK_BYTES,
+    PLAYER_COUNTER_VIDEO_FRAME_QUEUE_PEAK,       // 帧队列中最多的待渲染帧数
+    PLAYER_COUNTER_SKIPPED_VIDEO_FRAMES,         // 解码器按 skip_frame 跳过未解码的帧，按时间戳间隔估算
+    PLAYER_COUNTER_VIDEO_SKIP_LEVEL,             // 当前的解码跳帧级别 VideoSkipLevel
+    PLAYER_COUNTER_VIDEO_SKIP_LEVEL_PEAK,
+    PLAYER_COUNTER_SEEKS,                        // 实际执行的 avformat_seek_file 次数
+    PLAYER_COUNTER_COALESCED_SEEKS,              // 尚未处理就被新目标覆盖的 seek 请求
+    PLAYER_COUNTER_SEEK_DISCARDED_VIDEO_FRAMES,  // 精确 seek 时解码后因在目标之前而丢弃的帧
+    PLAYER_COUNTER_VIDEO_POOLED_BUFFERS,         // VideoBufferPool 分配的帧缓冲，播放结束释放解码器时写入
+    PLAYER_COUNTER_VIDEO_FALLBACK_BUFFERS,       // 回退到 avcodec_default_get_buffer2 的帧缓冲，同上
+    PLAYER_COUNTER_COUNT
+};
+
+//单个阶段的统计值，对应 GetMediaParams 中 MEDIA_PARAM_STATS_STAGE 的 stat 参数
+enum PlayerStageStat {
+    PLAYER_STAGE_STAT_COUNT,
+    PLAYER_STAGE_STAT_MEAN,
+    PLAYER_STAGE_STAT_P50,
+    PLAYER_STAGE_STAT_P90,
+    PLAYER_STAGE_STAT_P99,
+    PLAYER_STAGE_STAT_MAX,
+    PLAYER_STAGE_STAT_NUM
+};
+
+//某一时刻的统计快照，各字段单独原子读取，相互之间不保证严格一致
+struct PlayerStatsSnapshot {
+    int64_t counters[PLAYER_COUNTER_COUNT];
+    int64_t stages[PLAYER_STAGE_COUNT][PLAYER_STAGE_STAT_NUM];
+};
+
+//播放器运行统计，各线程无锁写入，可在播放过程中或结束后读取
+class PlayerStats {
+public:
+    PlayerStats() {
+        Reset();
+    }
+
+    void Reset() {
+        for (int i = 0; i < PLAYER_STAGE_COUNT; ++i) {
+            m_StageLatency[i].Reset();
+        }
+        for (int i = 0; i < PLAYER_COUNTER_COUNT; ++i) {
+            m_Counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void RecordLatency(PlayerStage stage, int64_t valueUs) {
+        m_StageLatency[stage].Record(valueUs);
+    }
+
+    void Increment(PlayerCounter counter, int64_t value = 1) {
+        m_Counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void SetCounter(PlayerCounter counter, int64_t value) {
+        m_Counters[counter].store(value, std::memory_order_relaxed);
+    }
+
+    //更新高水位
+    void UpdatePeak(PlayerCounter counter, int64_t value) {
+        int64_t peak = m_Counters[counter].load(std::memory_order_relaxed);
+        while (value > peak &&
+               !m_Counters[counter].compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    int64_t GetCounter(PlayerCounter counter) const {
+        return m_Counters[counter].load(std::memory_order_relaxed);
+    }
+
+    const LatencyHistogram &GetLatency(PlayerStage stage) const {
+        return m_StageLatency[stage];
+    }
+
+    int64_t GetStageStat(PlayerStage stage, PlayerStageStat stat) const {
+        const LatencyHistogram &histogram = m_StageLatency[stage];
+        switch (stat) {
+            case PLAYER_STAGE_STAT_COUNT: return histogram.GetCount();
+            case PLAYER_STAGE_STAT_MEAN:  return histogram.GetMean();
+            case PLAYER_STAGE_STAT_P50:   return histogram.GetPercentile(50);
+            case PLAYER_STAGE_STAT_P90:   return histogram.GetPercentile(90);
+            case PLAYER_STAGE_STAT_P99:   return histogram.GetPercentile(99);
+            case PLAYER_STAGE_STAT_MAX:   return histogram.GetMax();
+            default:                      return 0;
+        }
+    }
+
+    void GetSnapshot(PlayerStatsSnapshot *snapshot) const {
+        for (int i = 0; i < PLAYER_COUNTER_COUNT; ++i) {
+            snapshot->counters[i] = GetCounter(static_cast<PlayerCounter>(i));
+        }
+        for (int i = 0; i < PLAYER_STAGE_COUNT; ++i) {
+            for (int j = 0; j < PLAYER_STAGE_STAT_NUM; ++j) {
+                snapshot->stages[i][j] = GetStageStat(static_cast<PlayerStage>(i), static_cast<PlayerStageStat>(j));
+            }
+        }
+    }
+
+    static const char *GetStageName(int stage) {
+        switch (stage) {
+            case PLAYER_STAGE_DEMUX:         return "demux";
+            case PLAYER_STAGE_VIDEO_DECODE:  return "video_decode";
+            case PLAYER_STAGE_AUDIO_DECODE:  return "audio_decode";
+            case PLAYER_STAGE_VIDEO_CONVERT: return "video_convert";
+            case PLAYER_STAGE_AUDIO_CONVERT: return "audio_convert";
+            case PLAYER_STAGE_VIDEO_RENDER:  return "video_render";
+            case PLAYER_STAGE_AUDIO_RENDER:  return "audio_render";
+            default:                         return "unknown";
+        }
+    }
+
+    static const char *GetCounterName(int counter) {
+        switch (counter) {
+            case PLAYER_COUNTER_DEMUXED_PACKETS:              return "demuxed_packets";
+            case PLAYER_COUNTER_DECODED_VIDEO_FRAMES:         return "decoded_video_frames";
+            case PLAYER_COUNTER_DECODED_AUDIO_FRAMES:         return "decoded_audio_frames";
+            case PLAYER_COUNTER_RENDERED_VIDEO_FRAMES:        return "rendered_video_frames";
+            case PLAYER_COUNTER_DROPPED_VIDEO_FRAMES:         return "dropped_video_frames";
+            case PLAYER_COUNTER_AUDIO_UNDERRUNS:              return "audio_underruns";
+            case PLAYER_COUNTER_VIDEO_PACKET_QUEUE_PEAK_BYTES: return "video_packet_queue_peak_bytes";
+            case PLAYER_COUNTER_AUDIO_PACKET_QUEUE_PEAK_BYTES: return "audio_packet_queue_peak_bytes";
+            case PLAYER_COUNTER_VIDEO_FRAME_QUEUE_PEAK:       return "video_frame_queue_peak";
+            case PLAYER_COUNTER_SKIPPED_VIDEO_FRAMES:         return "skipped_video_frames";
+            case PLAYER_COUNTER_VIDEO_SKIP_LEVEL:             return "video_skip_level";
+            case PLAYER_COUNTER_VIDEO_SKIP_LEVEL_PEAK:        return "video_skip_level_peak";
+            case PLAYER_COUNTER_SEEKS:                        return "seeks";
+            case PLAYER_COUNTER_COALESCED_SEEKS:              return "coalesced_seeks";
+            case PLAYER_COUNTER_SEEK_DISCARDED_VIDEO_FRAMES:  return "seek_discarded_video_frames";
+            case PLAYER_COUNTER_VIDEO_POOLED_BUFFERS:         return "video_pooled_buffers";
+            case PLAYER_COUNTER_VIDEO_FALLBACK_BUFFERS:       return "video_fallback_buffers";
+            default:                                          return "unknown";
+        }
+    }
+
+private:
+    LatencyHistogram m_StageLatency[PLAYER_STAGE_COUNT];
+    std::atomic<int64_t> m_Counters[PLAYER_COUNTER_COUNT];
+};
+
+#endif //LEARNFFMPEG_PLAYERSTATS_H
@@ -43,7 +43,7 @@ void AudioDecoder::OnDecoderReady() {
 }
 
 void AudioDecoder::OnFrameAvailable(AVFrame *frame) {
-    LOGCATE("AudioDecoder::OnFrameAvailable frame=%p", frame);
+    LOGCATT("AudioDecoder::OnFrameAvailable frame=%p", frame);
     if(m_AudioRender) {
         int result = swr_convert(m_SwrContext, &m_AudioOutBuffer, m_DstFrameDataSze / 2, (const uint8_t **) frame->data, frame->nb_samples);
         if (result > 0 ) {
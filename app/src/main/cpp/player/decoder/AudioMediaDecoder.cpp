@@ -4,22 +4,16 @@
 
 #include <unistd.h>
 #include <LogUtil.h>
-#include <render/audio/OpenSLRender.h>
+#include <TraceRecorder.h>
 #include "AudioMediaDecoder.h"
 
 AudioMediaDecoder::AudioMediaDecoder(AVCodecContext *avCodecContext, AVStream *avStream,
                                      int streamIndex, PlayerState *playerState) : MediaDecoder(
         avCodecContext, avStream, streamIndex, playerState) {
 
-    m_Packet = av_packet_alloc();
 }
 
 AudioMediaDecoder::~AudioMediaDecoder() {
-    unique_lock<mutex> lock(m_Mutex);
-    if (m_Packet) {
-        av_packet_free(&m_Packet);
-        m_Packet = nullptr;
-    }
 }
 
 void AudioMediaDecoder::Start() {
@@ -40,6 +34,7 @@ void AudioMediaDecoder::Stop() {
 }
 
 void AudioMediaDecoder::Flush() {
+    //已解出的旧帧由解码线程按序号丢弃
     MediaDecoder::Flush();
 
     if(m_AudioRender != nullptr)
@@ -62,9 +57,11 @@ int AudioMediaDecoder::DecodeAudio() {
 
     for (;;) {
 
-        while (m_PlayerState->m_PauseRequest && !m_PlayerState->m_AbortRequest)
-        {
-            usleep(5 * 1000);
+        if (m_PlayerState->m_PauseRequest) {
+            unique_lock<mutex> stateLock(m_PlayerState->m_StateMutex);
+            m_PlayerState->m_StateCond.wait(stateLock, [this] {
+                return !m_PlayerState->m_PauseRequest || m_PlayerState->m_AbortRequest;
+            });
         }
 
         result = GetAudioFrame(frame);
@@ -72,12 +69,24 @@ int AudioMediaDecoder::DecodeAudio() {
             break;
         }
 
-        unique_lock<mutex> lock(m_PlayerState->m_Mutex);
-        m_PlayerState->m_CurTimestamp = frame->pts * av_q2d(m_AvStream->time_base) * 1000; // ms
-        lock.unlock();
-        if(m_MsgCallback != nullptr) {
-            LOGCATE("AudioMediaDecoder::DecodeAudio CurTimestamp=%f", m_PlayerState->m_CurTimestamp / 1000.0f);
-            m_MsgCallback(m_MsgContext, PLAYER_MSG_UPDATE_TIME, m_PlayerState->m_CurTimestamp / 1000.0f);
+        //取帧期间发生了 seek，这一帧已过期
+        if(m_PktSerial != GetSerial()) {
+            continue;
+        }
+
+        //精确 seek：在目标位置之前结束的帧丢弃，跨过目标的帧裁掉目标之前的采样
+        if(m_SeekTargetPts != AV_NOPTS_VALUE) {
+            if(frame->pts != AV_NOPTS_VALUE) {
+                AVRational sampleTb = {1, frame->sample_rate};
+                int64_t skipSamples = av_rescale_q(m_SeekTargetPts - frame->pts, m_AvStream->time_base, sampleTb);
+                if(skipSamples >= frame->nb_samples) {
+                    continue;
+                }
+                if(skipSamples > 0) {
+                    TrimFrameStart(frame, (int) skipSamples);
+                }
+            }
+            m_SeekTargetPts = AV_NOPTS_VALUE;
         }
 
         if(m_WaitTime > 0) {
@@ -86,10 +95,38 @@ int AudioMediaDecoder::DecodeAudio() {
         }
 
         if(m_AudioRender) {
-            result = swr_convert(m_SwrContext, &m_AudioOutBuffer, m_DstFrameDataSze / 2, (const uint8_t **) frame->data, frame->nb_samples);
+            int64_t convertStartTime = GetSysCurrentTimeUs();
+            {
+                TRACE_SCOPE("swr_convert");
+                //按本帧实际可输出的采样数（含重采样器内部积压）准备输出缓冲区，
+                //MP3(1152)、AC-3(1536) 等帧长大于 1024 的流不会在 swr 中越积越多
+                int outSamples = swr_get_out_samples(m_SwrContext, frame->nb_samples);
+                if (outSamples > m_nbSamples) {
+                    int outSize = av_samples_get_buffer_size(NULL, AUDIO_DST_CHANNEL_COUNTS, outSamples, DST_SAMPLT_FORMAT, 1);
+                    uint8_t *outBuffer = (uint8_t *) realloc(m_AudioOutBuffer, outSize);
+                    if (outBuffer != nullptr) {
+                        m_AudioOutBuffer = outBuffer;
+                        m_nbSamples = outSamples;
+                        m_DstFrameDataSze = outSize;
+                        LOGCATE("AudioMediaDecoder::DecodeAudio grow out buffer [m_nbSamples, m_DstFrameDataSze]=[%d, %d]", m_nbSamples, m_DstFrameDataSze);
+                    }
+                }
+                result = swr_convert(m_SwrContext, &m_AudioOutBuffer, m_nbSamples, (const uint8_t **) frame->data, frame->nb_samples);
+            }
+            int64_t renderStartTime = GetSysCurrentTimeUs();
+            m_PlayerState->m_Stats.RecordLatency(PLAYER_STAGE_AUDIO_CONVERT, renderStartTime - convertStartTime);
             if (result > 0 ) {
-                m_AudioRender->RenderAudioFrame(m_AudioOutBuffer, m_DstFrameDataSze);
+                int dataSize = av_samples_get_buffer_size(NULL, AUDIO_DST_CHANNEL_COUNTS, result, DST_SAMPLT_FORMAT, 1);
+                TRACE_SCOPE("RenderAudioFrame");
+                m_AudioRender->RenderAudioFrame(m_AudioOutBuffer, dataSize);
+                m_PlayerState->m_Stats.RecordLatency(PLAYER_STAGE_AUDIO_RENDER, GetSysCurrentTimeUs() - renderStartTime);
             }
+            m_PlayerState->m_Stats.SetCounter(PLAYER_COUNTER_AUDIO_UNDERRUNS, m_AudioRender->GetUnderrunCount());
+        }
+
+        //渲染期间发生 seek 时不用旧帧更新时钟，外部时钟已跳到 seek 位置
+        if(m_PktSerial == GetSerial()) {
+            UpdateAudioClock(frame);
         }
     }
 
@@ -101,87 +138,67 @@ int AudioMediaDecoder::DecodeAudio() {
 }
 
 int AudioMediaDecoder::GetAudioFrame(AVFrame *frame) {
-    LOGCATE("AudioMediaDecoder::GetAudioFrame line=%d", __LINE__);
-    int got_frame = 0;
-    int ret = 0;
-
+    LOGCATT("AudioMediaDecoder::GetAudioFrame line=%d", __LINE__);
     if (!frame) {
         return AVERROR(ENOMEM);
     }
     av_frame_unref(frame);
 
-    do {
-
-        if (m_AbortRequest || m_PlayerState->m_AbortRequest) {
-            ret = -1;
-            break;
-        }
-
-        if (m_PlayerState->m_SeekRequest) {
-            continue;
-        }
-
-        AVPacket pkt;
-        if (m_IsPacketPending) {
-            av_packet_move_ref(&pkt, m_Packet);
-            m_IsPacketPending = false;
-        } else {
-            if (m_PacketQueue->GetPacket(&pkt) < 0) {
-                LOGCATE("AudioMediaDecoder::GetAudioFrame line=%d", __LINE__);
-                ret = -1;
-                break;
-            }
-            LOGCATE("AudioMediaDecoder::GetAudioFrame line=%d", __LINE__);
-        }
+    int ret = 0;
+    // 多帧音频包的后续帧直接从解码器中取出，不必等下一个包
+    while ((ret = DecodeFrame(frame)) == 0) {
+        // 尾帧已全部输出，等待 seek 或循环播放后的新数据包
+    }
+    if (ret < 0) {
+        return -1;
+    }
 
-        // 将数据包解码
-        unique_lock<mutex> playerStateLock(m_PlayerState->m_Mutex);
-        ret = avcodec_send_packet(m_AvCodecContext, &pkt);
-        if (ret < 0) {
-            // 一次解码无法消耗完AVPacket中的所有数据，需要重新解码
-            if (ret == AVERROR(EAGAIN)) {
-                av_packet_move_ref(m_Packet, &pkt);
-                m_IsPacketPending = true;
-            } else {
-                av_packet_unref(&pkt);
-                m_IsPacketPending = false;
-            }
-            playerStateLock.unlock();
-            continue;
-        }
+    m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_DECODED_AUDIO_FRAMES);
+    if (frame->pts == AV_NOPTS_VALUE && m_NextPts != AV_NOPTS_VALUE) {
+        frame->pts = m_NextPts;
+    }
 
-        // 获取解码得到的音频帧AVFrame
-        ret = avcodec_receive_frame(m_AvCodecContext, frame);
-        playerStateLock.unlock();
-        // 释放数据包的引用，防止内存泄漏
-        av_packet_unref(m_Packet);
-        if (ret < 0) {
-            av_frame_unref(frame);
-            got_frame = 0;
-            continue;
-        } else {
-            got_frame = 1;
-            if (frame->pts == AV_NOPTS_VALUE && m_NextPts != AV_NOPTS_VALUE) {
-                frame->pts = m_NextPts;
-            }
+    if (frame->pts != AV_NOPTS_VALUE) {
+        m_NextPts = frame->pts + frame->nb_samples;
+    }
+    return 1;
+}
 
-            if (frame->pts != AV_NOPTS_VALUE) {
-                m_NextPts = frame->pts + frame->nb_samples;
-            }
+/**
+ * 丢弃帧开头的 samples 个采样：各平面数据指针后移，pts 相应增加，不拷贝数据
+ */
+void AudioMediaDecoder::TrimFrameStart(AVFrame *frame, int samples) {
+    AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+    int planar = av_sample_fmt_is_planar(format);
+    int planes = planar ? frame->channels : 1;
+    int offset = samples * av_get_bytes_per_sample(format) * (planar ? 1 : frame->channels);
+    for (int i = 0; i < planes; ++i) {
+        frame->extended_data[i] += offset;
+        if (frame->extended_data != frame->data && i < AV_NUM_DATA_POINTERS) {
+            frame->data[i] += offset;
         }
-    } while (!got_frame);
-
-    if (ret < 0) {
-        return -1;
     }
+    frame->nb_samples -= samples;
+    frame->pts += av_rescale_q(samples, (AVRational){1, frame->sample_rate}, m_AvStream->time_base);
+}
 
-    return got_frame;
+void AudioMediaDecoder::OnCodecFlush() {
+    //重采样器中还积压着 seek 前的采样，重新初始化将其丢弃，避免在新位置开头播出旧音频
+    if (m_SwrContext != nullptr) {
+        swr_init(m_SwrContext);
+    }
+    m_NextPts = AV_NOPTS_VALUE;
+    m_SeekTargetPts = AV_NOPTS_VALUE;
+    int64_t target = 0;
+    int seekMode = SEEK_MODE_DEFAULT;
+    if (GetSeekTarget(m_PktSerial, &target, &seekMode) && seekMode == SEEK_MODE_ACCURATE) {
+        m_SeekTargetPts = av_rescale_q(target, AV_TIME_BASE_Q, m_AvStream->time_base);
+    }
 }
 
 void AudioMediaDecoder::InitAudioRender() {
     LOGCATE("AudioMediaDecoder::InitAudioRender");
     AVCodecContext *codeCtx = GetCodecContext();
-    m_AudioRender = new OpenSLRender();
     m_SwrContext = swr_alloc();
 
     av_opt_set_int(m_SwrContext, "in_channel_layout", codeCtx->channel_layout, 0);
@@ -206,7 +223,8 @@ void AudioMediaDecoder::InitAudioRender() {
 
     m_AudioOutBuffer = (uint8_t *) malloc(m_DstFrameDataSze);
 
-    m_AudioRender->Init();
+    if(m_AudioRender)
+        m_AudioRender->Init();
 
 }
 
@@ -226,6 +244,38 @@ void AudioMediaDecoder::UnInitAudioRender() {
     }
 }
 
+/**
+ * 音频时钟 = 本帧结束时间 - 重采样器中尚未输出的时长 - 音频设备中尚未播放的数据时长，即扬声器当前正在播放的位置
+ * @param frame
+ */
+void AudioMediaDecoder::UpdateAudioClock(AVFrame *frame) {
+    if (frame->pts == AV_NOPTS_VALUE) {
+        return;
+    }
+
+    int64_t now = GetSysCurrentTimeUs();
+    AVRational tb = m_AvStream->time_base;
+    int64_t framePts = av_rescale_q(frame->pts, tb, AV_TIME_BASE_Q);
+    int64_t frameEnd = framePts + av_rescale(frame->nb_samples, AV_TIME_BASE, m_AvCodecContext->sample_rate);
+    int64_t bufferedTime = 0;
+    if (m_AudioRender != nullptr) {
+        int bytesPerSecond = AUDIO_DST_SAMPLE_RATE * AUDIO_DST_CHANNEL_COUNTS * av_get_bytes_per_sample(DST_SAMPLT_FORMAT);
+        bufferedTime = av_rescale(m_AudioRender->GetBufferedBytes(), AV_TIME_BASE, bytesPerSecond);
+    }
+    if (m_SwrContext != nullptr) {
+        bufferedTime += av_rescale(swr_get_delay(m_SwrContext, AUDIO_DST_SAMPLE_RATE), AV_TIME_BASE, AUDIO_DST_SAMPLE_RATE);
+    }
+    m_PlayerState->m_AudioClock.SetClockAt(frameEnd - bufferedTime, now);
+    m_PlayerState->m_ExternalClock.SyncTo(&m_PlayerState->m_AudioClock);
+
+    int64_t curTimestamp = (frameEnd - bufferedTime) / 1000; // ms
+    m_PlayerState->m_CurTimestamp = curTimestamp;
+    if(m_MsgCallback != nullptr) {
+        LOGCATT("AudioMediaDecoder::DecodeAudio CurTimestamp=%f", curTimestamp / 1000.0f);
+        m_MsgCallback(m_MsgContext, PLAYER_MSG_UPDATE_TIME, curTimestamp / 1000.0f);
+    }
+}
+
 void AudioMediaDecoder::Wait(int timeMs) {
     m_WaitTime = timeMs;
 }
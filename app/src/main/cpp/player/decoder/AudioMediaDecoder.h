@@ -42,17 +42,26 @@ public:
 
     int GetAudioFrame(AVFrame *frame);
 
+    //音频渲染器由播放器注入（OpenSL ES、WAV 文件等），解码器不负责释放
+    void SetAudioRender(AudioRender *audioRender) {
+        m_AudioRender = audioRender;
+    }
+
     void Wait(int timeMs);
 
+protected:
+    virtual void OnCodecFlush();
+
 private:
     void InitAudioRender();
     void UnInitAudioRender();
     int DecodeAudio();
+    void UpdateAudioClock(AVFrame *frame);
+    void TrimFrameStart(AVFrame *frame, int samples);
     thread *m_Thread = nullptr;
 
-    AVPacket *m_Packet = nullptr;
-    int64_t m_NextPts;
-    bool m_IsPacketPending = false;
+    int64_t m_NextPts = AV_NOPTS_VALUE;
+    int64_t m_SeekTargetPts = AV_NOPTS_VALUE;   // 精确 seek 的目标（流的 time_base），之前的采样丢弃
 
     const AVSampleFormat DST_SAMPLT_FORMAT = AV_SAMPLE_FMT_S16;
 
@@ -61,7 +70,7 @@ private:
     //audio resample context
     SwrContext   *m_SwrContext = nullptr;
     uint8_t      *m_AudioOutBuffer = nullptr;
-    //number of sample per channel
+    //number of sample per channel, 按 swr_get_out_samples 按需增长
     int           m_nbSamples = 0;
     //dst frame data size
     int           m_DstFrameDataSze = 0;
@@ -39,7 +39,7 @@ void DecoderBase::SeekToPosition(float position) {
 float DecoderBase::GetCurrentPosition() {
     //std::unique_lock<std::mutex> lock(m_Mutex);//读写保护
     //单位 ms
-    return m_CurTimeStamp;
+    return m_CurTimeStamp / 1000.0f;
 }
 
 int DecoderBase::Init(const char *url, AVMediaType mediaType) {
@@ -201,7 +201,7 @@ void DecoderBase::DecodingLoop() {
             std::unique_lock<std::mutex> lock(m_Mutex);
             LOGCATE("DecoderBase::DecodingLoop waiting, m_MediaType=%d", m_MediaType);
             m_Cond.wait_for(lock, std::chrono::milliseconds(10));
-            m_StartTimeStamp = GetSysCurrentTime() - m_CurTimeStamp;
+            m_StartTimeStamp = GetSysCurrentTimeUs() - m_CurTimeStamp;
         }
 
         if(m_DecoderState == STATE_STOP) {
@@ -209,7 +209,7 @@ void DecoderBase::DecodingLoop() {
         }
 
         if(m_StartTimeStamp == -1)
-            m_StartTimeStamp = GetSysCurrentTime();
+            m_StartTimeStamp = GetSysCurrentTimeUs();
 
         if(DecodeOnePacket() != 0) {
             //解码结束，暂停解码器
@@ -221,7 +221,7 @@ void DecoderBase::DecodingLoop() {
 }
 
 void DecoderBase::UpdateTimeStamp() {
-    LOGCATE("DecoderBase::UpdateTimeStamp");
+    LOGCATT("DecoderBase::UpdateTimeStamp");
     std::unique_lock<std::mutex> lock(m_Mutex);
     if(m_Frame->pkt_dts != AV_NOPTS_VALUE) {
         m_CurTimeStamp = m_Frame->pkt_dts;
@@ -231,36 +231,36 @@ void DecoderBase::UpdateTimeStamp() {
         m_CurTimeStamp = 0;
     }
 
-    m_CurTimeStamp = (int64_t)((m_CurTimeStamp * av_q2d(m_AVFormatContext->streams[m_StreamIndex]->time_base)) * 1000);
+    m_CurTimeStamp = av_rescale_q(m_CurTimeStamp, m_AVFormatContext->streams[m_StreamIndex]->time_base, AV_TIME_BASE_Q);
 
     if(m_SeekPosition > 0 && m_SeekSuccess)
     {
-        m_StartTimeStamp = GetSysCurrentTime() - m_CurTimeStamp;
+        m_StartTimeStamp = GetSysCurrentTimeUs() - m_CurTimeStamp;
         m_SeekPosition = 0;
         m_SeekSuccess = false;
     }
 }
 
 long DecoderBase::AVSync() {
-    LOGCATE("DecoderBase::AVSync");
-    long curSysTime = GetSysCurrentTime();
+    LOGCATT("DecoderBase::AVSync");
+    int64_t curSysTime = GetSysCurrentTimeUs();
     //基于系统时钟计算从开始播放流逝的时间
-    long elapsedTime = curSysTime - m_StartTimeStamp;
+    int64_t elapsedTime = curSysTime - m_StartTimeStamp;
 
     if(m_MsgContext && m_MsgCallback && m_MediaType == AVMEDIA_TYPE_AUDIO)
-        m_MsgCallback(m_MsgContext, MSG_DECODING_TIME, m_CurTimeStamp * 1.0f / 1000);
+        m_MsgCallback(m_MsgContext, MSG_DECODING_TIME, m_CurTimeStamp * 1.0f / 1000000);
 
     long delay = 0;
 
     //向系统时钟同步
     if(m_CurTimeStamp > elapsedTime) {
-        //休眠时间
-        auto sleepTime = static_cast<unsigned int>(m_CurTimeStamp - elapsedTime);//ms
+        //休眠时间 us
+        auto sleepTime = static_cast<unsigned int>(m_CurTimeStamp - elapsedTime);
         //限制休眠时间不能过长
         sleepTime = sleepTime > DELAY_THRESHOLD ? DELAY_THRESHOLD :  sleepTime;
-        av_usleep(sleepTime * 1000);
+        av_usleep(sleepTime);
     }
-    delay = elapsedTime - m_CurTimeStamp;
+    delay = elapsedTime - m_CurTimeStamp; //us
 
 
 //    if(m_AVSyncCallback != nullptr && m_SeekPosition == 0) {
@@ -282,7 +282,7 @@ long DecoderBase::AVSync() {
 }
 
 int DecoderBase::DecodeOnePacket() {
-    LOGCATE("DecoderBase::DecodeOnePacket m_MediaType=%d", m_MediaType);
+    LOGCATT("DecoderBase::DecodeOnePacket m_MediaType=%d", m_MediaType);
     if(m_SeekPosition > 0) {
         //seek to frame
         int64_t seek_target = static_cast<int64_t>(m_SeekPosition * 1000000);//微秒
@@ -325,12 +325,12 @@ int DecoderBase::DecodeOnePacket() {
                 //同步
                 AVSync();
                 //渲染
-                LOGCATE("DecoderBase::DecodeOnePacket 000 m_MediaType=%d", m_MediaType);
+                LOGCATT("DecoderBase::DecodeOnePacket 000 m_MediaType=%d", m_MediaType);
                 OnFrameAvailable(m_Frame);
-                LOGCATE("DecoderBase::DecodeOnePacket 0001 m_MediaType=%d", m_MediaType);
+                LOGCATT("DecoderBase::DecodeOnePacket 0001 m_MediaType=%d", m_MediaType);
                 frameCount ++;
             }
-            LOGCATE("BaseDecoder::DecodeOneFrame frameCount=%d", frameCount);
+            LOGCATT("BaseDecoder::DecodeOneFrame frameCount=%d", frameCount);
             //判断一个 packet 是否解码完成
             if(frameCount > 0) {
                 result = 0;
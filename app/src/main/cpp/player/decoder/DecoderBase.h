@@ -16,7 +16,7 @@ extern "C" {
 #include "Decoder.h"
 
 #define MAX_PATH   2048
-#define DELAY_THRESHOLD 100 //100ms
+#define DELAY_THRESHOLD (100 * 1000) //100ms，单位 us
 
 using namespace std;
 
@@ -115,10 +115,10 @@ private:
     AVMediaType      m_MediaType = AVMEDIA_TYPE_UNKNOWN;
     //文件地址
     char       m_Url[MAX_PATH] = {0};
-    //当前播放时间
-    long             m_CurTimeStamp = 0;
-    //播放的起始时间
-    long             m_StartTimeStamp = -1;
+    //当前播放时间 us
+    int64_t          m_CurTimeStamp = 0;
+    //播放的起始时间，单调时钟 us
+    int64_t          m_StartTimeStamp = -1;
     //总时长 ms
     long             m_Duration = 0;
     //数据流索引
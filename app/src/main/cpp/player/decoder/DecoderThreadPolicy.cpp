@@ -0,0 +1,113 @@
+#include <LogUtil.h>
+#include <cstdio>
+#include "DecoderThreadPolicy.h"
+
+extern "C" {
+#include <libavutil/cpu.h>
+};
+
+#define MAX_DECODE_THREADS  8
+#define MAX_CPU_NUM         32
+
+//读取 cpuN 的最高频率 kHz，读不到返回 0
+static long ReadCpuMaxFreq(int cpu) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    FILE *fp = fopen(path, "r");
+    if (fp == nullptr) return 0;
+    long freq = 0;
+    if (fscanf(fp, "%ld", &freq) != 1) freq = 0;
+    fclose(fp);
+    return freq;
+}
+
+//按各核最高频率统计大核数，读不到频率时返回全部核数
+static int DetectBigCoreCount() {
+    int cpuCount = av_cpu_count();
+    if (cpuCount > MAX_CPU_NUM) cpuCount = MAX_CPU_NUM;
+    long freqs[MAX_CPU_NUM] = {0};
+    long maxFreq = 0;
+    for (int i = 0; i < cpuCount; ++i) {
+        freqs[i] = ReadCpuMaxFreq(i);
+        if (freqs[i] > maxFreq) maxFreq = freqs[i];
+    }
+
+    int bigCoreCount = 0;
+    if (maxFreq > 0) {
+        //big.LITTLE 中大核与超大核频率接近，最高频率不到全部核中最高值 80% 的算作小核
+        for (int i = 0; i < cpuCount; ++i) {
+            if (freqs[i] * 10 >= maxFreq * 8) bigCoreCount++;
+        }
+    }
+    if (bigCoreCount <= 0) bigCoreCount = cpuCount > 0 ? cpuCount : 1;
+    LOGCATE("DecoderThreadPolicy::GetBigCoreCount cpu=%d, big=%d, maxFreq=%ld kHz", cpuCount, bigCoreCount, maxFreq);
+    return bigCoreCount;
+}
+
+int DecoderThreadPolicy::GetBigCoreCount() {
+    //多个播放器可能同时打开解码器，局部静态变量的初始化由编译器保证只执行一次且线程安全
+    static const int s_BigCoreCount = DetectBigCoreCount();
+    return s_BigCoreCount;
+}
+
+int DecoderThreadPolicy::GetThreadCountForResolution(int width, int height) {
+    int pixels = width * height;
+    if (pixels <= 0)          return 2;
+    if (pixels <= 640 * 480)  return 2;
+    if (pixels <= 1280 * 720) return 3;
+    if (pixels <= 1920 * 1088) return 4;
+    return MAX_DECODE_THREADS;
+}
+
+void DecoderThreadPolicy::Apply(AVCodecContext *codecContext, AVFormatContext *formatContext, AVStream *stream,
+                                int threadCount, int threadType, int maxLatencyMs) {
+    const AVCodec *codec = codecContext->codec;
+    bool frameCap = codec != nullptr && (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS);
+    bool sliceCap = codec != nullptr && (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS);
+    if (!frameCap && !sliceCap) {
+        //硬解或不支持多线程的解码器保持默认
+        LOGCATE("DecoderThreadPolicy::Apply codec=%s has no thread capability", codec ? codec->name : "null");
+        return;
+    }
+
+    int bigCoreCount = GetBigCoreCount();
+    int threads = threadCount;
+    if (threads <= 0) {
+        threads = GetThreadCountForResolution(codecContext->width, codecContext->height);
+        if (threads > bigCoreCount) threads = bigCoreCount;
+    }
+    if (threads > MAX_DECODE_THREADS) threads = MAX_DECODE_THREADS;
+    if (threads < 1) threads = 1;
+
+    //帧线程每多一个线程输出多延迟一帧，按帧率换算延迟预算内允许的线程数
+    AVRational frameRate = av_guess_frame_rate(formatContext, stream, nullptr);
+    double fps = frameRate.num && frameRate.den ? av_q2d(frameRate) : 25;
+    int maxFrameThreads = 1 + (int) (maxLatencyMs * fps / 1000);
+
+    int type = 0;
+    switch (threadType) {
+        case VIDEO_THREAD_FRAME:
+            type = frameCap ? FF_THREAD_FRAME : FF_THREAD_SLICE;
+            break;
+        case VIDEO_THREAD_SLICE:
+            type = sliceCap ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+            break;
+        default:
+            if (frameCap && (threads <= maxFrameThreads || !sliceCap)) {
+                type = FF_THREAD_FRAME;
+            } else {
+                type = sliceCap ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+            }
+            break;
+    }
+    //自动模式下即使只能用帧线程，也不超出延迟预算
+    if (type == FF_THREAD_FRAME && threadType == VIDEO_THREAD_AUTO && threads > maxFrameThreads) {
+        threads = maxFrameThreads;
+    }
+
+    codecContext->thread_count = threads;
+    codecContext->thread_type = type;
+    LOGCATE("DecoderThreadPolicy::Apply codec=%s, [w,h]=[%d, %d], fps=%.2f, bigCore=%d, thread_count=%d, thread_type=%s, added latency=%d frames",
+            codec->name, codecContext->width, codecContext->height, fps, bigCoreCount, threads,
+            type == FF_THREAD_FRAME ? "frame" : "slice", type == FF_THREAD_FRAME ? threads - 1 : 0);
+}
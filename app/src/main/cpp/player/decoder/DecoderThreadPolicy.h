@@ -0,0 +1,39 @@
+#ifndef LEARNFFMPEG_DECODERTHREADPOLICY_H
+#define LEARNFFMPEG_DECODERTHREADPOLICY_H
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+};
+
+//软解线程类型，对应 PLAYER_OPTION_VIDEO_THREAD_TYPE
+enum VideoThreadType {
+    VIDEO_THREAD_AUTO,      // 按延迟预算在帧线程和片线程之间选择
+    VIDEO_THREAD_FRAME,     // 帧线程，吞吐最高，每多一个线程输出多延迟一帧
+    VIDEO_THREAD_SLICE,     // 片线程，不增加延迟，加速效果取决于码流的分片数
+};
+
+/**
+ * 视频软解的线程策略，在 avcodec_open2 之前调用 Apply。
+ * 线程数按分辨率取，不超过大核个数（小核参与帧线程时会拖慢整体节奏）；
+ * 帧线程会让解码输出延迟 thread_count - 1 帧，超出延迟预算时改用片线程或减少线程数。
+ */
+class DecoderThreadPolicy {
+public:
+    /**
+     * @param threadCount 指定线程数，0 表示按分辨率和核数自动选择
+     * @param threadType VideoThreadType
+     * @param maxLatencyMs 帧线程允许增加的输出延迟，单位 ms
+     */
+    static void Apply(AVCodecContext *codecContext, AVFormatContext *formatContext, AVStream *stream,
+                      int threadCount, int threadType, int maxLatencyMs);
+
+    //大核（最高频率不低于最快核心 80% 的核）个数，读不到频率时返回在线核数
+    static int GetBigCoreCount();
+
+private:
+    static int GetThreadCountForResolution(int width, int height);
+};
+
+
+#endif //LEARNFFMPEG_DECODERTHREADPOLICY_H
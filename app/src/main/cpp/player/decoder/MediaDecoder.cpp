@@ -2,6 +2,8 @@
 // Created by 字节流动 on 2020/10/10.
 //
 
+#include <LogUtil.h>
+#include <TraceRecorder.h>
 #include "MediaDecoder.h"
 
 MediaDecoder::MediaDecoder(AVCodecContext *avCodecContext, AVStream *avStream, int streamIndex,
@@ -11,6 +13,7 @@ MediaDecoder::MediaDecoder(AVCodecContext *avCodecContext, AVStream *avStream, i
     m_StreamIndex = streamIndex;
     m_PlayerState = playerState;
     m_PacketQueue = new AVPacketQueue();
+    m_PendingPacket = av_packet_alloc();
 }
 
 MediaDecoder::~MediaDecoder() {
@@ -21,6 +24,10 @@ MediaDecoder::~MediaDecoder() {
         delete m_PacketQueue;
         m_PacketQueue = nullptr;
     }
+    if(m_PendingPacket) {
+        av_packet_free(&m_PendingPacket);
+        m_PendingPacket = nullptr;
+    }
 
     m_AvCodecContext = nullptr;
     m_AvStream = nullptr;
@@ -47,11 +54,10 @@ void MediaDecoder::Stop() {
 }
 
 void MediaDecoder::Flush() {
+    //只递增队列序号，解码线程取到新序号的数据包时自己刷新解码器，seek 不阻塞解码线程
     if(m_PacketQueue) {
         m_PacketQueue->Flush();
     }
-    unique_lock<mutex> lock(m_PlayerState->m_Mutex);
-    avcodec_flush_buffers(GetCodecContext());
 }
 
 void MediaDecoder::Run() {
@@ -59,10 +65,127 @@ void MediaDecoder::Run() {
 }
 
 int MediaDecoder::PushPacket(AVPacket *avPacket) {
+    int result = -1;
     if(m_PacketQueue) {
-        m_PacketQueue->PushPacket(avPacket);
+        //队列满时等待解码线程消费，同时响应退出和 seek 请求（seek 时解码线程不再取包）
+        while ((result = m_PacketQueue->PushPacket(avPacket, 0)) == 0) {
+            if(m_PlayerState->m_AbortRequest || m_PlayerState->m_SeekRequest) {
+                result = -1;
+                break;
+            }
+            m_PacketQueue->WaitWritable(10);
+        }
+        if(result > 0) {
+            bool isVideo = m_AvStream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO;
+            m_PlayerState->m_Stats.UpdatePeak(isVideo ? PLAYER_COUNTER_VIDEO_PACKET_QUEUE_PEAK_BYTES
+                                                      : PLAYER_COUNTER_AUDIO_PACKET_QUEUE_PEAK_BYTES,
+                                              m_PacketQueue->GetSize());
+        }
+    }
+    if(result < 0) {
+        av_packet_unref(avPacket);
+    }
+    return result;
+}
+
+int MediaDecoder::PushNullPacket() {
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = nullptr;
+    pkt.size = 0;
+    pkt.stream_index = m_StreamIndex;
+    return PushPacket(&pkt);
+}
+
+int MediaDecoder::DecodeFrame(AVFrame *frame) {
+    bool isVideo = m_AvStream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO;
+    int64_t decodeTime = 0; //本帧在 send_packet + receive_frame 中花费的时间
+    int ret = 0;
+    for (;;) {
+        // 先把解码器中已有的帧取完，直到 EAGAIN（需要新数据包）；
+        // 序号已改变时解码器中剩下的都是 seek 之前的帧，不再取出，取到新序号的数据包时随刷新一起丢弃
+        if (m_PacketQueue->GetSerial() == m_PktSerial) {
+            do {
+                if (m_AbortRequest || m_PlayerState->m_AbortRequest) {
+                    return -1;
+                }
+                int64_t startTime = GetSysCurrentTimeUs();
+                {
+                    TRACE_SCOPE(isVideo ? "video avcodec_receive_frame" : "audio avcodec_receive_frame");
+                    ret = avcodec_receive_frame(m_AvCodecContext, frame);
+                }
+                decodeTime += GetSysCurrentTimeUs() - startTime;
+                if (ret >= 0) {
+                    m_PlayerState->m_Stats.RecordLatency(isVideo ? PLAYER_STAGE_VIDEO_DECODE : PLAYER_STAGE_AUDIO_DECODE, decodeTime);
+                    return 1;
+                }
+                if (ret == AVERROR_EOF) {
+                    // 空包之后的尾帧已全部取出，复位解码器，循环播放或 seek 后可以继续送包
+                    avcodec_flush_buffers(m_AvCodecContext);
+                    m_Finished = m_PktSerial;
+                    return 0;
+                }
+            } while (ret != AVERROR(EAGAIN));
+        }
+
+        // 取数据包，丢弃序号过期的包（包括 EAGAIN 时暂存的包），队列为空时阻塞，不轮询 seek 状态
+        AVPacket pkt;
+        for (;;) {
+            if (m_IsPacketPending) {
+                av_packet_move_ref(&pkt, m_PendingPacket);
+                m_IsPacketPending = false;
+            } else {
+                int oldSerial = m_PktSerial;
+                if (m_PacketQueue->GetPacket(&pkt, 1, &m_PktSerial) < 0) {
+                    return -1;
+                }
+                if (oldSerial != m_PktSerial) {
+                    avcodec_flush_buffers(m_AvCodecContext);
+                    OnCodecFlush();
+                }
+            }
+            if (m_PacketQueue->GetSerial() == m_PktSerial) {
+                break;
+            }
+            av_packet_unref(&pkt);
+        }
+
+        OnSendPacket(&pkt);
+        if (pkt.data != nullptr) {
+            m_Finished = -1;
+        }
+        int64_t startTime = GetSysCurrentTimeUs();
+        {
+            TRACE_SCOPE(isVideo ? "video avcodec_send_packet" : "audio avcodec_send_packet");
+            ret = avcodec_send_packet(m_AvCodecContext, &pkt);
+        }
+        decodeTime += GetSysCurrentTimeUs() - startTime;
+        if (ret == AVERROR(EAGAIN)) {
+            // 帧已取完时 send 不应再返回 EAGAIN，保留数据包下次重发，不丢包
+            LOGCATE("MediaDecoder::DecodeFrame receive_frame and send_packet both returned EAGAIN");
+            av_packet_move_ref(m_PendingPacket, &pkt);
+            m_IsPacketPending = true;
+        } else if (ret < 0 && ret != AVERROR_EOF) {
+            LOGCAT_RATE_LIMIT(LOGCATE, 1000, "MediaDecoder::DecodeFrame avcodec_send_packet fail ret=%d", ret);
+        }
+        av_packet_unref(&pkt);
+    }
+}
+
+void MediaDecoder::SetSeekTarget(int64_t targetUs, int seekMode) {
+    m_SeekSerial.store(-1);
+    m_SeekTarget.store(targetUs);
+    m_SeekMode.store(seekMode);
+    m_SeekSerial.store(GetSerial());
+}
+
+bool MediaDecoder::GetSeekTarget(int serial, int64_t *targetUs, int *seekMode) {
+    if (m_SeekSerial.load() != serial) {
+        return false;
     }
-    return -1;
+    *targetUs = m_SeekTarget.load();
+    *seekMode = m_SeekMode.load();
+    return m_SeekSerial.load() == serial;
 }
 
 int MediaDecoder::GetPacketSize() {
@@ -73,7 +196,36 @@ int MediaDecoder::GetStreamIndex() {
     return m_StreamIndex;
 }
 
+void MediaDecoder::SetPacketQueueLimit(int64_t maxBytes, int64_t maxDurationMs, int lowWaterPercent) {
+    if(m_PacketQueue) {
+        int64_t maxDuration = maxDurationMs > 0 ? av_rescale_q(maxDurationMs, (AVRational){1, 1000}, m_AvStream->time_base) : 0;
+        m_PacketQueue->SetLimit(maxBytes, maxDuration, lowWaterPercent);
+    }
+}
+
+int MediaDecoder::IsPacketQueueFull() {
+    return m_PacketQueue ? m_PacketQueue->IsFull() : 0;
+}
+
+int MediaDecoder::IsPacketQueueBelowLowWater() {
+    return m_PacketQueue ? m_PacketQueue->IsBelowLowWater() : 1;
+}
+
+void MediaDecoder::RequestPacketQueueNotify() {
+    if(m_PacketQueue) {
+        m_PacketQueue->RequestLowWaterNotify();
+    }
+}
+
+void MediaDecoder::SetPacketQueueCallback(void *context, PacketQueueCallback callback) {
+    if(m_PacketQueue) {
+        m_PacketQueue->SetLowWaterCallback(context, callback);
+    }
+}
+
 void MediaDecoder::DoAsyncDecoding(MediaDecoder *decoder) {
-    if(decoder != nullptr)
+    if(decoder != nullptr) {
+        TRACE_THREAD_NAME(decoder->m_AvStream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO ? "video_decode" : "audio_decode");
         decoder->Run();
+    }
 }
@@ -14,6 +14,8 @@ extern "C" {
 };
 
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <PlayerState.h>
 #include <queue/AVPacketQueue.h>
 
@@ -43,10 +45,38 @@ public:
 
     int PushPacket(AVPacket *avPacket);
 
+    // 文件读完后送入空包，解码器收到后输出内部缓存的尾帧
+    int PushNullPacket();
+
+    // 当前序号的空包之后的帧已全部取出，seek（序号改变）或送入新数据包后复位
+    int IsFinished() {
+        return m_Finished == GetSerial();
+    }
+
+    // 数据包队列的当前序号，每次 seek 加 1，帧的 serial 与之不一致时已过期
+    int GetSerial() {
+        return m_PacketQueue ? m_PacketQueue->GetSerial() : 0;
+    }
+
+    // 解封装线程在 Flush 之后、送入新数据包之前调用，记录本次 seek 的目标 us（AV_TIME_BASE）和 SeekMode
+    void SetSeekTarget(int64_t targetUs, int seekMode);
+
     int GetPacketSize();
 
     int GetStreamIndex();
 
+    // 数据包队列上限，maxDurationMs 按流的 time_base 换算，0 表示不限制
+    void SetPacketQueueLimit(int64_t maxBytes, int64_t maxDurationMs, int lowWaterPercent);
+
+    int IsPacketQueueFull();
+
+    int IsPacketQueueBelowLowWater();
+
+    // 解封装线程等待前调用，队列降到低水位以下时回调 callback
+    void RequestPacketQueueNotify();
+
+    void SetPacketQueueCallback(void *context, PacketQueueCallback callback);
+
     AVStream *GetStream() {
         return m_AvStream;
     }
@@ -63,6 +93,21 @@ public:
 protected:
     static void DoAsyncDecoding(MediaDecoder *decoder);
 
+    /**
+     * 解码一帧：先取出解码器中已解好的帧（一个包可能解出多帧），没有时才从队列取包送入解码器
+     * @return 1 得到一帧（所属序号为 m_PktSerial），0 解码器已排空（收到空包），小于 0 退出
+     */
+    int DecodeFrame(AVFrame *frame);
+
+    // 数据包送入解码器之前调用，在解码线程中执行
+    virtual void OnSendPacket(AVPacket *packet) {}
+
+    // 取到新序号的第一个数据包、刷新解码器之后调用，在解码线程中执行
+    virtual void OnCodecFlush() {}
+
+    // 取序号 serial 对应的 seek 目标，该序号不是 seek 产生的或已被之后的 seek 覆盖时返回 false
+    bool GetSeekTarget(int serial, int64_t *targetUs, int *seekMode);
+
     mutex m_Mutex;
     condition_variable m_CondVar;
     PlayerState *m_PlayerState = nullptr;
@@ -71,6 +116,17 @@ protected:
     AVStream *m_AvStream = nullptr;
     int m_StreamIndex = -1;
     volatile int m_AbortRequest = 0;
+    volatile int m_Finished = -1;   // 排空时的数据包序号，-1 表示未排空
+    //最近一次取出的数据包的序号，即解码器当前输出帧所属的序号，仅解码线程访问。
+    //m_AvCodecContext 的 flush/send/receive 都在解码线程中执行，不需要加锁
+    int m_PktSerial = 0;
+    //最近一次 seek 的目标，解封装线程写、解码线程读；先把 m_SeekSerial 置为 -1 再写，读取前后序号一致才有效
+    atomic<int> m_SeekSerial{-1};
+    atomic<int64_t> m_SeekTarget{0};
+    atomic<int> m_SeekMode{0};
+    //avcodec_send_packet 返回 EAGAIN 时暂存的数据包，下次先送这个包
+    AVPacket *m_PendingPacket = nullptr;
+    bool m_IsPacketPending = false;
     void * m_MsgContext = nullptr;
     PlayerMessageCallback m_MsgCallback = nullptr;
 };
@@ -2,6 +2,7 @@
 // Created by 字节流动 on 2020/6/17.
 //
 
+#include <YuvConverter.h>
 #include "VideoDecoder.h"
 
 void VideoDecoder::OnDecoderReady() {
@@ -17,15 +18,26 @@ void VideoDecoder::OnDecoderReady() {
         m_VideoRender->Init(m_VideoWidth, m_VideoHeight, dstSize);
         m_RenderWidth = dstSize[0];
         m_RenderHeight = dstSize[1];
-        m_RGBAFrame = av_frame_alloc();
-        int bufferSize = av_image_get_buffer_size(DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
-        m_FrameBuffer = (uint8_t *) av_malloc(bufferSize * sizeof(uint8_t));
-        av_image_fill_arrays(m_RGBAFrame->data, m_RGBAFrame->linesize,
-                             m_FrameBuffer, DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
-
-        m_SwsContext = sws_getContext(m_VideoWidth, m_VideoHeight, GetCodecContext()->pix_fmt,
-                                      m_RenderWidth, m_RenderHeight, DST_PIXEL_FORMAT,
-                                      SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+        AVCodecContext *avCodecContext = GetCodecContext();
+        int colorSpace = avCodecContext->colorspace == AVCOL_SPC_BT709
+                || (avCodecContext->colorspace == AVCOL_SPC_UNSPECIFIED && m_VideoHeight >= 720)
+                ? YUV_COLOR_SPACE_BT709 : YUV_COLOR_SPACE_BT601;
+        int colorRange = avCodecContext->color_range == AVCOL_RANGE_JPEG || avCodecContext->pix_fmt == AV_PIX_FMT_YUVJ420P
+                ? YUV_COLOR_RANGE_FULL : YUV_COLOR_RANGE_LIMITED;
+        m_VideoRender->SetColorSpace(colorSpace, colorRange);
+
+        if(GetImageFormat(avCodecContext->pix_fmt) == 0) {
+            m_RGBAFrame = av_frame_alloc();
+            int bufferSize = av_image_get_buffer_size(DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
+            m_FrameBuffer = (uint8_t *) av_malloc(bufferSize * sizeof(uint8_t));
+            av_image_fill_arrays(m_RGBAFrame->data, m_RGBAFrame->linesize,
+                                 m_FrameBuffer, DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
+
+            m_SwsContext = sws_getContext(m_VideoWidth, m_VideoHeight, avCodecContext->pix_fmt,
+                                          m_RenderWidth, m_RenderHeight, DST_PIXEL_FORMAT,
+                                          SWS_FAST_BILINEAR, NULL, NULL, NULL);
+        }
     } else {
         LOGCATE("VideoDecoder::OnDecoderReady m_VideoRender == null");
     }
@@ -58,20 +70,12 @@ void VideoDecoder::OnDecoderDone() {
 }
 
 void VideoDecoder::OnFrameAvailable(AVFrame *frame) {
-    LOGCATE("VideoDecoder::OnFrameAvailable frame=%p", frame);
+    LOGCATT("VideoDecoder::OnFrameAvailable frame=%p", frame);
     if(m_VideoRender != nullptr && frame != nullptr) {
         NativeImage image;
-        LOGCATE("VideoDecoder::OnFrameAvailable frame[w,h]=[%d, %d],format=%d,[line0,line1,line2]=[%d, %d, %d]", frame->width, frame->height, GetCodecContext()->pix_fmt, frame->linesize[0], frame->linesize[1],frame->linesize[2]);
-        if(m_VideoRender->GetRenderType() == VIDEO_RENDER_ANWINDOW)
-        {
-            sws_scale(m_SwsContext, frame->data, frame->linesize, 0,
-                      m_VideoHeight, m_RGBAFrame->data, m_RGBAFrame->linesize);
-
-            image.format = IMAGE_FORMAT_RGBA;
-            image.width = m_RenderWidth;
-            image.height = m_RenderHeight;
-            image.ppPlane[0] = m_RGBAFrame->data[0];
-        } else if(GetCodecContext()->pix_fmt == AV_PIX_FMT_YUV420P || GetCodecContext()->pix_fmt == AV_PIX_FMT_YUVJ420P) {
+        LOGCATT("VideoDecoder::OnFrameAvailable frame[w,h]=[%d, %d],format=%d,[line0,line1,line2]=[%d, %d, %d]", frame->width, frame->height, GetCodecContext()->pix_fmt, frame->linesize[0], frame->linesize[1],frame->linesize[2]);
+        //I420/NV12/NV21/RGBA 直接交给渲染器，其他格式用 sws_scale 转为 RGBA
+        if(GetCodecContext()->pix_fmt == AV_PIX_FMT_YUV420P || GetCodecContext()->pix_fmt == AV_PIX_FMT_YUVJ420P) {
             image.format = IMAGE_FORMAT_I420;
             image.width = frame->width;
             image.height = frame->height;
@@ -3,14 +3,22 @@
 //
 
 #include <LogUtil.h>
+#include <TraceRecorder.h>
 #include "VideoMediaDecoder.h"
 
+//各跳帧级别对应的 skip_frame / skip_loop_filter
+static const AVDiscard SKIP_FRAME[VIDEO_SKIP_LEVEL_NUM] = {
+        AVDISCARD_DEFAULT, AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_BIDIR, AVDISCARD_NONKEY};
+static const AVDiscard SKIP_LOOP_FILTER[VIDEO_SKIP_LEVEL_NUM] = {
+        AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_BIDIR, AVDISCARD_BIDIR, AVDISCARD_BIDIR};
+
 VideoMediaDecoder::VideoMediaDecoder(AVFormatContext *avFormatContext,
                                      AVCodecContext *avCodecContext, AVStream *avStream,
                                      int streamIndex, PlayerState *playerState)
                                      :MediaDecoder(avCodecContext, avStream, streamIndex, playerState) {
     m_FormatContext = avFormatContext;
     m_FrameQueue = new AVFrameQueue(VIDEO_QUEUE_SIZE, 1);
+    m_Lateness = 0;
 
     AVDictionaryEntry *entry = av_dict_get(avStream->metadata, "rotate", NULL, AV_DICT_MATCH_CASE);
     if (entry && entry->value) {
@@ -54,10 +62,10 @@ void VideoMediaDecoder::Stop() {
 }
 
 void VideoMediaDecoder::Flush() {
+    //帧队列中 seek 之前的帧由同步线程按序号丢弃，这里不等待同步线程
     MediaDecoder::Flush();
-    if(m_FrameQueue != nullptr) {
-        m_FrameQueue->Flush();
-    }
+    //seek 后时钟重新建立，跳帧级别由解码线程刷新解码器时复位
+    m_Lateness = 0;
 }
 
 void VideoMediaDecoder::Run() {
@@ -78,104 +86,163 @@ int VideoMediaDecoder::GetFrameQueueSize() {
 
 int VideoMediaDecoder::DecodeVideo() {
     AVFrame *frame = av_frame_alloc();
-    AVPacket *packet = av_packet_alloc();
     Frame *vp;
-    int got_picture;
     int result = 0;
 
     AVRational tb = m_AvStream->time_base;
     AVRational frame_rate = av_guess_frame_rate(m_FormatContext, m_AvStream, NULL);
+    double frameDuration = frame_rate.num && frame_rate.den ? av_q2d((AVRational){frame_rate.den, frame_rate.num}) : 0;
+    m_FrameDurationTb = frame_rate.num && frame_rate.den ? av_rescale_q(1, av_inv_q(frame_rate), tb) : 0;
 
-    if (!frame || !packet) {
-        result = AVERROR(ENOMEM);
-        goto EXIT;
+    if (!frame) {
+        return AVERROR(ENOMEM);
     }
 
     for (;;) {
-
-        if (m_AbortRequest || m_PlayerState->m_AbortRequest) {
-            result = -1;
+        // 一个包可能解出多帧，也可能没有帧，DecodeFrame 负责 send/receive 的配对
+        result = DecodeFrame(frame);
+        if (result < 0) {
             break;
         }
-
-        if (m_PlayerState->m_SeekRequest) {
+        if (result == 0) {
+            // 尾帧已全部输出，等待 seek 或循环播放后的新数据包
             continue;
         }
 
-        if (m_PacketQueue->GetPacket(packet) < 0) {
+        // 默认情况下需要重排pts的
+        frame->pts = av_frame_get_best_effort_timestamp(frame);
+        CountSkippedFrames(frame, frameDuration);
+        m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_DECODED_VIDEO_FRAMES);
+
+        // 精确 seek：显示区间在目标位置之前的帧只作为参考帧解码，不进入帧队列，不做格式转换和纹理上传
+        if (m_SeekTargetPts != AV_NOPTS_VALUE) {
+            if (frame->pts != AV_NOPTS_VALUE && frame->pts + m_FrameDurationTb <= m_SeekTargetPts) {
+                m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_SEEK_DISCARDED_VIDEO_FRAMES);
+                av_frame_unref(frame);
+                continue;
+            }
+            //到达目标，恢复跳帧级别对应的 skip_frame
+            m_SeekTargetPts = AV_NOPTS_VALUE;
+            m_AvCodecContext->skip_frame = SKIP_FRAME[m_SkipLevel];
+        }
+
+        // 取出帧
+        if (!(vp = m_FrameQueue->PeekWritable())) {
             result = -1;
             break;
         }
 
-        // 送去解码
-        long long startTime = GetSysCurrentTime();//统计解码一帧的耗时
-        unique_lock<mutex> playerStateLock(m_PlayerState->m_Mutex);
-        result = avcodec_send_packet(m_AvCodecContext, packet);
-        if (result < 0 && result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
-            av_packet_unref(packet);
-            playerStateLock.unlock();
-            continue;
-        }
-        LOGCATE("VideoMediaDecoder::DecodeVideo packet->flags=%d, %d", packet->flags, AV_PKT_FLAG_KEY);
-
-        // 得到解码帧
-        result = avcodec_receive_frame(m_AvCodecContext, frame);
-        playerStateLock.unlock();
-        LOGCATE("VideoMediaDecoder::DecodeVideo decode one frame cost time %lld ms", GetSysCurrentTime() - startTime);
-        if (result < 0 && result != AVERROR_EOF) {
-            av_frame_unref(frame);
-            av_packet_unref(packet);
-            continue;
-        } else {
-            got_picture = 1;
+        // 复制参数
+        vp->uploaded = 0;
+        vp->width = frame->width;
+        vp->height = frame->height;
+        vp->format = frame->format;
+        vp->pts = (frame->pts == AV_NOPTS_VALUE) ? NAN : frame->pts * av_q2d(tb) * 1000000; //us
+        vp->duration = frameDuration * 1000000; //us，与 pts 单位一致
+        vp->serial = m_PktSerial;
+        vp->immediate = m_ShowImmediately;
+        m_ShowImmediately = false;
+        av_frame_move_ref(vp->frame, frame);
+
+        // 入队帧
+        m_FrameQueue->PushFrame();
+        m_PlayerState->m_Stats.UpdatePeak(PLAYER_COUNTER_VIDEO_FRAME_QUEUE_PEAK, m_FrameQueue->GetFrameSize());
+    }
 
-            // 默认情况下需要重排pts的
-            frame->pts = av_frame_get_best_effort_timestamp(frame);
-        }
+    av_frame_free(&frame);
+    return result;
+}
 
-        if (got_picture) {
+void VideoMediaDecoder::OnSendPacket(AVPacket *packet) {
+    LOGCATT("VideoMediaDecoder::OnSendPacket packet->flags=%d, %d", packet->flags, AV_PKT_FLAG_KEY);
+    UpdateSkipLevel();
+
+    //精确 seek 期间，显示时间在目标之前的非参考帧既不显示也不被其他帧参考，直接不解码；
+    //按包的 pts 逐包设置，目标之后（解码顺序提前）的 B 帧照常解码
+    if (m_SeekTargetPts != AV_NOPTS_VALUE) {
+        int64_t duration = packet->duration > 0 ? packet->duration : m_FrameDurationTb;
+        bool beforeTarget = packet->data != nullptr && packet->pts != AV_NOPTS_VALUE
+                            && packet->pts + duration <= m_SeekTargetPts;
+        m_AvCodecContext->skip_frame = beforeTarget ? AVDISCARD_NONREF : SKIP_FRAME[m_SkipLevel];
+    }
+}
 
-            // 取出帧
-            if (!(vp = m_FrameQueue->PeekWritable())) {
-                result = -1;
-                break;
-            }
+void VideoMediaDecoder::RequestRender() {
+    if(m_MsgCallback != nullptr) {
+        m_MsgCallback(m_MsgContext, PLAYER_MSG_REQUEST_RENDER, 0);
+    }
+}
 
-            // 复制参数
-            vp->uploaded = 0;
-            vp->width = frame->width;
-            vp->height = frame->height;
-            vp->format = frame->format;
-            vp->pts = (frame->pts == AV_NOPTS_VALUE) ? NAN : frame->pts * av_q2d(tb) * 1000; //ms
-            vp->duration = frame_rate.num && frame_rate.den
-                           ? av_q2d((AVRational){frame_rate.den, frame_rate.num}) : 0;
-            av_frame_move_ref(vp->frame, frame);
-
-            // 入队帧
-            m_FrameQueue->PushFrame();
-        }
+void VideoMediaDecoder::ReportLateness(int64_t latenessUs) {
+    //只有同步线程写入，按 1/8 权重做指数平均，过滤单帧的抖动
+    int64_t lateness = m_Lateness.load(memory_order_relaxed);
+    m_Lateness.store(lateness + (latenessUs - lateness) / 8, memory_order_relaxed);
+}
 
-        // 释放数据包和缓冲帧的引用，防止内存泄漏
-        av_frame_unref(frame);
-        av_packet_unref(packet);
+void VideoMediaDecoder::OnCodecFlush() {
+    m_LastFramePts = AV_NOPTS_VALUE;
+    m_CatchUpTime = 0;
+    if (m_SkipLevel != VIDEO_SKIP_NONE) SetSkipLevel(VIDEO_SKIP_NONE);
+    //上一次精确 seek 可能还没到达目标，skip_frame 仍是 AVDISCARD_NONREF
+    m_AvCodecContext->skip_frame = SKIP_FRAME[m_SkipLevel];
+
+    m_SeekTargetPts = AV_NOPTS_VALUE;
+    m_ShowImmediately = false;
+    int64_t target = 0;
+    int seekMode = SEEK_MODE_DEFAULT;
+    if (GetSeekTarget(m_PktSerial, &target, &seekMode)) {
+        if (seekMode == SEEK_MODE_ACCURATE) {
+            m_SeekTargetPts = av_rescale_q(target, AV_TIME_BASE_Q, m_AvStream->time_base);
+        }
+        m_ShowImmediately = seekMode == SEEK_MODE_SCRUB;
     }
+}
 
-EXIT:
-    if(frame != nullptr) {
-        av_frame_free(&frame);
-        frame = nullptr;
-    }
+void VideoMediaDecoder::UpdateSkipLevel() {
+    if (!m_PlayerState->m_VideoFrameSkip) return;
 
-    if(packet != nullptr) {
-        av_packet_free(&packet);
-        packet = nullptr;
+    int64_t now = GetSysCurrentTimeUs();
+    int64_t lateness = m_Lateness.load(memory_order_relaxed);
+    if (lateness > VIDEO_SKIP_ESCALATE_LATENESS) {
+        m_CatchUpTime = 0;
+        if (m_SkipLevel < VIDEO_SKIP_LEVEL_NUM - 1 && now - m_SkipLevelTime >= VIDEO_SKIP_ESCALATE_INTERVAL) {
+            SetSkipLevel(m_SkipLevel + 1);
+        }
+    } else if (lateness < VIDEO_SKIP_RELAX_LATENESS) {
+        //连续追上 VIDEO_SKIP_RELAX_INTERVAL 后才降一级，每降一级重新计时
+        if (m_CatchUpTime == 0) m_CatchUpTime = now;
+        if (m_SkipLevel > VIDEO_SKIP_NONE && now - m_CatchUpTime >= VIDEO_SKIP_RELAX_INTERVAL
+            && now - m_SkipLevelTime >= VIDEO_SKIP_RELAX_INTERVAL) {
+            SetSkipLevel(m_SkipLevel - 1);
+        }
+    } else {
+        m_CatchUpTime = 0;
     }
+}
 
-    return result;
+void VideoMediaDecoder::SetSkipLevel(int level) {
+    LOGCATE("VideoMediaDecoder::SetSkipLevel level %d -> %d, lateness=%lld us", m_SkipLevel, level,
+            (long long) m_Lateness.load(memory_order_relaxed));
+    //解码线程在两次 send_packet 之间修改，帧线程模式下新值随下一个包同步到工作线程
+    m_AvCodecContext->skip_frame = SKIP_FRAME[level];
+    m_AvCodecContext->skip_loop_filter = SKIP_LOOP_FILTER[level];
+    m_SkipLevel = level;
+    m_SkipLevelTime = GetSysCurrentTimeUs();
+    m_PlayerState->m_Stats.SetCounter(PLAYER_COUNTER_VIDEO_SKIP_LEVEL, level);
+    m_PlayerState->m_Stats.UpdatePeak(PLAYER_COUNTER_VIDEO_SKIP_LEVEL_PEAK, level);
 }
 
-void VideoMediaDecoder::RequestRender() {
-    if(m_MsgCallback != nullptr) {
-        m_MsgCallback(m_MsgContext, PLAYER_MSG_REQUEST_RENDER, 0);
+void VideoMediaDecoder::CountSkippedFrames(AVFrame *frame, double frameDuration) {
+    //被跳过的帧不会从解码器输出，用相邻输出帧的时间戳间隔估算跳过的帧数
+    if (m_SkipLevel >= VIDEO_SKIP_NONREF && frameDuration > 0
+        && m_LastFramePts != AV_NOPTS_VALUE && frame->pts != AV_NOPTS_VALUE && frame->pts > m_LastFramePts) {
+        double interval = (frame->pts - m_LastFramePts) * av_q2d(m_AvStream->time_base);
+        int64_t skipped = (int64_t) (interval / frameDuration + 0.5) - 1;
+        if (skipped > 0) {
+            m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_SKIPPED_VIDEO_FRAMES, skipped);
+        }
+    }
+    if (frame->pts != AV_NOPTS_VALUE) {
+        m_LastFramePts = frame->pts;
     }
 }
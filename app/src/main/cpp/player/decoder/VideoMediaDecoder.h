@@ -5,11 +5,27 @@
 #ifndef LEARNFFMPEG_VIDEOMEDIADECODER_H
 #define LEARNFFMPEG_VIDEOMEDIADECODER_H
 
+#include <atomic>
 #include <queue/AVFrameQueue.h>
 #include "MediaDecoder.h"
 
 #define VIDEO_QUEUE_SIZE 10
 
+#define VIDEO_SKIP_ESCALATE_LATENESS  (40 * 1000)     //平均落后超过 40 ms 时升一级，单位 us
+#define VIDEO_SKIP_RELAX_LATENESS     (5 * 1000)      //平均落后低于 5 ms 时降一级，单位 us
+#define VIDEO_SKIP_ESCALATE_INTERVAL  (300 * 1000)    //两次调整之间至少间隔 300 ms，等上一级生效后再评估，单位 us
+#define VIDEO_SKIP_RELAX_INTERVAL     (1000 * 1000)   //追上后保持 1 s 才降级，避免在两级之间来回切换，单位 us
+
+//解码跳帧级别，视频持续落后于主时钟时逐级升高，追上后逐级回落
+enum VideoSkipLevel {
+    VIDEO_SKIP_NONE,            // 正常解码
+    VIDEO_SKIP_LOOP_FILTER,     // 非参考帧不做环路滤波，不影响后续帧的参考
+    VIDEO_SKIP_NONREF,          // 跳过非参考帧，B 帧不做环路滤波
+    VIDEO_SKIP_BIDIR,           // 跳过所有 B 帧
+    VIDEO_SKIP_NONKEY,          // 只解关键帧
+    VIDEO_SKIP_LEVEL_NUM
+};
+
 class VideoMediaDecoder : public MediaDecoder {
 public:
     VideoMediaDecoder(AVFormatContext *avFormatContext, AVCodecContext *avCodecContext, AVStream *avStream, int streamIndex, PlayerState *playerState);
@@ -32,13 +48,39 @@ public:
 
     void RequestRender();
 
+    //同步线程调用，反馈当前帧相对主时钟的落后时间 us（提前为负），解码线程据此调整跳帧级别
+    void ReportLateness(int64_t latenessUs);
+
+protected:
+    virtual void OnSendPacket(AVPacket *packet);
+
+    virtual void OnCodecFlush();
+
 private:
     int DecodeVideo();
 
+    void UpdateSkipLevel();
+
+    void SetSkipLevel(int level);
+
+    void CountSkippedFrames(AVFrame *frame, double frameDuration);
+
     AVFormatContext *m_FormatContext = nullptr;
     AVFrameQueue *m_FrameQueue = nullptr;
     int m_FrameRotateAngle = 0;
     thread *m_Thread = nullptr;
+
+    //跳帧反馈，m_Lateness 为平滑后的落后时间，由同步线程写、解码线程读
+    atomic<int64_t> m_Lateness;
+    //以下只在解码线程中访问
+    int m_SkipLevel = VIDEO_SKIP_NONE;
+    int64_t m_SkipLevelTime = 0;        // 上次调整级别的时间
+    int64_t m_CatchUpTime = 0;          // 本次追上主时钟的开始时间，0 表示仍然落后
+    int64_t m_LastFramePts = AV_NOPTS_VALUE;
+    //seek 后的取帧策略，刷新解码器时按本序号的 seek 目标设置
+    int64_t m_SeekTargetPts = AV_NOPTS_VALUE;   // 精确 seek 的目标（流的 time_base），之前的帧解码后丢弃
+    int64_t m_FrameDurationTb = 0;              // 按帧率估算的帧时长（流的 time_base）
+    bool m_ShowImmediately = false;             // 拖动进度条 seek 后的第一帧不等待主时钟
 };
 
 
@@ -15,7 +15,6 @@ AVFrameQueue::AVFrameQueue(int max_size, int keep_last) {
     rindex = 0;
     windex = 0;
     size = 0;
-    m_FlushRequest = false;
  }
 
 AVFrameQueue::~AVFrameQueue() {
@@ -45,6 +44,19 @@ Frame *AVFrameQueue::FrontFrame() {
     return &queue[rindex];
 }
 
+Frame *AVFrameQueue::PeekReadable() {
+    unique_lock<mutex> lock(m_Mutex);
+    while (size == 0 && !abort_request) {
+        m_CondVar.wait(lock);
+    }
+
+    if (abort_request) {
+        return nullptr;
+    }
+
+    return &queue[rindex];
+}
+
 Frame *AVFrameQueue::PeekWritable() {
     unique_lock<mutex> lock(m_Mutex);
     while (size >= max_size && !abort_request) {
@@ -81,12 +93,9 @@ void AVFrameQueue::PopFrame() {
 }
 
 void AVFrameQueue::Flush() {
-    m_FlushRequest = true;
-    unique_lock<mutex> lock(m_FlushMutex);
     while (GetFrameSize() > 0) {
         PopFrame();
     }
-    m_FlushRequest = false;
 }
 
 int AVFrameQueue::GetFrameSize() {
@@ -6,6 +6,8 @@
 #define LEARNFFMPEG_AVFRAMEQUEUE_H
 
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -18,12 +20,14 @@ using namespace std;
 typedef struct Frame {
     AVFrame *frame;
     AVSubtitle sub;
-    double pts;           /* presentation timestamp for the frame */
-    double duration;      /* estimated duration of the frame */
+    double pts;           /* presentation timestamp for the frame, us */
+    double duration;      /* estimated duration of the frame, us */
     int width;
     int height;
     int format;
     int uploaded;
+    int serial;           /* 解码该帧时数据包的序号，与数据包队列当前序号不一致说明是 seek 之前的帧 */
+    int immediate;        /* 不等待主时钟立即显示，拖动进度条 seek 后的第一帧 */
     void resetPts() {
         pts = -1;
     }
@@ -42,29 +46,25 @@ public:
 
     Frame *FrontFrame();
 
+    // 阻塞直到队列非空，队列终止时返回 nullptr
+    Frame *PeekReadable();
+
     Frame *PeekWritable();
 
     void PushFrame();
 
     void PopFrame();
 
+    // 丢弃所有帧，只能由消费者（或两端线程都已退出后）调用；seek 不调用，过期帧按 serial 惰性丢弃
     void Flush();
 
     int GetFrameSize();
 
-    mutex &GetQueueMutex() {
-        return m_FlushMutex;
-    }
-
-    bool FlushRequest() {
-        return m_FlushRequest;
-    }
 private:
     void UnRefFrame(Frame *vp);
 
 private:
     mutex m_Mutex;
-    mutex m_FlushMutex;
     condition_variable m_CondVar;
     int abort_request;
     Frame queue[FRAME_QUEUE_MAX_SIZE];
@@ -72,7 +72,6 @@ private:
     int windex;
     int size;
     int max_size;
-    bool m_FlushRequest;
 };
 
 
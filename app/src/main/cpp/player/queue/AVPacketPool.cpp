@@ -0,0 +1,69 @@
+#include <string.h>
+#include "AVPacketPool.h"
+
+//各级缓冲区大小，覆盖音频小包到高码率视频关键帧；
+//缓冲区按分级大小计入队列上限，大包分级过粗会让关键帧占用远超负载的内存
+static const int PACKET_POOL_SIZE_CLASSES[PACKET_POOL_SIZE_CLASS_COUNT] = {
+        1 * 1024,
+        2 * 1024,
+        4 * 1024,
+        8 * 1024,
+        16 * 1024,
+        32 * 1024,
+        64 * 1024,
+        128 * 1024,
+        184 * 1024,
+        256 * 1024,
+        364 * 1024,
+        512 * 1024,
+        724 * 1024,
+        1024 * 1024,
+        1448 * 1024,
+        2048 * 1024,
+        2896 * 1024,
+        4096 * 1024
+};
+
+AVPacketPool::AVPacketPool() {
+    for (int i = 0; i < PACKET_POOL_SIZE_CLASS_COUNT; ++i) {
+        m_Pools[i] = av_buffer_pool_init(PACKET_POOL_SIZE_CLASSES[i] + AV_INPUT_BUFFER_PADDING_SIZE, av_buffer_alloc);
+    }
+    m_PooledCount = 0;
+    m_PassThroughCount = 0;
+}
+
+AVPacketPool::~AVPacketPool() {
+    //仍被数据包或解码帧引用的缓冲区会在最后一个引用释放时随池一起释放
+    for (int i = 0; i < PACKET_POOL_SIZE_CLASS_COUNT; ++i) {
+        av_buffer_pool_uninit(&m_Pools[i]);
+    }
+}
+
+int AVPacketPool::Repack(AVPacket *pkt) {
+    if (pkt == nullptr || pkt->data == nullptr || pkt->size <= 0) {
+        return -1;
+    }
+
+    int sizeClass = 0;
+    while (sizeClass < PACKET_POOL_SIZE_CLASS_COUNT && pkt->size > PACKET_POOL_SIZE_CLASSES[sizeClass]) {
+        sizeClass++;
+    }
+
+    AVBufferRef *buf = nullptr;
+    if (sizeClass < PACKET_POOL_SIZE_CLASS_COUNT && m_Pools[sizeClass] != nullptr) {
+        buf = av_buffer_pool_get(m_Pools[sizeClass]);
+    }
+    if (buf == nullptr) {
+        m_PassThroughCount.fetch_add(1, memory_order_relaxed);
+        return -1;
+    }
+
+    memcpy(buf->data, pkt->data, pkt->size);
+    memset(buf->data + pkt->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    av_buffer_unref(&pkt->buf);
+    pkt->buf = buf;
+    pkt->data = buf->data;
+    m_PooledCount.fetch_add(1, memory_order_relaxed);
+    return 0;
+}
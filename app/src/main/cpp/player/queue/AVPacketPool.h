@@ -0,0 +1,45 @@
+#ifndef LEARNFFMPEG_AVPACKETPOOL_H
+#define LEARNFFMPEG_AVPACKETPOOL_H
+
+#include <atomic>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+};
+
+using namespace std;
+
+#define PACKET_POOL_SIZE_CLASS_COUNT 18
+
+/**
+ * 数据包负载内存池，按固定大小分级，每级一个 AVBufferPool。
+ * 解封装线程调用 Repack 把 av_read_frame 得到的负载拷贝到池中的缓冲区，原缓冲区在解封装线程立即释放；
+ * 池中缓冲区随 AVPacket 的引用在线程间移动，解码线程 unref 后回到池中复用，不再走 malloc/free。
+ * 128KB 以下按 2 倍分级，以上按 √2 分级，大包最多浪费约 40%；超过最大分级的数据包保持原样。
+ */
+class AVPacketPool {
+public:
+    AVPacketPool();
+
+    virtual ~AVPacketPool();
+
+    // 将 pkt 的负载换成池中的缓冲区，成功返回 0
+    int Repack(AVPacket *pkt);
+
+    int64_t GetPooledCount() {
+        return m_PooledCount.load(memory_order_relaxed);
+    }
+
+    int64_t GetPassThroughCount() {
+        return m_PassThroughCount.load(memory_order_relaxed);
+    }
+
+private:
+    AVBufferPool *m_Pools[PACKET_POOL_SIZE_CLASS_COUNT];
+    atomic<int64_t> m_PooledCount;
+    atomic<int64_t> m_PassThroughCount;
+};
+
+
+#endif //LEARNFFMPEG_AVPACKETPOOL_H
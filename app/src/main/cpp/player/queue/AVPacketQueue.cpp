@@ -5,62 +5,101 @@
 #include <LogUtil.h>
 #include "AVPacketQueue.h"
 
-AVPacketQueue::AVPacketQueue() {
+AVPacketQueue::AVPacketQueue(int capacity) {
+    m_Capacity = 1;
+    while (m_Capacity < (uint64_t) capacity) {
+        m_Capacity <<= 1;
+    }
+    m_Mask = m_Capacity - 1;
+    m_Slots = (AVPacketSlot *) av_mallocz(m_Capacity * sizeof(AVPacketSlot));
+    for (uint64_t i = 0; i < m_Capacity; ++i) {
+        av_init_packet(&m_Slots[i].pkt);
+        m_Slots[i].pkt.data = nullptr;
+        m_Slots[i].pkt.size = 0;
+    }
+
+    m_ConsumerWaiting = false;
+    m_ProducerWaiting = false;
+    m_Head = 0;
+    m_Tail = 0;
+    m_FlushIndex = 0;
+    m_Serial = 0;
+    m_PushedBytes = 0;
+    m_PoppedBytes = 0;
+    m_FlushedBytes = 0;
+    m_PushedDuration = 0;
+    m_PoppedDuration = 0;
+    m_FlushedDuration = 0;
     abort_request = 0;
-    first_pkt = nullptr;
-    last_pkt = nullptr;
-    nb_packets = 0;
-    size = 0;
-    duration = 0;
+    m_LowWaterNotify = false;
 }
 
 AVPacketQueue::~AVPacketQueue() {
     Abort();
-    Flush();
+    //生产者和消费者线程均已退出，直接释放所有槽位
+    if (m_Slots != nullptr) {
+        for (uint64_t i = 0; i < m_Capacity; ++i) {
+            av_packet_unref(&m_Slots[i].pkt);
+        }
+        av_freep(&m_Slots);
+    }
+}
+
+void AVPacketQueue::NotifyConsumer() {
+    //与消费者的 m_ConsumerWaiting.store + m_Tail.load 构成 Dekker 式同步，二者至少有一方看到对方的修改
+    if (m_ConsumerWaiting.load()) {
+        unique_lock<mutex> lock(m_Mutex);
+        m_ConsumerCond.notify_one();
+    }
+}
+
+void AVPacketQueue::NotifyProducer() {
+    if (m_ProducerWaiting.load()) {
+        unique_lock<mutex> lock(m_Mutex);
+        m_ProducerCond.notify_one();
+    }
 }
 
 /**
  * 入队数据包
  * @param pkt
- * @return
+ * @param block
+ * @return 1 成功，0 队列已满（非阻塞），-1 队列已终止
  */
-int AVPacketQueue::Put(AVPacket *pkt) {
-    AVPacketNode *pkt1;
+int AVPacketQueue::PushPacket(AVPacket *pkt, int block) {
+    for (;;) {
+        if (abort_request) {
+            return -1;
+        }
 
-    if (abort_request) {
-        return -1;
-    }
+        uint64_t tail = m_Tail.load(memory_order_relaxed);
+        if (tail - m_Head.load(memory_order_acquire) < m_Capacity) {
+            AVPacketSlot *slot = &m_Slots[tail & m_Mask];
+            //按实际占用的缓冲区大小计入队列上限，池化后的缓冲区可能明显大于负载
+            slot->size = (pkt->buf != nullptr ? pkt->buf->size : pkt->size) + sizeof(AVPacket);
+            slot->duration = pkt->duration;
+            slot->serial = m_Serial.load(memory_order_relaxed);
+            av_packet_move_ref(&slot->pkt, pkt);
+            m_PushedBytes.fetch_add(slot->size, memory_order_relaxed);
+            m_PushedDuration.fetch_add(slot->duration, memory_order_relaxed);
+            m_Tail.store(tail + 1);
+            NotifyConsumer();
+            return 1;
+        }
 
-    pkt1 = (AVPacketNode *) av_malloc(sizeof(AVPacketNode));
-    if (!pkt1) {
-        return -1;
-    }
-    pkt1->pkt = *pkt;
-    pkt1->next = nullptr;
+        if (!block) {
+            return 0;
+        }
 
-    if (!last_pkt) {
-        first_pkt = pkt1;
-    } else {
-        last_pkt->next = pkt1;
+        WaitWritable(-1);
     }
-    last_pkt = pkt1;
-    nb_packets++;
-    size += pkt1->pkt.size + sizeof(*pkt1);
-    duration += pkt1->pkt.duration;
-    return 0;
 }
 
 int AVPacketQueue::PushPacket(AVPacket *pkt) {
-    int ret;
-    unique_lock<mutex> lock(m_Mutex);
-    ret = Put(pkt);
-    m_CondVar.notify_all();
-    lock.unlock();
-
+    int ret = PushPacket(pkt, 1);
     if (ret < 0) {
         av_packet_unref(pkt);
     }
-
     return ret;
 }
 
@@ -74,22 +113,34 @@ int AVPacketQueue::PushNullPacket(int stream_index) {
 }
 
 /**
- * 刷新数据包
+ * 等待空闲槽位
+ * @param timeoutMs 小于 0 时一直等待
  */
-void AVPacketQueue::Flush() {
-    AVPacketNode *pkt, *pkt1;
+void AVPacketQueue::WaitWritable(int timeoutMs) {
     unique_lock<mutex> lock(m_Mutex);
-    for (pkt = first_pkt; pkt; pkt = pkt1) {
-        pkt1 = pkt->next;
-        av_packet_unref(&pkt->pkt);
-        av_freep(&pkt);
+    m_ProducerWaiting.store(true);
+    if (!abort_request && m_Tail.load() - m_Head.load() >= m_Capacity) {
+        if (timeoutMs < 0) {
+            m_ProducerCond.wait(lock);
+        } else {
+            m_ProducerCond.wait_for(lock, std::chrono::milliseconds(timeoutMs));
+        }
     }
-    last_pkt = nullptr;
-    first_pkt = nullptr;
-    nb_packets = 0;
-    size = 0;
-    duration = 0;
-    m_CondVar.notify_all();
+    m_ProducerWaiting.store(false);
+}
+
+/**
+ * 刷新数据包，只能在生产者线程调用
+ */
+void AVPacketQueue::Flush() {
+    uint64_t tail = m_Tail.load(memory_order_relaxed);
+    m_FlushedBytes.store(m_PushedBytes.load(memory_order_relaxed), memory_order_relaxed);
+    m_FlushedDuration.store(m_PushedDuration.load(memory_order_relaxed), memory_order_relaxed);
+    //先递增序号再发布 m_FlushIndex，消费者看到新下标时一定也能看到新序号
+    m_Serial.fetch_add(1);
+    m_FlushIndex.store(tail);
+    //唤醒消费者尽快丢弃过期数据包，腾出槽位
+    NotifyConsumer();
 }
 
 /**
@@ -98,7 +149,8 @@ void AVPacketQueue::Flush() {
 void AVPacketQueue::Abort() {
     unique_lock<mutex> lock(m_Mutex);
     abort_request = 1;
-    m_CondVar.notify_all();
+    m_ConsumerCond.notify_all();
+    m_ProducerCond.notify_all();
 }
 
 /**
@@ -107,7 +159,8 @@ void AVPacketQueue::Abort() {
 void AVPacketQueue::Start() {
     unique_lock<mutex> lock(m_Mutex);
     abort_request = 0;
-    m_CondVar.notify_all();
+    m_ConsumerCond.notify_all();
+    m_ProducerCond.notify_all();
 }
 
 /**
@@ -123,59 +176,115 @@ int AVPacketQueue::GetPacket(AVPacket *pkt) {
  * 取出数据包
  * @param pkt
  * @param block
+ * @param serial 数据包入队时的序号，可为空
  * @return
  */
-int AVPacketQueue::GetPacket(AVPacket *pkt, int block) {
-    LOGCATE("AVPacketQueue::GetPacket begin");
-    AVPacketNode *pkt1;
+int AVPacketQueue::GetPacket(AVPacket *pkt, int block, int *serial) {
     int ret;
-    unique_lock<mutex> lock(m_Mutex);
     for (;;) {
         if (abort_request) {
             ret = -1;
             break;
         }
 
-        pkt1 = first_pkt;
-        if (pkt1) {
-            first_pkt = pkt1->next;
-            if (!first_pkt) {
-                last_pkt = nullptr;
+        uint64_t head = m_Head.load(memory_order_relaxed);
+        if (head != m_Tail.load(memory_order_acquire)) {
+            AVPacketSlot *slot = &m_Slots[head & m_Mask];
+            bool flushed = head < m_FlushIndex.load(memory_order_acquire);
+            if (flushed) {
+                av_packet_unref(&slot->pkt);
+            } else {
+                av_packet_move_ref(pkt, &slot->pkt);
+                if (serial != nullptr) *serial = slot->serial;
+            }
+            m_PoppedBytes.fetch_add(slot->size, memory_order_relaxed);
+            m_PoppedDuration.fetch_add(slot->duration, memory_order_relaxed);
+            m_Head.store(head + 1);
+            NotifyProducer();
+            if (m_LowWaterNotify.load() && IsBelowLowWater() && m_LowWaterNotify.exchange(false)) {
+                if (m_LowWaterCallback != nullptr) {
+                    m_LowWaterCallback(m_LowWaterContext);
+                }
+            }
+            if (flushed) {
+                continue;
             }
-            nb_packets--;
-            size -= pkt1->pkt.size + sizeof(*pkt1);
-            duration -= pkt1->pkt.duration;
-            *pkt = pkt1->pkt;
-            av_free(pkt1);
             ret = 1;
             break;
         } else if (!block) {
             ret = 0;
             break;
         } else {
-            m_CondVar.wait(lock);
+            unique_lock<mutex> lock(m_Mutex);
+            m_ConsumerWaiting.store(true);
+            if (!abort_request && m_Tail.load() == head) {
+                m_ConsumerCond.wait(lock);
+            }
+            m_ConsumerWaiting.store(false);
         }
     }
-    LOGCATE("AVPacketQueue::GetPacket end");
     return ret;
 }
 
 int AVPacketQueue::GetPacketSize() {
-    unique_lock<mutex> lock(m_Mutex);
-    return nb_packets;
+    uint64_t head = m_Head.load();
+    uint64_t flushIndex = m_FlushIndex.load();
+    uint64_t tail = m_Tail.load();
+    head = head > flushIndex ? head : flushIndex;
+    return tail > head ? (int) (tail - head) : 0;
 }
 
 int AVPacketQueue::GetSize() {
-    unique_lock<mutex> lock(m_Mutex);
-    return size;
+    int64_t popped = m_PoppedBytes.load();
+    int64_t flushed = m_FlushedBytes.load();
+    int64_t size = m_PushedBytes.load() - (popped > flushed ? popped : flushed);
+    return size > 0 ? (int) size : 0;
 }
 
 int64_t AVPacketQueue::GetDuration() {
-    unique_lock<mutex> lock(m_Mutex);
-    return duration;
+    int64_t popped = m_PoppedDuration.load();
+    int64_t flushed = m_FlushedDuration.load();
+    int64_t duration = m_PushedDuration.load() - (popped > flushed ? popped : flushed);
+    return duration > 0 ? duration : 0;
 }
 
 int AVPacketQueue::IsAbort() {
-    unique_lock<mutex> lock(m_Mutex);
     return abort_request;
-}
\ No newline at end of file
+}
+
+void AVPacketQueue::SetLimit(int64_t maxBytes, int64_t maxDuration, int lowWaterPercent) {
+    if (lowWaterPercent < 0) lowWaterPercent = 0;
+    if (lowWaterPercent > 100) lowWaterPercent = 100;
+    m_MaxBytes = maxBytes > 0 ? maxBytes : 0;
+    m_MaxDuration = maxDuration > 0 ? maxDuration : 0;
+    m_LowWaterBytes = m_MaxBytes * lowWaterPercent / 100;
+    m_LowWaterDuration = m_MaxDuration * lowWaterPercent / 100;
+}
+
+int AVPacketQueue::IsFull() {
+    if (m_MaxBytes > 0 && GetSize() >= m_MaxBytes) {
+        return 1;
+    }
+    if (m_MaxDuration > 0 && GetDuration() >= m_MaxDuration) {
+        return 1;
+    }
+    return 0;
+}
+
+int AVPacketQueue::IsBelowLowWater() {
+    if (m_MaxBytes == 0 && m_MaxDuration == 0) {
+        //未设置上限时以队列为空作为低水位
+        return GetPacketSize() == 0;
+    }
+    if (m_MaxBytes > 0 && GetSize() > m_LowWaterBytes) {
+        return 0;
+    }
+    if (m_MaxDuration > 0 && GetDuration() > m_LowWaterDuration) {
+        return 0;
+    }
+    return 1;
+}
+
+void AVPacketQueue::RequestLowWaterNotify() {
+    m_LowWaterNotify.store(true);
+}
@@ -6,6 +6,9 @@
 #define LEARNFFMPEG_AVPACKETQUEUE_H
 
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -13,23 +16,44 @@ extern "C" {
 
 using namespace std;
 
-typedef struct AVPacketNode {
-    AVPacket pkt;
-    struct AVPacketNode *next;
-} AVPacketNode;
+//默认槽位数，需为 2 的幂
+#define PACKET_QUEUE_CAPACITY 1024
+
+//消费者出队后队列降到低水位以下时回调，在消费者线程中执行
+typedef void (*PacketQueueCallback)(void *context);
 
+typedef struct AVPacketSlot {
+    AVPacket pkt;
+    int size;           // 入队时记录，仅生产者写
+    int64_t duration;   // 入队时记录，仅生产者写
+    int serial;         // 入队时的队列序号，仅生产者写
+} AVPacketSlot;
+
+/**
+ * 单生产者（解封装线程）单消费者（解码线程）的有界环形队列，槽位预先分配。
+ * 入队出队只修改各自的原子下标，不加锁、不分配内存；
+ * 只有队列空时消费者、队列满时生产者才会阻塞，对端仅在有线程等待时才加锁唤醒。
+ * Flush 只能由生产者调用：记录当前写下标，已入队的数据包由消费者在出队时惰性丢弃；
+ * 同时递增队列序号，之后入队的数据包带新序号，消费者据此判断解码器是否需要刷新。
+ */
 class AVPacketQueue {
 public:
-    AVPacketQueue();
+    AVPacketQueue(int capacity = PACKET_QUEUE_CAPACITY);
 
     virtual ~AVPacketQueue();
 
-    // 入队数据包
+    // 入队数据包，队列满时阻塞，成功后 pkt 的引用转移到队列
     int PushPacket(AVPacket *pkt);
 
+    // 入队数据包，block 为 0 时队列满直接返回 0，pkt 保持不变
+    int PushPacket(AVPacket *pkt, int block);
+
     // 入队空数据包
     int PushNullPacket(int stream_index);
 
+    // 等待队列有空闲槽位，最多等待 timeoutMs
+    void WaitWritable(int timeoutMs);
+
     // 刷新
     void Flush();
 
@@ -42,8 +66,13 @@ public:
     // 获取数据包
     int GetPacket(AVPacket *pkt);
 
-    // 获取数据包
-    int GetPacket(AVPacket *pkt, int block);
+    // 获取数据包，serial 不为空时返回数据包入队时的序号
+    int GetPacket(AVPacket *pkt, int block, int *serial = nullptr);
+
+    // 当前序号，每次 Flush 加 1
+    int GetSerial() {
+        return m_Serial.load(memory_order_acquire);
+    }
 
     int GetPacketSize();
 
@@ -53,17 +82,62 @@ public:
 
     int IsAbort();
 
+    // 设置字节数和时长（以流的 time_base 为单位）上限，0 表示不限制；低水位为上限的百分比
+    void SetLimit(int64_t maxBytes, int64_t maxDuration, int lowWaterPercent);
+
+    // 是否超过字节数或时长上限
+    int IsFull();
+
+    // 字节数和时长是否都低于低水位，未设置上限时队列为空即为低水位
+    int IsBelowLowWater();
+
+    // 生产者准备等待前调用，消费者下一次降到低水位以下时触发一次回调
+    void RequestLowWaterNotify();
+
+    void SetLowWaterCallback(void *context, PacketQueueCallback callback) {
+        m_LowWaterContext = context;
+        m_LowWaterCallback = callback;
+    }
+
 private:
-    int Put(AVPacket *pkt);
+    void NotifyConsumer();
+
+    void NotifyProducer();
 
 private:
     mutex m_Mutex;
-    condition_variable m_CondVar;
-    AVPacketNode *first_pkt, *last_pkt;
-    int nb_packets;
-    int size;
-    int64_t duration;
-    volatile int abort_request;
+    condition_variable m_ConsumerCond;
+    condition_variable m_ProducerCond;
+    atomic<bool> m_ConsumerWaiting;
+    atomic<bool> m_ProducerWaiting;
+
+    AVPacketSlot *m_Slots = nullptr;
+    uint64_t m_Capacity = 0;
+    uint64_t m_Mask = 0;
+
+    atomic<uint64_t> m_Head;            // 读下标，仅消费者写
+    atomic<uint64_t> m_Tail;            // 写下标，仅生产者写
+    atomic<uint64_t> m_FlushIndex;      // 小于该下标的数据包已被 Flush，仅生产者写
+    atomic<int> m_Serial;               // 仅生产者写
+
+    //累计值，size/duration 由差值得出，避免生产者和消费者修改同一个变量
+    atomic<int64_t> m_PushedBytes;
+    atomic<int64_t> m_PoppedBytes;
+    atomic<int64_t> m_FlushedBytes;
+    atomic<int64_t> m_PushedDuration;
+    atomic<int64_t> m_PoppedDuration;
+    atomic<int64_t> m_FlushedDuration;
+
+    atomic<int> abort_request;
+
+    //背压控制
+    int64_t m_MaxBytes = 0;
+    int64_t m_MaxDuration = 0;
+    int64_t m_LowWaterBytes = 0;
+    int64_t m_LowWaterDuration = 0;
+    atomic<bool> m_LowWaterNotify;
+    void *m_LowWaterContext = nullptr;
+    PacketQueueCallback m_LowWaterCallback = nullptr;
 };
 
 
@@ -111,7 +111,7 @@ void AudioGLRender::OnSurfaceChanged(int w, int h) {
 }
 
 void AudioGLRender::OnDrawFrame() {
-    ByteFlowPrintD("AudioGLRender::OnDrawFrame");
+    LOGCATT("AudioGLRender::OnDrawFrame");
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
     std::unique_lock<std::mutex> lock(m_Mutex);
     if (m_ProgramObj == GL_NONE || m_pAudioBuffer == nullptr) return;
@@ -169,7 +169,7 @@ void AudioGLRender::OnDrawFrame() {
 
 void AudioGLRender::UpdateAudioFrame(AudioFrame *audioFrame) {
     if(audioFrame != nullptr) {
-        ByteFlowPrintD("AudioGLRender::UpdateAudioFrame audioFrame->dataSize=%d", audioFrame->dataSize);
+        LOGCATT("AudioGLRender::UpdateAudioFrame audioFrame->dataSize=%d", audioFrame->dataSize);
         std::unique_lock<std::mutex> lock(m_Mutex);
         if(m_pAudioBuffer != nullptr && m_pAudioBuffer->dataSize != audioFrame->dataSize) {
             delete m_pAudioBuffer;
@@ -5,6 +5,10 @@
 #ifndef LEARNFFMPEG_AUDIORENDER_H
 #define LEARNFFMPEG_AUDIORENDER_H
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
 class AudioFrame {
 public:
     AudioFrame(uint8_t * data, int dataSize, bool hardCopy = true) {
@@ -37,6 +41,14 @@ public:
     virtual void ClearAudioCache() = 0;
     virtual void RenderAudioFrame(uint8_t *pData, int dataSize) = 0;
     virtual void UnInit() = 0;
+    //已提交但尚未播放的数据量（字节），用于修正音频时钟
+    virtual int GetBufferedBytes() {
+        return 0;
+    }
+    //播放设备取数据时缓冲已空（欠载）的累计次数
+    virtual int64_t GetUnderrunCount() {
+        return 0;
+    }
 
 };
 
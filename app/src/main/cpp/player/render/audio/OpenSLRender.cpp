@@ -44,7 +44,7 @@ void OpenSLRender::Init() {
 }
 
 void OpenSLRender::RenderAudioFrame(uint8_t *pData, int dataSize) {
-    LOGCATE("OpenSLRender::RenderAudioFrame pData=%p, dataSize=%d", pData, dataSize);
+    LOGCATT("OpenSLRender::RenderAudioFrame pData=%p, dataSize=%d", pData, dataSize);
     if(m_AudioPlayerPlay) {
         if (pData != nullptr && dataSize > 0) {
 
@@ -57,6 +57,7 @@ void OpenSLRender::RenderAudioFrame(uint8_t *pData, int dataSize) {
             std::unique_lock<std::mutex> lock(m_Mutex);
             AudioFrame *audioFrame = new AudioFrame(pData, dataSize);
             m_AudioFrameQueue.push(audioFrame);
+            m_QueuedBytes += dataSize;
             m_Cond.notify_all();
             lock.unlock();
         }
@@ -95,11 +96,16 @@ void OpenSLRender::UnInit() {
     }
 
     lock.lock();
-    for (int i = 0; i < m_AudioFrameQueue.size(); ++i) {
+    while (!m_AudioFrameQueue.empty()) {
         AudioFrame *audioFrame = m_AudioFrameQueue.front();
         m_AudioFrameQueue.pop();
         delete audioFrame;
     }
+    m_QueuedBytes = 0;
+    if (m_PlayingFrame != nullptr) {
+        delete m_PlayingFrame;
+        m_PlayingFrame = nullptr;
+    }
     lock.unlock();
 
     if(m_thread != nullptr)
@@ -250,9 +256,14 @@ void OpenSLRender::StartRender() {
 }
 
 void OpenSLRender::HandleAudioFrameQueue() {
-    LOGCATE("OpenSLRender::HandleAudioFrameQueue QueueSize=%lu", m_AudioFrameQueue.size());
+    LOGCATT("OpenSLRender::HandleAudioFrameQueue QueueSize=%lu", m_AudioFrameQueue.size());
     if (m_AudioPlayerPlay == nullptr) return;
 
+    //上一帧已播放完而队列为空，设备即将断流
+    if (GetAudioFrameQueueSize() == 0 && !m_Exit) {
+        m_UnderrunCount++;
+    }
+
     while (GetAudioFrameQueueSize() < MAX_QUEUE_BUFFER_SIZE && !m_Exit) {
         std::unique_lock<std::mutex> lock(m_Mutex);
         m_Cond.wait_for(lock, std::chrono::milliseconds(10));
@@ -265,7 +276,12 @@ void OpenSLRender::HandleAudioFrameQueue() {
         if (result == SL_RESULT_SUCCESS) {
             AudioGLRender::GetInstance()->UpdateAudioFrame(audioFrame);
             m_AudioFrameQueue.pop();
-            delete audioFrame;
+            m_QueuedBytes -= audioFrame->dataSize;
+            //OpenSL 不拷贝数据，上一帧此时已播放完成，可以释放；本帧留到下一次回调
+            if (m_PlayingFrame != nullptr) {
+                delete m_PlayingFrame;
+            }
+            m_PlayingFrame = audioFrame;
         }
 
     }
@@ -289,10 +305,25 @@ int OpenSLRender::GetAudioFrameQueueSize() {
 
 void OpenSLRender::ClearAudioCache() {
     std::unique_lock<std::mutex> lock(m_Mutex);
-    for (int i = 0; i < m_AudioFrameQueue.size(); ++i) {
+    while (!m_AudioFrameQueue.empty()) {
         AudioFrame *audioFrame = m_AudioFrameQueue.front();
         m_AudioFrameQueue.pop();
         delete audioFrame;
     }
+    m_QueuedBytes = 0;
+}
+
+//播放回调取数据时队列已空的累计次数
+int64_t OpenSLRender::GetUnderrunCount() {
+    return m_UnderrunCount.load();
+}
 
+/**
+ * 队列中的数据加上正在播放的一帧。正在播放的帧无法得知已播放的比例，按一半估算
+ * @return
+ */
+int OpenSLRender::GetBufferedBytes() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    int playingBytes = m_PlayingFrame != nullptr ? m_PlayingFrame->dataSize / 2 : 0;
+    return m_QueuedBytes + playingBytes;
 }
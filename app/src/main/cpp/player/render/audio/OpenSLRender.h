@@ -11,6 +11,7 @@
 #include <queue>
 #include <string>
 #include <thread>
+#include <atomic>
 #include "AudioRender.h"
 #include "AudioGLRender.h"
 
@@ -24,6 +25,8 @@ public:
     virtual void ClearAudioCache();
     virtual void RenderAudioFrame(uint8_t *pData, int dataSize);
     virtual void UnInit();
+    virtual int GetBufferedBytes();
+    virtual int64_t GetUnderrunCount();
 
 private:
     int CreateEngine();
@@ -44,6 +47,9 @@ private:
     SLAndroidSimpleBufferQueueItf m_BufferQueue;
 
     std::queue<AudioFrame *> m_AudioFrameQueue;
+    int m_QueuedBytes = 0;                      // m_AudioFrameQueue 中的数据量
+    std::atomic<int64_t> m_UnderrunCount{0};     // 回调时队列已空的次数
+    AudioFrame *m_PlayingFrame = nullptr;       // 已提交给 OpenSL 正在播放的帧，播放完成回调前不能释放
 
     std::thread *m_thread = nullptr;
     std::mutex   m_Mutex;
@@ -0,0 +1,137 @@
+#include <unistd.h>
+#include <LogUtil.h>
+#include "WavFileRender.h"
+
+#define WAV_HEADER_SIZE 44
+//虚拟设备缓冲上限，接近 OpenSL ES 队列的典型深度
+#define WAV_MAX_BUFFERED_US 100000
+
+static void WriteLE32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t) (value & 0xFF);
+    p[1] = (uint8_t) ((value >> 8) & 0xFF);
+    p[2] = (uint8_t) ((value >> 16) & 0xFF);
+    p[3] = (uint8_t) ((value >> 24) & 0xFF);
+}
+
+static void WriteLE16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t) (value & 0xFF);
+    p[1] = (uint8_t) ((value >> 8) & 0xFF);
+}
+
+WavFileRender::WavFileRender(const char *outPath, int sampleRate, int channels, int bitsPerSample, bool paced) {
+    if(outPath != nullptr) {
+        m_OutPath = strdup(outPath);
+    }
+    m_SampleRate = sampleRate;
+    m_Channels = channels;
+    m_BitsPerSample = bitsPerSample;
+    m_Paced = paced;
+}
+
+WavFileRender::~WavFileRender() {
+    UnInit();
+    if(m_OutPath != nullptr) {
+        free(m_OutPath);
+        m_OutPath = nullptr;
+    }
+}
+
+void WavFileRender::Init() {
+    LOGCATE("WavFileRender::Init outPath=%s, [sampleRate, channels, bits]=[%d, %d, %d]",
+            m_OutPath ? m_OutPath : "null", m_SampleRate, m_Channels, m_BitsPerSample);
+    m_DataSize = 0;
+    {
+        unique_lock<mutex> lock(m_PaceMutex);
+        m_PaceStartUs = 0;
+        m_PaceBytes = 0;
+    }
+    if(m_OutPath == nullptr || m_OutFile != nullptr) return;
+
+    m_OutFile = fopen(m_OutPath, "wb");
+    if(m_OutFile == nullptr) {
+        LOGCATE("WavFileRender::Init fail to open %s", m_OutPath);
+        return;
+    }
+    //先写入占位的文件头，UnInit 时回填数据长度
+    WriteHeader();
+}
+
+void WavFileRender::ClearAudioCache() {
+    //数据直接落盘，只需丢弃虚拟设备中尚未播放的部分
+    unique_lock<mutex> lock(m_PaceMutex);
+    m_PaceStartUs = 0;
+    m_PaceBytes = 0;
+}
+
+void WavFileRender::RenderAudioFrame(uint8_t *pData, int dataSize) {
+    if(pData == nullptr || dataSize <= 0) return;
+    m_DataSize += dataSize;
+    if(m_OutFile != nullptr) {
+        fwrite(pData, static_cast<size_t>(dataSize), 1, m_OutFile);
+    }
+
+    if(!m_Paced) return;
+    int64_t sleepUs = 0;
+    {
+        unique_lock<mutex> lock(m_PaceMutex);
+        int64_t now = GetSysCurrentTimeUs();
+        //首帧、暂停恢复或写入跟不上时虚拟设备已空，从当前时刻重新计时
+        if(m_PaceStartUs == 0 || GetAheadUs(now) < 0) {
+            m_PaceStartUs = now;
+            m_PaceBytes = 0;
+        }
+        m_PaceBytes += dataSize;
+        sleepUs = GetAheadUs(now) - WAV_MAX_BUFFERED_US;
+    }
+    if(sleepUs > 0) {
+        usleep(static_cast<useconds_t>(sleepUs));
+    }
+}
+
+int WavFileRender::GetBufferedBytes() {
+    if(!m_Paced) return 0;
+    unique_lock<mutex> lock(m_PaceMutex);
+    int64_t aheadUs = GetAheadUs(GetSysCurrentTimeUs());
+    if(aheadUs <= 0) return 0;
+    int64_t bytesPerSecond = (int64_t) m_SampleRate * m_Channels * m_BitsPerSample / 8;
+    return (int) (aheadUs * bytesPerSecond / 1000000);
+}
+
+int64_t WavFileRender::GetAheadUs(int64_t now) {
+    if(m_PaceStartUs == 0) return 0;
+    int64_t bytesPerSecond = (int64_t) m_SampleRate * m_Channels * m_BitsPerSample / 8;
+    if(bytesPerSecond <= 0) return 0;
+    return m_PaceBytes * 1000000 / bytesPerSecond - (now - m_PaceStartUs);
+}
+
+void WavFileRender::UnInit() {
+    if(m_OutFile != nullptr) {
+        fseek(m_OutFile, 0, SEEK_SET);
+        WriteHeader();
+        fclose(m_OutFile);
+        m_OutFile = nullptr;
+        LOGCATE("WavFileRender::UnInit %lld bytes written to %s", (long long) m_DataSize, m_OutPath);
+    }
+}
+
+void WavFileRender::WriteHeader() {
+    uint8_t header[WAV_HEADER_SIZE] = {0};
+    int blockAlign = m_Channels * m_BitsPerSample / 8;
+    uint32_t dataSize = m_DataSize > UINT32_MAX - WAV_HEADER_SIZE ? UINT32_MAX - WAV_HEADER_SIZE : (uint32_t) m_DataSize;
+
+    memcpy(header, "RIFF", 4);
+    WriteLE32(header + 4, dataSize + WAV_HEADER_SIZE - 8);
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    WriteLE32(header + 16, 16);                          // fmt chunk size
+    WriteLE16(header + 20, 1);                           // PCM
+    WriteLE16(header + 22, (uint16_t) m_Channels);
+    WriteLE32(header + 24, (uint32_t) m_SampleRate);
+    WriteLE32(header + 28, (uint32_t) (m_SampleRate * blockAlign)); // byte rate
+    WriteLE16(header + 32, (uint16_t) blockAlign);
+    WriteLE16(header + 34, (uint16_t) m_BitsPerSample);
+    memcpy(header + 36, "data", 4);
+    WriteLE32(header + 40, dataSize);
+
+    fwrite(header, sizeof(header), 1, m_OutFile);
+}
@@ -0,0 +1,48 @@
+#ifndef LEARNFFMPEG_WAVFILERENDER_H
+#define LEARNFFMPEG_WAVFILERENDER_H
+
+#include <stdio.h>
+#include <mutex>
+#include "AudioRender.h"
+
+using namespace std;
+
+//将重采样后的 PCM 数据写入 WAV 文件，用于桌面 Linux 上的无声卡播放链路
+//outPath 为空时丢弃音频数据（空渲染器）
+//paced 为 true 时模拟一个按实时速率消费数据的播放设备：超前墙上时钟
+//WAV_MAX_BUFFERED_US 以上时阻塞写入，并通过 GetBufferedBytes 报告设备中尚未"播放"的数据量，
+//使以音频为主时钟的同步和真实声卡一致；free-run 基准测试传 false 不做节流
+class WavFileRender : public AudioRender {
+public:
+    WavFileRender(const char *outPath, int sampleRate, int channels, int bitsPerSample, bool paced = true);
+    virtual ~WavFileRender();
+    virtual void Init();
+    virtual void ClearAudioCache();
+    virtual void RenderAudioFrame(uint8_t *pData, int dataSize);
+    virtual void UnInit();
+    virtual int GetBufferedBytes();
+
+    int64_t GetDataSize() {
+        return m_DataSize;
+    }
+
+private:
+    void WriteHeader();
+    //虚拟设备中已写入但尚未按实时速率"播放"完的时长，调用方持有 m_PaceMutex
+    int64_t GetAheadUs(int64_t now);
+
+    char *m_OutPath = nullptr;
+    FILE *m_OutFile = nullptr;
+    int m_SampleRate;
+    int m_Channels;
+    int m_BitsPerSample;
+    int64_t m_DataSize = 0;
+
+    bool m_Paced;
+    mutex m_PaceMutex;
+    int64_t m_PaceStartUs = 0;   // 虚拟设备开始消费的时刻，0 表示空闲
+    int64_t m_PaceBytes = 0;     // 自 m_PaceStartUs 起写入的字节数
+};
+
+
+#endif //LEARNFFMPEG_WAVFILERENDER_H
@@ -0,0 +1,77 @@
+#include "HeadlessRender.h"
+
+HeadlessRender::HeadlessRender(const char *outPath) : VideoRender(VIDEO_RENDER_HEADLESS) {
+    if(outPath != nullptr) {
+        m_OutPath = strdup(outPath);
+    }
+}
+
+HeadlessRender::~HeadlessRender() {
+    UnInit();
+    if(m_OutPath != nullptr) {
+        free(m_OutPath);
+        m_OutPath = nullptr;
+    }
+}
+
+void HeadlessRender::Init(int videoWidth, int videoHeight, int *dstSize) {
+    LOGCATE("HeadlessRender::Init video[w,h]=[%d, %d], outPath=%s", videoWidth, videoHeight, m_OutPath ? m_OutPath : "null");
+    dstSize[0] = videoWidth;
+    dstSize[1] = videoHeight;
+    m_FrameCount = 0;
+    m_VideoWidth = videoWidth;
+    m_VideoHeight = videoHeight;
+
+    if(m_OutPath != nullptr && m_OutFile == nullptr) {
+        m_OutFile = fopen(m_OutPath, "wb");
+        if(m_OutFile == nullptr) {
+            LOGCATE("HeadlessRender::Init fail to open %s", m_OutPath);
+        }
+    }
+}
+
+void HeadlessRender::RenderVideoFrame(NativeImage *pImage) {
+    if(pImage == nullptr || pImage->ppPlane[0] == nullptr) return;
+    m_FrameCount++;
+
+    if(m_OutFile == nullptr) return;
+
+    switch (pImage->format)
+    {
+        case IMAGE_FORMAT_I420:
+            WritePlane(pImage->ppPlane[0], pImage->pLineSize[0], pImage->width, pImage->height);
+            WritePlane(pImage->ppPlane[1], pImage->pLineSize[1], pImage->width / 2, pImage->height / 2);
+            WritePlane(pImage->ppPlane[2], pImage->pLineSize[2], pImage->width / 2, pImage->height / 2);
+            break;
+        case IMAGE_FORMAT_NV12:
+        case IMAGE_FORMAT_NV21:
+            WritePlane(pImage->ppPlane[0], pImage->pLineSize[0], pImage->width, pImage->height);
+            WritePlane(pImage->ppPlane[1], pImage->pLineSize[1], pImage->width, pImage->height / 2);
+            break;
+        case IMAGE_FORMAT_RGBA:
+            WritePlane(pImage->ppPlane[0], pImage->pLineSize[0], pImage->width * 4, pImage->height);
+            break;
+        default:
+            LOGCAT_RATE_LIMIT(LOGCATE, 1000, "HeadlessRender::RenderVideoFrame do not support the format. Format = %d", pImage->format);
+            break;
+    }
+}
+
+void HeadlessRender::UnInit() {
+    if(m_OutFile != nullptr) {
+        fclose(m_OutFile);
+        m_OutFile = nullptr;
+        LOGCATE("HeadlessRender::UnInit %ld frames written to %s", m_FrameCount, m_OutPath);
+    }
+}
+
+void HeadlessRender::WritePlane(uint8_t *pPlane, int lineSize, int width, int height) {
+    //lineSize 为 0 表示数据紧密排列
+    if(lineSize == 0 || lineSize == width) {
+        fwrite(pPlane, static_cast<size_t>(width * height), 1, m_OutFile);
+        return;
+    }
+    for (int i = 0; i < height; ++i) {
+        fwrite(pPlane + i * lineSize, static_cast<size_t>(width), 1, m_OutFile);
+    }
+}
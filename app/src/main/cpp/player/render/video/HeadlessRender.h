@@ -0,0 +1,40 @@
+#ifndef LEARNFFMPEG_HEADLESSRENDER_H
+#define LEARNFFMPEG_HEADLESSRENDER_H
+
+#include <stdio.h>
+#include "VideoRender.h"
+
+//无窗口的视频渲染器，用于在桌面 Linux 上跑通播放链路（perf/valgrind 分析、吞吐回归）
+//outPath 为空时丢弃视频帧，否则将每一帧按原始格式（I420/NV12/NV21/RGBA）紧密排列写入文件
+class HeadlessRender : public VideoRender {
+public:
+    HeadlessRender(const char *outPath = nullptr);
+    virtual ~HeadlessRender();
+    virtual void Init(int videoWidth, int videoHeight, int *dstSize);
+    virtual void RenderVideoFrame(NativeImage *pImage);
+    virtual void UnInit();
+
+    long GetFrameCount() {
+        return m_FrameCount;
+    }
+
+    int GetVideoWidth() {
+        return m_VideoWidth;
+    }
+
+    int GetVideoHeight() {
+        return m_VideoHeight;
+    }
+
+private:
+    void WritePlane(uint8_t *pPlane, int lineSize, int width, int height);
+
+    char *m_OutPath = nullptr;
+    FILE *m_OutFile = nullptr;
+    volatile long m_FrameCount = 0;
+    int m_VideoWidth = 0;
+    int m_VideoHeight = 0;
+};
+
+
+#endif //LEARNFFMPEG_HEADLESSRENDER_H
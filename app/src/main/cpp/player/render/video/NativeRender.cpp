@@ -71,20 +71,27 @@ void NativeRender::Init(int videoWidth, int videoHeight, int *dstSize)
 void NativeRender::RenderVideoFrame(NativeImage *pImage)
 {
     if(m_NativeWindow == nullptr || pImage == nullptr) return;
-    ANativeWindow_lock(m_NativeWindow, &m_NativeWindowBuffer, nullptr);
+    if(ANativeWindow_lock(m_NativeWindow, &m_NativeWindowBuffer, nullptr) != 0) return;
     uint8_t *dstBuffer = static_cast<uint8_t *>(m_NativeWindowBuffer.bits);
-
-    int srcLineSize = pImage->width * 4;//RGBA
     int dstLineSize = m_NativeWindowBuffer.stride * 4;
+    int dstWidth = m_DstWidth < m_NativeWindowBuffer.width ? m_DstWidth : m_NativeWindowBuffer.width;
+    int dstHeight = m_DstHeight < m_NativeWindowBuffer.height ? m_DstHeight : m_NativeWindowBuffer.height;
 
-    for (int i = 0; i < m_DstHeight; ++i) {
-        memcpy(dstBuffer + i * dstLineSize, pImage->ppPlane[0] + i * srcLineSize, srcLineSize);
+    //YUV 帧在这里完成颜色转换和缩放，直接写入窗口缓冲，不再经过中间 RGBA 帧
+    if(pImage->format == IMAGE_FORMAT_RGBA && pImage->pLineSize[0] == 0) {
+        pImage->pLineSize[0] = pImage->width * 4;
     }
+    m_YuvConverter.ConvertToRgba(pImage, dstBuffer, dstLineSize, dstWidth, dstHeight);
 
     ANativeWindow_unlockAndPost(m_NativeWindow);
 
 }
 
+void NativeRender::SetColorSpace(int colorSpace, int colorRange)
+{
+    m_YuvConverter.SetColorSpace(colorSpace, colorRange);
+}
+
 void NativeRender::UnInit()
 {
 
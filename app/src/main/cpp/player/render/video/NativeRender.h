@@ -11,6 +11,7 @@
 #include "thread"
 
 #include "VideoRender.h"
+#include "YuvConverter.h"
 
 class NativeRender : public VideoRender{
 public:
@@ -19,6 +20,7 @@ public:
     virtual void Init(int videoWidth, int videoHeight, int *dstSize);
     virtual void RenderVideoFrame(NativeImage *pImage);
     virtual void UnInit();
+    virtual void SetColorSpace(int colorSpace, int colorRange);
 
     static NativeRender *GetInstance(JNIEnv *env, jobject surface);
     static void ReleaseInstance();
@@ -31,6 +33,7 @@ private:
     ANativeWindow *m_NativeWindow = nullptr;
     int m_DstWidth;
     int m_DstHeight;
+    YuvConverter m_YuvConverter;
 };
 
 
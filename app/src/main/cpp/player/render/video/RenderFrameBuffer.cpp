@@ -0,0 +1,65 @@
+#include "RenderFrameBuffer.h"
+
+RenderFrameBuffer::RenderFrameBuffer() {
+    for (int i = 0; i < RENDER_FRAME_SLOT_NUM; ++i) {
+        m_Slots[i].frame = av_frame_alloc();
+    }
+    m_WriteIndex = 0;
+    m_ReadIndex = 1;
+    m_ReadyIndex = 2;
+}
+
+RenderFrameBuffer::~RenderFrameBuffer() {
+    for (int i = 0; i < RENDER_FRAME_SLOT_NUM; ++i) {
+        NativeImageUtil::FreeNativeImage(&m_Slots[i].copyImage);
+        av_frame_free(&m_Slots[i].frame);
+    }
+}
+
+RenderFrame *RenderFrameBuffer::BeginWrite() {
+    RenderFrame *slot = &m_Slots[m_WriteIndex];
+    //写槽已经不在 GL 线程手中，上一轮持有的解码缓冲在这里归还
+    av_frame_unref(slot->frame);
+    return slot;
+}
+
+void RenderFrameBuffer::Publish() {
+    //release 保证槽中的数据对换入它的 GL 线程可见，同时拿回上一个就绪槽作为新的写槽
+    int prev = m_ReadyIndex.exchange(m_WriteIndex | RENDER_FRAME_READY_FLAG, memory_order_acq_rel);
+    m_WriteIndex = prev & RENDER_FRAME_SLOT_MASK;
+}
+
+void RenderFrameBuffer::PushFrameRef(NativeImage *pImage, AVFrame *frame) {
+    RenderFrame *slot = BeginWrite();
+    if (av_frame_ref(slot->frame, frame) < 0) {
+        PushFrameCopy(pImage);
+        return;
+    }
+    slot->image = *pImage;
+    Publish();
+}
+
+void RenderFrameBuffer::PushFrameCopy(NativeImage *pImage) {
+    RenderFrame *slot = BeginWrite();
+    NativeImage *copyImage = &slot->copyImage;
+    if (copyImage->format != pImage->format || copyImage->width != pImage->width || copyImage->height != pImage->height) {
+        NativeImageUtil::FreeNativeImage(copyImage);
+        copyImage->format = pImage->format;
+        copyImage->width = pImage->width;
+        copyImage->height = pImage->height;
+        NativeImageUtil::AllocNativeImage(copyImage);
+    }
+    NativeImageUtil::CopyNativeImage(pImage, copyImage);
+    slot->image = *copyImage;
+    Publish();
+}
+
+bool RenderFrameBuffer::AcquireLatest() {
+    if (!(m_ReadyIndex.load(memory_order_relaxed) & RENDER_FRAME_READY_FLAG)) {
+        return false;
+    }
+    //旧的读槽交还给生产者，不带 RENDER_FRAME_READY_FLAG
+    int prev = m_ReadyIndex.exchange(m_ReadIndex, memory_order_acq_rel);
+    m_ReadIndex = prev & RENDER_FRAME_SLOT_MASK;
+    return true;
+}
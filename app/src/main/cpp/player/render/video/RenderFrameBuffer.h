@@ -0,0 +1,63 @@
+#ifndef LEARNFFMPEG_RENDERFRAMEBUFFER_H
+#define LEARNFFMPEG_RENDERFRAMEBUFFER_H
+
+#include <atomic>
+#include <ImageDef.h>
+
+extern "C" {
+#include <libavutil/frame.h>
+};
+
+using namespace std;
+
+#define RENDER_FRAME_SLOT_NUM       3
+#define RENDER_FRAME_SLOT_MASK      0x3
+#define RENDER_FRAME_READY_FLAG     0x4     // 就绪槽中有 GL 线程还没取走的新帧
+
+//一个槽位中的帧
+struct RenderFrame {
+    NativeImage image;      // 待上传的图像，平面指向 frame 持有的解码缓冲或 copyImage
+    NativeImage copyImage;  // 输入不是引用计数帧时的拷贝
+    AVFrame *frame;
+};
+
+/**
+ * 同步线程与 GL 线程之间的三缓冲，写、就绪、读三个槽位通过原子交换槽号轮转，两端都不加锁。
+ * 同步线程写完写槽后与就绪槽交换；GL 线程取帧时若有新帧则把读槽与就绪槽交换，始终拿到最新的帧，
+ * 来不及显示的中间帧直接被覆盖。读槽只由 GL 线程访问，上传纹理期间不会阻塞同步线程。
+ * 只支持一个生产者和一个消费者。
+ */
+class RenderFrameBuffer {
+public:
+    RenderFrameBuffer();
+
+    ~RenderFrameBuffer();
+
+    //生产者（同步线程）：持有 frame 的引用，不拷贝平面数据
+    void PushFrameRef(NativeImage *pImage, AVFrame *frame);
+
+    //生产者（同步线程）：拷贝 pImage 的平面数据
+    void PushFrameCopy(NativeImage *pImage);
+
+    //消费者（GL 线程）：有新帧时换入读槽并返回 true
+    bool AcquireLatest();
+
+    //消费者（GL 线程）：当前读槽，还没有帧时 image.ppPlane[0] 为空
+    RenderFrame *GetReadFrame() {
+        return &m_Slots[m_ReadIndex];
+    }
+
+private:
+    //取出写槽，释放其中上一轮的帧
+    RenderFrame *BeginWrite();
+
+    void Publish();
+
+    RenderFrame m_Slots[RENDER_FRAME_SLOT_NUM];
+    int m_WriteIndex;               // 只由生产者访问
+    int m_ReadIndex;                // 只由消费者访问
+    atomic<int> m_ReadyIndex;       // 槽号 | RENDER_FRAME_READY_FLAG
+};
+
+
+#endif //LEARNFFMPEG_RENDERFRAMEBUFFER_H
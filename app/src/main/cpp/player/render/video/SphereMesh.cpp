@@ -0,0 +1,79 @@
+#include "SphereMesh.h"
+#include <LogUtil.h>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#define SPHERE_MESH_PI 3.1415926535897932384626433832802
+
+static std::mutex s_MeshMutex;
+//map 节点地址稳定，返回的指针在进程内一直有效
+static std::map<std::pair<int, float>, SphereMesh> s_MeshCache;
+
+const SphereMesh *SphereMesh::GetMesh(float radius, int angleSpan) {
+    if (angleSpan <= 0 || 180 % angleSpan != 0) {
+        LOGCATE("SphereMesh::GetMesh invalid angleSpan=%d", angleSpan);
+        return nullptr;
+    }
+    int rows = 180 / angleSpan;
+    int cols = 360 / angleSpan;
+    if ((rows + 1) * (cols + 1) > 0xFFFF) {
+        LOGCATE("SphereMesh::GetMesh too many vertices, angleSpan=%d", angleSpan);
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(s_MeshMutex);
+    std::pair<int, float> key(angleSpan, radius);
+    auto iter = s_MeshCache.find(key);
+    if (iter != s_MeshCache.end()) {
+        return &iter->second;
+    }
+    SphereMesh *mesh = &s_MeshCache[key];
+    mesh->Generate(radius, angleSpan);
+    LOGCATE("SphereMesh::GetMesh radius=%f, angleSpan=%d, vertices=%d, indices=%d", radius, angleSpan,
+            (int) mesh->m_Vertices.size(), (int) mesh->m_Indices.size());
+    return mesh;
+}
+
+void SphereMesh::Generate(float radius, int angleSpan) {
+    int rows = 180 / angleSpan;
+    int cols = 360 / angleSpan;
+
+    //第 i 行纬度为 90 - i * angleSpan，第 j 列经度为 360 - j * angleSpan，三角函数只按行、列各算一遍
+    std::vector<float> rowY(rows + 1), rowXoz(rows + 1), colCos(cols + 1), colSin(cols + 1);
+    for (int i = 0; i <= rows; ++i) {
+        double vAngle = (90.0 - i * angleSpan) / 180 * SPHERE_MESH_PI;
+        rowY[i] = (float) (radius * sin(vAngle));
+        rowXoz[i] = (float) (radius * cos(vAngle));
+    }
+    for (int j = 0; j <= cols; ++j) {
+        double hAngle = (360.0 - j * angleSpan) / 180 * SPHERE_MESH_PI;
+        colCos[j] = (float) cos(hAngle);
+        colSin[j] = (float) sin(hAngle);
+    }
+
+    //首尾两列位置相同、纹理坐标不同，接缝处需要各自的顶点
+    m_Vertices.reserve((rows + 1) * (cols + 1));
+    for (int i = 0; i <= rows; ++i) {
+        for (int j = 0; j <= cols; ++j) {
+            SphereVertex vertex;
+            vertex.position = glm::vec3(rowXoz[i] * colCos[j], rowY[i], rowXoz[i] * colSin[j]);
+            vertex.texCoord = glm::vec2((float) j / cols, (float) i / rows);
+            m_Vertices.push_back(vertex);
+        }
+    }
+
+    //每行 2 * (cols + 1) 个索引，行间补 2 个退化索引，保持三角形的绕向一致
+    m_Indices.reserve(rows * 2 * (cols + 1) + (rows - 1) * 2);
+    for (int i = 0; i < rows; ++i) {
+        if (i > 0) {
+            m_Indices.push_back(m_Indices.back());
+            m_Indices.push_back((GLushort) (i * (cols + 1)));
+        }
+        for (int j = 0; j <= cols; ++j) {
+            m_Indices.push_back((GLushort) (i * (cols + 1) + j));
+            m_Indices.push_back((GLushort) ((i + 1) * (cols + 1) + j));
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef LEARNFFMPEG_SPHEREMESH_H
+#define LEARNFFMPEG_SPHEREMESH_H
+
+#include <GLES3/gl3.h>
+#include <vec2.hpp>
+#include <vec3.hpp>
+#include <vector>
+
+//交错存放的顶点，整个网格只用一个 VBO
+struct SphereVertex {
+    glm::vec3 position;
+    glm::vec2 texCoord;
+};
+
+/**
+ * 球面网格，顶点按经纬度网格生成并共享，每行是一条三角形带，行与行之间用退化三角形连接，
+ * 整个球面一次 glDrawElements(GL_TRIANGLE_STRIP) 画完。
+ * 同一参数的网格进程内只生成一次，多个 GL 上下文共用同一份顶点和索引数据，只需各自创建缓冲对象。
+ * 纹理坐标与球面展开后的矩形对应：s 沿经线方向从 0 到 1，t 从北极 0 到南极 1。
+ */
+class SphereMesh {
+public:
+    //angleSpan 为经纬方向每格的角度，需能整除 180；参数非法或顶点数超出 GLushort 范围时返回 nullptr
+    static const SphereMesh *GetMesh(float radius, int angleSpan);
+
+    const std::vector<SphereVertex> &GetVertices() const {
+        return m_Vertices;
+    }
+
+    const std::vector<GLushort> &GetIndices() const {
+        return m_Indices;
+    }
+
+private:
+    void Generate(float radius, int angleSpan);
+
+    std::vector<SphereVertex> m_Vertices;
+    std::vector<GLushort> m_Indices;
+};
+
+
+#endif //LEARNFFMPEG_SPHEREMESH_H
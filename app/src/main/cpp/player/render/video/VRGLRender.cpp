@@ -5,6 +5,7 @@
 #include "VRGLRender.h"
 #include <GLUtils.h>
 #include <gtc/matrix_transform.hpp>
+#include <cstddef>
 
 VRGLRender* VRGLRender::s_Instance = nullptr;
 std::mutex VRGLRender::m_Mutex;
@@ -21,63 +22,6 @@ static char vShaderStr[] =
         "    v_texCoord = a_texCoord;\n"
         "}";
 
-static char fShaderStr[] =
-        "#version 300 es\n"
-        "precision highp float;\n"
-        "in vec2 v_texCoord;\n"
-        "layout(location = 0) out vec4 outColor;\n"
-        "uniform sampler2D s_texture0;\n"
-        "uniform sampler2D s_texture1;\n"
-        "uniform sampler2D s_texture2;\n"
-        "uniform int u_nImgType;// 1:RGBA, 2:NV21, 3:NV12, 4:I420\n"
-        "\n"
-        "void main()\n"
-        "{\n"
-        "\n"
-        "    if(u_nImgType == 1) //RGBA\n"
-        "    {\n"
-        "        outColor = texture(s_texture0, v_texCoord);\n"
-        "    }\n"
-        "    else if(u_nImgType == 2) //NV21\n"
-        "    {\n"
-        "        vec3 yuv;\n"
-        "        yuv.x = texture(s_texture0, v_texCoord).r;\n"
-        "        yuv.y = texture(s_texture1, v_texCoord).a - 0.5;\n"
-        "        yuv.z = texture(s_texture1, v_texCoord).r - 0.5;\n"
-        "        highp vec3 rgb = mat3(1.0,       1.0,     1.0,\n"
-        "        0.0, \t-0.344, \t1.770,\n"
-        "        1.403,  -0.714,     0.0) * yuv;\n"
-        "        outColor = vec4(rgb, 1.0);\n"
-        "\n"
-        "    }\n"
-        "    else if(u_nImgType == 3) //NV12\n"
-        "    {\n"
-        "        vec3 yuv;\n"
-        "        yuv.x = texture(s_texture0, v_texCoord).r;\n"
-        "        yuv.y = texture(s_texture1, v_texCoord).r - 0.5;\n"
-        "        yuv.z = texture(s_texture1, v_texCoord).a - 0.5;\n"
-        "        highp vec3 rgb = mat3(1.0,       1.0,     1.0,\n"
-        "        0.0, \t-0.344, \t1.770,\n"
-        "        1.403,  -0.714,     0.0) * yuv;\n"
-        "        outColor = vec4(rgb, 1.0);\n"
-        "    }\n"
-        "    else if(u_nImgType == 4) //I420\n"
-        "    {\n"
-        "        vec3 yuv;\n"
-        "        yuv.x = texture(s_texture0, v_texCoord).r;\n"
-        "        yuv.y = texture(s_texture1, v_texCoord).r - 0.5;\n"
-        "        yuv.z = texture(s_texture2, v_texCoord).r - 0.5;\n"
-        "        highp vec3 rgb = mat3(1.0,       1.0,     1.0,\n"
-        "                              0.0, \t-0.344, \t1.770,\n"
-        "                              1.403,  -0.714,     0.0) * yuv;\n"
-        "        outColor = vec4(rgb, 1.0);\n"
-        "    }\n"
-        "    else\n"
-        "    {\n"
-        "        outColor = vec4(1.0);\n"
-        "    }\n"
-        "}";
-
 static char fMeshShaderStr[] =
         "//dynimic mesh 动态网格\n"
         "#version 300 es\n"
@@ -145,7 +89,6 @@ VRGLRender::VRGLRender():VideoRender(VIDEO_RENDER_3D_VR) {
 }
 
 VRGLRender::~VRGLRender() {
-    NativeImageUtil::FreeNativeImage(&m_RenderImage);
 
 }
 
@@ -158,19 +101,18 @@ void VRGLRender::Init(int videoWidth, int videoHeight, int *dstSize) {
 }
 
 void VRGLRender::RenderVideoFrame(NativeImage *pImage) {
-    LOGCATE("VRGLRender::RenderVideoFrame pImage=%p", pImage);
+    LOGCATT("VRGLRender::RenderVideoFrame pImage=%p", pImage);
     if(pImage == nullptr || pImage->ppPlane[0] == nullptr)
         return;
-    std::unique_lock<std::mutex> lock(m_Mutex);
-    if(m_RenderImage.ppPlane[0] == nullptr)
-    {
-        m_RenderImage.format = pImage->format;
-        m_RenderImage.width = pImage->width;
-        m_RenderImage.height = pImage->height;
-        NativeImageUtil::AllocNativeImage(&m_RenderImage);
-    }
+    m_FrameBuffer.PushFrameCopy(pImage);
+}
 
-    NativeImageUtil::CopyNativeImage(pImage, &m_RenderImage);
+void VRGLRender::RenderVideoFrameRef(NativeImage *pImage, AVFrame *frame) {
+    LOGCATT("VRGLRender::RenderVideoFrameRef pImage=%p, frame=%p", pImage, frame);
+    if(pImage == nullptr || pImage->ppPlane[0] == nullptr || frame == nullptr)
+        return;
+    //持有解码帧的引用，OnDrawFrame 直接从解码缓冲上传纹理，槽位被复用时旧帧的缓冲回到 VideoBufferPool
+    m_FrameBuffer.PushFrameRef(pImage, frame);
 }
 
 void VRGLRender::UnInit() {
@@ -212,32 +154,30 @@ void VRGLRender::UpdateMVPMatrix(int angleX, int angleY, float scaleX, float sca
 void VRGLRender::OnSurfaceCreated() {
     LOGCATE("VRGLRender::OnSurfaceCreated");
 
-    m_ProgramObj = GLUtils::CreateProgram(vShaderStr, fShaderStr);
-    if (!m_ProgramObj)
+    //各像素格式的程序一次性编译好，OnDrawFrame 按帧格式选择
+    if (m_ProgramCache.Init(vShaderStr) != 0)
     {
         LOGCATE("VRGLRender::OnSurfaceCreated create program fail");
         return;
     }
     GenerateMesh();
-
-    glGenTextures(TEXTURE_NUM, m_TextureIds);
-    for (int i = 0; i < TEXTURE_NUM ; ++i) {
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, GL_NONE);
+    if (m_SphereMesh == nullptr)
+    {
+        LOGCATE("VRGLRender::OnSurfaceCreated generate mesh fail");
+        return;
     }
 
+    //纹理在第一次上传时按帧的尺寸和格式分配，新上下文需要重新上传当前帧
+    m_TextureUploader.OnSurfaceCreated();
+    m_NeedUpload = true;
+
     // Generate VBO Ids and load the VBOs with data
+    const vector<SphereVertex> &vertices = m_SphereMesh->GetVertices();
+    const vector<GLushort> &indices = m_SphereMesh->GetIndices();
     glGenBuffers(2, m_VboIds);
     glBindBuffer(GL_ARRAY_BUFFER, m_VboIds[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vec3) * m_VertexCoords.size(), &m_VertexCoords[0], GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_VboIds[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vec2) * m_TextureCoords.size(), &m_TextureCoords[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(SphereVertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
 
     // Generate VAO Id
     glGenVertexArrays(1, &m_VaoId);
@@ -245,15 +185,17 @@ void VRGLRender::OnSurfaceCreated() {
 
     glBindBuffer(GL_ARRAY_BUFFER, m_VboIds[0]);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (const void *)0);
-    glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_VboIds[1]);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SphereVertex), (const void *)offsetof(SphereVertex, position));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (const void *)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SphereVertex), (const void *)offsetof(SphereVertex, texCoord));
     glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
 
+    //索引缓冲的绑定记录在 VAO 中，VAO 解绑前不能解绑
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_VboIds[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), &indices[0], GL_STATIC_DRAW);
+
     glBindVertexArray(GL_NONE);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
 
     m_TouchXY = vec2(0.5f, 0.5f);
 }
@@ -269,95 +211,46 @@ void VRGLRender::OnSurfaceChanged(int w, int h) {
 
 void VRGLRender::OnDrawFrame() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    if(m_ProgramObj == GL_NONE || m_RenderImage.ppPlane[0] == nullptr) return;
-    LOGCATE("VRGLRender::OnDrawFrame [w, h]=[%d, %d]", m_RenderImage.width, m_RenderImage.height);
+    //取最新的就绪帧，不阻塞同步线程；没有新帧时沿用已上传的纹理
+    if(m_FrameBuffer.AcquireLatest()) m_NeedUpload = true;
+    NativeImage *pImage = &m_FrameBuffer.GetReadFrame()->image;
+    if(pImage->ppPlane[0] == nullptr) return;
+    VideoProgram *program = m_ProgramCache.GetProgram(pImage->format);
+    if(program == nullptr || m_SphereMesh == nullptr) return;
+    LOGCATT("VRGLRender::OnDrawFrame [w, h]=[%d, %d]", pImage->width, pImage->height);
     m_FrameIndex++;
     //glEnable(GL_CULL_FACE);
     glEnable(GL_DEPTH_TEST);
-    // upload image data
-    std::unique_lock<std::mutex> lock(m_Mutex);
-    switch (m_RenderImage.format)
-    {
-        case IMAGE_FORMAT_RGBA:
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[0]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_RenderImage.width, m_RenderImage.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_RenderImage.ppPlane[0]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            break;
-        case IMAGE_FORMAT_NV21:
-        case IMAGE_FORMAT_NV12:
-            //upload Y plane data
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[0]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width,
-                         m_RenderImage.height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[0]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-
-            //update UV plane data
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[1]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, m_RenderImage.width >> 1,
-                         m_RenderImage.height >> 1, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[1]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            break;
-        case IMAGE_FORMAT_I420:
-            //upload Y plane data
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[0]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width,
-                         m_RenderImage.height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[0]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-
-            //update U plane data
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[1]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width >> 1,
-                         m_RenderImage.height >> 1, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[1]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-
-            //update V plane data
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[2]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width >> 1,
-                         m_RenderImage.height >> 1, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[2]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            break;
-        default:
-            break;
+    if(m_NeedUpload) {
+        m_TextureUploader.Upload(pImage);
+        m_NeedUpload = false;
     }
-    lock.unlock();
 
 
     // Use the program object
-    glUseProgram (m_ProgramObj);
+    glUseProgram (program->program);
 
     glBindVertexArray(m_VaoId);
 
-    GLUtils::setMat4(m_ProgramObj, "u_MVPMatrix", m_MVPMatrix);
+    glUniformMatrix4fv(program->mvpMatrixLoc, 1, GL_FALSE, &m_MVPMatrix[0][0]);
 
     for (int i = 0; i < TEXTURE_NUM; ++i) {
         glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
-        char samplerName[64] = {0};
-        sprintf(samplerName, "s_texture%d", i);
-        GLUtils::setInt(m_ProgramObj, samplerName, i);
+        glBindTexture(GL_TEXTURE_2D, m_TextureUploader.GetTextureId(i));
     }
 
     //float time = static_cast<float>(fmod(m_FrameIndex, 60) / 50);
-    //GLUtils::setFloat(m_ProgramObj, "u_Time", time);
+    //GLUtils::setFloat(program->program, "u_Time", time);
 
-    float offset = (sin(m_FrameIndex * MATH_PI / 25) + 1.0f) / 2.0f;
-    GLUtils::setFloat(m_ProgramObj, "u_Offset", offset);
-    GLUtils::setVec2(m_ProgramObj, "u_TexSize", vec2(m_RenderImage.width, m_RenderImage.height));
-    GLUtils::setInt(m_ProgramObj, "u_nImgType", m_RenderImage.format);
+    if (program->offsetLoc >= 0) {
+        float offset = (sin(m_FrameIndex * MATH_PI / 25) + 1.0f) / 2.0f;
+        glUniform1f(program->offsetLoc, offset);
+    }
+    if (program->texSizeLoc >= 0) {
+        glUniform2f(program->texSizeLoc, pImage->width, pImage->height);
+    }
 
-    glDrawArrays(GL_TRIANGLES, 0, m_VertexCoords.size());
-    //glDrawArrays(GL_LINES, 0, m_VertexCoords.size());
+    glDrawElements(GL_TRIANGLE_STRIP, m_SphereMesh->GetIndices().size(), GL_UNSIGNED_SHORT, (const void *)0);
 
 }
 
@@ -388,68 +281,6 @@ void VRGLRender::ReleaseInstance() {
 }
 
 void VRGLRender::GenerateMesh() {
-    //构建顶点坐标
-    for (float vAngle = 90; vAngle > -90; vAngle = vAngle - ANGLE_SPAN) {//垂直方向ANGLE_SPAN度一份
-        for (float hAngle = 360; hAngle > 0; hAngle = hAngle - ANGLE_SPAN) {//水平方向ANGLE_SPAN度一份
-            //纵向横向各到一个角度后计算对应的此点在球面上的坐标
-            double xozLength = BALL_RADIUS * UNIT_SIZE * cos(RADIAN(vAngle));
-            float x1 = (float) (xozLength * cos(RADIAN(hAngle)));
-            float z1 = (float) (xozLength * sin(RADIAN(hAngle)));
-            float y1 = (float) (BALL_RADIUS * UNIT_SIZE * sin(RADIAN(vAngle)));
-            xozLength = BALL_RADIUS * UNIT_SIZE * cos(RADIAN(vAngle - ANGLE_SPAN));
-            float x2 = (float) (xozLength * cos(RADIAN(hAngle)));
-            float z2 = (float) (xozLength * sin(RADIAN(hAngle)));
-            float y2 = (float) (BALL_RADIUS * UNIT_SIZE * sin(RADIAN(vAngle - ANGLE_SPAN)));
-            xozLength = BALL_RADIUS * UNIT_SIZE * cos(RADIAN(vAngle - ANGLE_SPAN));
-            float x3 = (float) (xozLength * cos(RADIAN(hAngle - ANGLE_SPAN)));
-            float z3 = (float) (xozLength * sin(RADIAN(hAngle - ANGLE_SPAN)));
-            float y3 = (float) (BALL_RADIUS * UNIT_SIZE * sin(RADIAN(vAngle - ANGLE_SPAN)));
-            xozLength = BALL_RADIUS * UNIT_SIZE * cos(RADIAN(vAngle));
-            float x4 = (float) (xozLength * cos(RADIAN(hAngle - ANGLE_SPAN)));
-            float z4 = (float) (xozLength * sin(RADIAN(hAngle - ANGLE_SPAN)));
-            float y4 = (float) (BALL_RADIUS * UNIT_SIZE * sin(RADIAN(vAngle)));
-
-            vec3 v1(x1, y1, z1);
-            vec3 v2(x2, y2, z2);
-            vec3 v3(x3, y3, z3);
-            vec3 v4(x4, y4, z4);
-
-            //构建第一个三角形
-            m_VertexCoords.push_back(v1);
-            m_VertexCoords.push_back(v2);
-            m_VertexCoords.push_back(v4);
-            //构建第二个三角形
-            m_VertexCoords.push_back(v4);
-            m_VertexCoords.push_back(v2);
-            m_VertexCoords.push_back(v3);
-        }
-    }
-
-    //构建纹理坐标，球面展开后的矩形
-    int width = 360 / ANGLE_SPAN;//列数
-    int height = 180 / ANGLE_SPAN;//行数
-    float dw = 1.0f / width;
-    float dh = 1.0f / height;
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            //每一个小矩形，由两个三角形构成，共六个点
-            float s = j * dw;
-            float t = i * dh;
-            vec2 v1(s, t);
-            vec2 v2(s, t + dh);
-            vec2 v3(s + dw, t + dh);
-            vec2 v4(s + dw, t);
-
-            //构建第一个三角形
-            m_TextureCoords.push_back(v1);
-            m_TextureCoords.push_back(v2);
-            m_TextureCoords.push_back(v4);
-            //构建第二个三角形
-            m_TextureCoords.push_back(v4);
-            m_TextureCoords.push_back(v2);
-            m_TextureCoords.push_back(v3);
-        }
-    }
+    //球面网格只在第一次用到时生成，上下文重建只需重新创建缓冲对象
+    m_SphereMesh = SphereMesh::GetMesh(BALL_RADIUS * UNIT_SIZE, ANGLE_SPAN);
 }
-
-
@@ -7,6 +7,10 @@
 #include <thread>
 #include <ImageDef.h>
 #include "VideoRender.h"
+#include "RenderFrameBuffer.h"
+#include "VideoTextureUploader.h"
+#include "VideoProgramCache.h"
+#include "SphereMesh.h"
 #include <GLES3/gl3.h>
 #include <detail/type_mat.hpp>
 #include <detail/type_mat4x4.hpp>
@@ -28,6 +32,7 @@ class VRGLRender: public VideoRender, public BaseGLRender {
 public:
     virtual void Init(int videoWidth, int videoHeight, int *dstSize);
     virtual void RenderVideoFrame(NativeImage *pImage);
+    virtual void RenderVideoFrameRef(NativeImage *pImage, AVFrame *frame);
     virtual void UnInit();
 
     virtual void OnSurfaceCreated();
@@ -52,18 +57,21 @@ private:
 
     static std::mutex m_Mutex;
     static VRGLRender* s_Instance;
-    GLuint m_ProgramObj = GL_NONE;
-    GLuint m_TextureIds[TEXTURE_NUM];
+    VideoProgramCache m_ProgramCache;
+    VideoTextureUploader m_TextureUploader;
     GLuint m_VaoId;
-    GLuint m_VboIds[2];
-    NativeImage m_RenderImage;
+    GLuint m_VboIds[2];     // 交错顶点缓冲、索引缓冲
+    //同步线程与 GL 线程之间的帧交换，不加锁
+    RenderFrameBuffer m_FrameBuffer;
+    //纹理需要重新上传（有新帧或纹理重建）
+    bool m_NeedUpload = false;
     glm::mat4 m_MVPMatrix;
 
     int m_FrameIndex;
     vec2 m_TouchXY;
     vec2 m_ScreenSize;
-    vector<vec3> m_VertexCoords;
-    vector<vec2> m_TextureCoords;
+    //进程内共享的球面网格，不随上下文重建而重新生成
+    const SphereMesh *m_SphereMesh = nullptr;
 };
 
 
@@ -0,0 +1,122 @@
+#include <LogUtil.h>
+#include <ImageDef.h>
+#include "VideoBufferPool.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/macros.h>
+};
+
+//与 avcodec_default_get_buffer2 一致，为 SIMD 越界读预留的尾部空间
+#define VIDEO_BUFFER_TAIL_PADDING (16 + VIDEO_BUFFER_ALIGN - 1)
+
+VideoBufferPool::VideoBufferPool() {
+    m_PooledCount = 0;
+    m_FallbackCount = 0;
+}
+
+VideoBufferPool::~VideoBufferPool() {
+    //仍被帧队列或渲染器引用的缓冲区会在最后一个引用释放时随池一起释放
+    av_buffer_pool_uninit(&m_Pool);
+}
+
+void VideoBufferPool::Attach(AVCodecContext *codecCtx) {
+    codecCtx->opaque = this;
+    codecCtx->get_buffer2 = GetBuffer2;
+    //GetBuffer2 可在多个帧线程中并发调用
+    codecCtx->thread_safe_callbacks = 1;
+}
+
+int VideoBufferPool::GetBuffer2(AVCodecContext *codecCtx, AVFrame *frame, int flags) {
+    VideoBufferPool *pool = static_cast<VideoBufferPool *>(codecCtx->opaque);
+    if (pool == nullptr || !(codecCtx->codec->capabilities & AV_CODEC_CAP_DR1) || GetImageFormat(frame->format) == 0) {
+        if (pool != nullptr) pool->m_FallbackCount.fetch_add(1, memory_order_relaxed);
+        return avcodec_default_get_buffer2(codecCtx, frame, flags);
+    }
+
+    if (pool->AllocFrameBuffer(codecCtx, frame) < 0) {
+        pool->m_FallbackCount.fetch_add(1, memory_order_relaxed);
+        return avcodec_default_get_buffer2(codecCtx, frame, flags);
+    }
+    pool->m_PooledCount.fetch_add(1, memory_order_relaxed);
+    return 0;
+}
+
+int VideoBufferPool::UpdatePool(AVCodecContext *codecCtx, AVFrame *frame) {
+    if (m_Pool != nullptr && m_Format == frame->format && m_Width == frame->width && m_Height == frame->height) {
+        return 0;
+    }
+
+    av_buffer_pool_uninit(&m_Pool);
+
+    //按解码器要求对齐宽高（宏块、运动补偿越界写），行宽再按 VIDEO_BUFFER_ALIGN 对齐
+    int alignedWidth = frame->width;
+    int alignedHeight = frame->height;
+    int lineSizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecCtx, &alignedWidth, &alignedHeight, lineSizeAlign);
+
+    int lineSize[4] = {0};
+    int result = av_image_fill_linesizes(lineSize, (AVPixelFormat) frame->format, alignedWidth);
+    if (result < 0) {
+        return result;
+    }
+    for (int i = 0; i < 4; ++i) {
+        lineSize[i] = FFALIGN(lineSize[i], VIDEO_BUFFER_ALIGN);
+    }
+
+    //只计算各平面的偏移和总大小，所有平面放在同一块缓冲区中
+    uint8_t *planes[4] = {nullptr};
+    int bufferSize = av_image_fill_pointers(planes, (AVPixelFormat) frame->format, alignedHeight, nullptr, lineSize);
+    if (bufferSize < 0) {
+        return bufferSize;
+    }
+
+    //av_malloc 不保证 VIDEO_BUFFER_ALIGN 对齐，多分配一段用于调整起始地址
+    m_Pool = av_buffer_pool_init(bufferSize + VIDEO_BUFFER_ALIGN + VIDEO_BUFFER_TAIL_PADDING, av_buffer_alloc);
+    if (m_Pool == nullptr) {
+        return AVERROR(ENOMEM);
+    }
+
+    m_Format = frame->format;
+    m_Width = frame->width;
+    m_Height = frame->height;
+    for (int i = 0; i < 4; ++i) {
+        m_LineSize[i] = lineSize[i];
+        m_PlaneOffset[i] = planes[i] ? (int) (planes[i] - planes[0]) : 0;
+    }
+    LOGCATE("VideoBufferPool::UpdatePool format=%d, [w,h]=[%d, %d], aligned[w,h]=[%d, %d], [line0,line1,line2]=[%d, %d, %d], bufferSize=%d",
+            m_Format, m_Width, m_Height, alignedWidth, alignedHeight, m_LineSize[0], m_LineSize[1], m_LineSize[2], bufferSize);
+    return 0;
+}
+
+int VideoBufferPool::AllocFrameBuffer(AVCodecContext *codecCtx, AVFrame *frame) {
+    AVBufferRef *buf = nullptr;
+    int lineSize[4];
+    int planeOffset[4];
+    {
+        unique_lock<mutex> lock(m_Mutex);
+        if (UpdatePool(codecCtx, frame) < 0) {
+            return -1;
+        }
+        buf = av_buffer_pool_get(m_Pool);
+        for (int i = 0; i < 4; ++i) {
+            lineSize[i] = m_LineSize[i];
+            planeOffset[i] = m_PlaneOffset[i];
+        }
+    }
+    if (buf == nullptr) {
+        return AVERROR(ENOMEM);
+    }
+
+    uint8_t *base = (uint8_t *) FFALIGN((uintptr_t) buf->data, VIDEO_BUFFER_ALIGN);
+    memset(frame->data, 0, sizeof(frame->data));
+    memset(frame->linesize, 0, sizeof(frame->linesize));
+    for (int i = 0; i < 4; ++i) {
+        if (lineSize[i] == 0) break;
+        frame->data[i] = base + planeOffset[i];
+        frame->linesize[i] = lineSize[i];
+    }
+    frame->buf[0] = buf;
+    frame->extended_data = frame->data;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef LEARNFFMPEG_VIDEOBUFFERPOOL_H
+#define LEARNFFMPEG_VIDEOBUFFERPOOL_H
+
+#include <atomic>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+};
+
+using namespace std;
+
+//平面起始地址和行宽的对齐字节数，满足 SIMD 读取和纹理上传（GL_UNPACK_ROW_LENGTH）的要求
+#define VIDEO_BUFFER_ALIGN 64
+
+/**
+ * 视频帧缓冲池，作为视频 AVCodecContext 的 get_buffer2 直接为解码器提供帧缓冲。
+ * 缓冲区引用计数，随 AVFrame 经帧队列交给渲染器，渲染器直接持有引用读取各平面，不再拷贝；
+ * 最后一个引用释放后回到池中复用。仅处理渲染器可直接使用的像素格式，
+ * 硬解、不支持 DR1 的解码器和其他格式回退到 avcodec_default_get_buffer2。
+ */
+class VideoBufferPool {
+public:
+    VideoBufferPool();
+
+    virtual ~VideoBufferPool();
+
+    // 在 avcodec_open2 之前调用
+    void Attach(AVCodecContext *codecCtx);
+
+    int64_t GetPooledCount() {
+        return m_PooledCount.load(memory_order_relaxed);
+    }
+
+    int64_t GetFallbackCount() {
+        return m_FallbackCount.load(memory_order_relaxed);
+    }
+
+private:
+    static int GetBuffer2(AVCodecContext *codecCtx, AVFrame *frame, int flags);
+
+    int AllocFrameBuffer(AVCodecContext *codecCtx, AVFrame *frame);
+
+    //尺寸或格式变化时重建内部池，调用方持有 m_Mutex
+    int UpdatePool(AVCodecContext *codecCtx, AVFrame *frame);
+
+    mutex m_Mutex;
+    AVBufferPool *m_Pool = nullptr;
+    int m_Format = AV_PIX_FMT_NONE;
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_LineSize[4] = {0};
+    int m_PlaneOffset[4] = {0};
+
+    atomic<int64_t> m_PooledCount;
+    atomic<int64_t> m_FallbackCount;
+};
+
+
+#endif //LEARNFFMPEG_VIDEOBUFFERPOOL_H
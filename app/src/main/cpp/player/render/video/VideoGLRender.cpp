@@ -21,63 +21,6 @@ static char vShaderStr[] =
         "    v_texCoord = a_texCoord;\n"
         "}";
 
-static char fShaderStr[] =
-        "#version 300 es\n"
-        "precision highp float;\n"
-        "in vec2 v_texCoord;\n"
-        "layout(location = 0) out vec4 outColor;\n"
-        "uniform sampler2D s_texture0;\n"
-        "uniform sampler2D s_texture1;\n"
-        "uniform sampler2D s_texture2;\n"
-        "uniform int u_nImgType;// 1:RGBA, 2:NV21, 3:NV12, 4:I420\n"
-        "\n"
-        "void main()\n"
-        "{\n"
-        "\n"
-        "    if(u_nImgType == 1) //RGBA\n"
-        "    {\n"
-        "        outColor = texture(s_texture0, v_texCoord);\n"
-        "    }\n"
-        "    else if(u_nImgType == 2) //NV21\n"
-        "    {\n"
-        "        vec3 yuv;\n"
-        "        yuv.x = texture(s_texture0, v_texCoord).r;\n"
-        "        yuv.y = texture(s_texture1, v_texCoord).a - 0.5;\n"
-        "        yuv.z = texture(s_texture1, v_texCoord).r - 0.5;\n"
-        "        highp vec3 rgb = mat3(1.0,       1.0,     1.0,\n"
-        "        0.0, \t-0.344, \t1.770,\n"
-        "        1.403,  -0.714,     0.0) * yuv;\n"
-        "        outColor = vec4(rgb, 1.0);\n"
-        "\n"
-        "    }\n"
-        "    else if(u_nImgType == 3) //NV12\n"
-        "    {\n"
-        "        vec3 yuv;\n"
-        "        yuv.x = texture(s_texture0, v_texCoord).r;\n"
-        "        yuv.y = texture(s_texture1, v_texCoord).r - 0.5;\n"
-        "        yuv.z = texture(s_texture1, v_texCoord).a - 0.5;\n"
-        "        highp vec3 rgb = mat3(1.0,       1.0,     1.0,\n"
-        "        0.0, \t-0.344, \t1.770,\n"
-        "        1.403,  -0.714,     0.0) * yuv;\n"
-        "        outColor = vec4(rgb, 1.0);\n"
-        "    }\n"
-        "    else if(u_nImgType == 4) //I420\n"
-        "    {\n"
-        "        vec3 yuv;\n"
-        "        yuv.x = texture(s_texture0, v_texCoord).r;\n"
-        "        yuv.y = texture(s_texture1, v_texCoord).r - 0.5;\n"
-        "        yuv.z = texture(s_texture2, v_texCoord).r - 0.5;\n"
-        "        highp vec3 rgb = mat3(1.0,       1.0,     1.0,\n"
-        "                              0.0, \t-0.344, \t1.770,\n"
-        "                              1.403,  -0.714,     0.0) * yuv;\n"
-        "        outColor = vec4(rgb, 1.0);\n"
-        "    }\n"
-        "    else\n"
-        "    {\n"
-        "        outColor = vec4(1.0);\n"
-        "    }\n"
-        "}";
-
 static char fMeshShaderStr[] =
         "//dynimic mesh 动态网格\n"
         "#version 300 es\n"
@@ -145,7 +88,6 @@ VideoGLRender::VideoGLRender():VideoRender(VIDEO_RENDER_OPENGL) {
 }
 
 VideoGLRender::~VideoGLRender() {
-    NativeImageUtil::FreeNativeImage(&m_RenderImage);
 
 }
 
@@ -157,19 +99,18 @@ void VideoGLRender::Init(int videoWidth, int videoHeight, int *dstSize) {
 }
 
 void VideoGLRender::RenderVideoFrame(NativeImage *pImage) {
-    LOGCATE("VideoGLRender::RenderVideoFrame pImage=%p", pImage);
+    LOGCATT("VideoGLRender::RenderVideoFrame pImage=%p", pImage);
     if(pImage == nullptr || pImage->ppPlane[0] == nullptr)
         return;
-    std::unique_lock<std::mutex> lock(m_Mutex);
-    if(m_RenderImage.ppPlane[0] == nullptr)
-    {
-        m_RenderImage.format = pImage->format;
-        m_RenderImage.width = pImage->width;
-        m_RenderImage.height = pImage->height;
-        NativeImageUtil::AllocNativeImage(&m_RenderImage);
-    }
+    m_FrameBuffer.PushFrameCopy(pImage);
+}
 
-    NativeImageUtil::CopyNativeImage(pImage, &m_RenderImage);
+void VideoGLRender::RenderVideoFrameRef(NativeImage *pImage, AVFrame *frame) {
+    LOGCATT("VideoGLRender::RenderVideoFrameRef pImage=%p, frame=%p", pImage, frame);
+    if(pImage == nullptr || pImage->ppPlane[0] == nullptr || frame == nullptr)
+        return;
+    //持有解码帧的引用，OnDrawFrame 直接从解码缓冲上传纹理，槽位被复用时旧帧的缓冲回到 VideoBufferPool
+    m_FrameBuffer.PushFrameRef(pImage, frame);
 }
 
 void VideoGLRender::UnInit() {
@@ -210,23 +151,16 @@ void VideoGLRender::UpdateMVPMatrix(int angleX, int angleY, float scaleX, float
 void VideoGLRender::OnSurfaceCreated() {
     LOGCATE("VideoGLRender::OnSurfaceCreated");
 
-    m_ProgramObj = GLUtils::CreateProgram(vShaderStr, fShaderStr);
-    if (!m_ProgramObj)
+    //各像素格式的程序一次性编译好，OnDrawFrame 按帧格式选择
+    if (m_ProgramCache.Init(vShaderStr) != 0)
     {
         LOGCATE("VideoGLRender::OnSurfaceCreated create program fail");
         return;
     }
 
-    glGenTextures(TEXTURE_NUM, m_TextureIds);
-    for (int i = 0; i < TEXTURE_NUM ; ++i) {
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, GL_NONE);
-    }
+    //纹理在第一次上传时按帧的尺寸和格式分配，新上下文需要重新上传当前帧
+    m_TextureUploader.OnSurfaceCreated();
+    m_NeedUpload = true;
 
     // Generate VBO Ids and load the VBOs with data
     glGenBuffers(3, m_VboIds);
@@ -271,94 +205,46 @@ void VideoGLRender::OnSurfaceChanged(int w, int h) {
 
 void VideoGLRender::OnDrawFrame() {
     glClear(GL_COLOR_BUFFER_BIT);
-    if(m_ProgramObj == GL_NONE|| m_RenderImage.ppPlane[0] == nullptr) return;
-    LOGCATE("VideoGLRender::OnDrawFrame [w, h]=[%d, %d], format=%d", m_RenderImage.width, m_RenderImage.height, m_RenderImage.format);
+    //取最新的就绪帧，不阻塞同步线程；没有新帧时沿用已上传的纹理
+    if(m_FrameBuffer.AcquireLatest()) m_NeedUpload = true;
+    NativeImage *pImage = &m_FrameBuffer.GetReadFrame()->image;
+    if(pImage->ppPlane[0] == nullptr) return;
+    VideoProgram *program = m_ProgramCache.GetProgram(pImage->format);
+    if(program == nullptr) return;
+    LOGCATT("VideoGLRender::OnDrawFrame [w, h]=[%d, %d], format=%d", pImage->width, pImage->height, pImage->format);
     m_FrameIndex++;
 
 //    if(m_FrameIndex == 2)
-//        NativeImageUtil::DumpNativeImage(&m_RenderImage, "/sdcard", "2222");
+//        NativeImageUtil::DumpNativeImage(pImage, "/sdcard", "2222");
 
-    // upload image data
-    std::unique_lock<std::mutex> lock(m_Mutex);
-    switch (m_RenderImage.format)
-    {
-        case IMAGE_FORMAT_RGBA:
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[0]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_RenderImage.width, m_RenderImage.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_RenderImage.ppPlane[0]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            break;
-        case IMAGE_FORMAT_NV21:
-        case IMAGE_FORMAT_NV12:
-            //upload Y plane data
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[0]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width,
-                         m_RenderImage.height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[0]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-
-            //update UV plane data
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[1]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, m_RenderImage.width >> 1,
-                         m_RenderImage.height >> 1, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[1]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            break;
-        case IMAGE_FORMAT_I420:
-            //upload Y plane data
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[0]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width,
-                         m_RenderImage.height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[0]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-
-            //update U plane data
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[1]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width >> 1,
-                         m_RenderImage.height >> 1, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[1]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-
-            //update V plane data
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, m_TextureIds[2]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_RenderImage.width >> 1,
-                         m_RenderImage.height >> 1, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
-                         m_RenderImage.ppPlane[2]);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            break;
-        default:
-            break;
+    if(m_NeedUpload) {
+        m_TextureUploader.Upload(pImage);
+        m_NeedUpload = false;
     }
-    lock.unlock();
 
 
     // Use the program object
-    glUseProgram (m_ProgramObj);
+    glUseProgram (program->program);
 
     glBindVertexArray(m_VaoId);
 
-    GLUtils::setMat4(m_ProgramObj, "u_MVPMatrix", m_MVPMatrix);
+    glUniformMatrix4fv(program->mvpMatrixLoc, 1, GL_FALSE, &m_MVPMatrix[0][0]);
 
     for (int i = 0; i < TEXTURE_NUM; ++i) {
         glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
-        char samplerName[64] = {0};
-        sprintf(samplerName, "s_texture%d", i);
-        GLUtils::setInt(m_ProgramObj, samplerName, i);
+        glBindTexture(GL_TEXTURE_2D, m_TextureUploader.GetTextureId(i));
     }
 
     //float time = static_cast<float>(fmod(m_FrameIndex, 60) / 50);
-    //GLUtils::setFloat(m_ProgramObj, "u_Time", time);
+    //GLUtils::setFloat(program->program, "u_Time", time);
 
-    float offset = (sin(m_FrameIndex * MATH_PI / 25) + 1.0f) / 2.0f;
-    GLUtils::setFloat(m_ProgramObj, "u_Offset", offset);
-    GLUtils::setVec2(m_ProgramObj, "u_TexSize", vec2(m_RenderImage.width, m_RenderImage.height));
-    GLUtils::setInt(m_ProgramObj, "u_nImgType", m_RenderImage.format);
+    if (program->offsetLoc >= 0) {
+        float offset = (sin(m_FrameIndex * MATH_PI / 25) + 1.0f) / 2.0f;
+        glUniform1f(program->offsetLoc, offset);
+    }
+    if (program->texSizeLoc >= 0) {
+        glUniform2f(program->texSizeLoc, pImage->width, pImage->height);
+    }
 
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const void *)0);
 
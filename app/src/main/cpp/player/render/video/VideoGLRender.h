@@ -7,6 +7,9 @@
 #include <thread>
 #include <ImageDef.h>
 #include "VideoRender.h"
+#include "RenderFrameBuffer.h"
+#include "VideoTextureUploader.h"
+#include "VideoProgramCache.h"
 #include <GLES3/gl3.h>
 #include <detail/type_mat.hpp>
 #include <detail/type_mat4x4.hpp>
@@ -22,6 +25,7 @@ class VideoGLRender: public VideoRender, public BaseGLRender{
 public:
     virtual void Init(int videoWidth, int videoHeight, int *dstSize);
     virtual void RenderVideoFrame(NativeImage *pImage);
+    virtual void RenderVideoFrameRef(NativeImage *pImage, AVFrame *frame);
     virtual void UnInit();
 
     virtual void OnSurfaceCreated();
@@ -43,11 +47,14 @@ private:
 
     static std::mutex m_Mutex;
     static VideoGLRender* s_Instance;
-    GLuint m_ProgramObj = GL_NONE;
-    GLuint m_TextureIds[TEXTURE_NUM];
+    VideoProgramCache m_ProgramCache;
+    VideoTextureUploader m_TextureUploader;
     GLuint m_VaoId;
     GLuint m_VboIds[3];
-    NativeImage m_RenderImage;
+    //同步线程与 GL 线程之间的帧交换，不加锁
+    RenderFrameBuffer m_FrameBuffer;
+    //纹理需要重新上传（有新帧或纹理重建）
+    bool m_NeedUpload = false;
     glm::mat4 m_MVPMatrix;
 
     int m_FrameIndex;
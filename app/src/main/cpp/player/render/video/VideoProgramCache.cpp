@@ -0,0 +1,110 @@
+#include <GLUtils.h>
+#include "VideoProgramCache.h"
+
+//各变体公共的声明部分，纹理单元 0/1/2 依次对应 s_texture0/1/2
+#define VIDEO_FRAG_SHADER_HEADER \
+        "#version 300 es\n" \
+        "precision highp float;\n" \
+        "in vec2 v_texCoord;\n" \
+        "layout(location = 0) out vec4 outColor;\n" \
+        "uniform sampler2D s_texture0;\n" \
+        "uniform sampler2D s_texture1;\n" \
+        "uniform sampler2D s_texture2;\n" \
+        "const mat3 c_YuvToRgb = mat3(1.0,    1.0,    1.0,\n" \
+        "                             0.0,   -0.344,  1.770,\n" \
+        "                             1.403, -0.714,  0.0);\n"
+
+static const char fRgbaShaderStr[] =
+        VIDEO_FRAG_SHADER_HEADER
+        "void main()\n"
+        "{\n"
+        "    outColor = texture(s_texture0, v_texCoord);\n"
+        "}";
+
+//UV 平面为 RG 纹理，NV21 的 .r 为 V、.g 为 U
+static const char fNV21ShaderStr[] =
+        VIDEO_FRAG_SHADER_HEADER
+        "void main()\n"
+        "{\n"
+        "    vec3 yuv;\n"
+        "    yuv.x = texture(s_texture0, v_texCoord).r;\n"
+        "    yuv.yz = texture(s_texture1, v_texCoord).gr - 0.5;\n"
+        "    outColor = vec4(c_YuvToRgb * yuv, 1.0);\n"
+        "}";
+
+static const char fNV12ShaderStr[] =
+        VIDEO_FRAG_SHADER_HEADER
+        "void main()\n"
+        "{\n"
+        "    vec3 yuv;\n"
+        "    yuv.x = texture(s_texture0, v_texCoord).r;\n"
+        "    yuv.yz = texture(s_texture1, v_texCoord).rg - 0.5;\n"
+        "    outColor = vec4(c_YuvToRgb * yuv, 1.0);\n"
+        "}";
+
+static const char fI420ShaderStr[] =
+        VIDEO_FRAG_SHADER_HEADER
+        "void main()\n"
+        "{\n"
+        "    vec3 yuv;\n"
+        "    yuv.x = texture(s_texture0, v_texCoord).r;\n"
+        "    yuv.y = texture(s_texture1, v_texCoord).r - 0.5;\n"
+        "    yuv.z = texture(s_texture2, v_texCoord).r - 0.5;\n"
+        "    outColor = vec4(c_YuvToRgb * yuv, 1.0);\n"
+        "}";
+
+//下标为 IMAGE_FORMAT_XXX - 1
+static const char *VIDEO_FRAG_SHADERS[VIDEO_PROGRAM_NUM] = {
+        fRgbaShaderStr,     // IMAGE_FORMAT_RGBA
+        fNV21ShaderStr,     // IMAGE_FORMAT_NV21
+        fNV12ShaderStr,     // IMAGE_FORMAT_NV12
+        fI420ShaderStr      // IMAGE_FORMAT_I420
+};
+
+VideoProgramCache::VideoProgramCache() {
+    memset(m_Programs, 0, sizeof(m_Programs));
+}
+
+int VideoProgramCache::Init(const char *vShaderStr) {
+    //上下文重建后旧程序随上下文失效，直接重新创建
+    int result = 0;
+    for (int i = 0; i < VIDEO_PROGRAM_NUM; ++i) {
+        if (CreateProgram(i, vShaderStr, VIDEO_FRAG_SHADERS[i]) != 0) {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+int VideoProgramCache::CreateProgram(int index, const char *vShaderStr, const char *fShaderStr) {
+    VideoProgram *program = &m_Programs[index];
+    memset(program, 0, sizeof(VideoProgram));
+    program->program = GLUtils::CreateProgram(vShaderStr, fShaderStr);
+    if (program->program == GL_NONE) {
+        LOGCATE("VideoProgramCache::CreateProgram format=%d fail", index + 1);
+        return -1;
+    }
+
+    program->mvpMatrixLoc = glGetUniformLocation(program->program, "u_MVPMatrix");
+    program->texSizeLoc = glGetUniformLocation(program->program, "u_TexSize");
+    program->offsetLoc = glGetUniformLocation(program->program, "u_Offset");
+
+    //采样器与纹理单元的对应关系固定，链接后设置一次即可
+    glUseProgram(program->program);
+    char samplerName[16];
+    for (int i = 0; i < 3; ++i) {
+        sprintf(samplerName, "s_texture%d", i);
+        GLint samplerLoc = glGetUniformLocation(program->program, samplerName);
+        if (samplerLoc >= 0) glUniform1i(samplerLoc, i);
+    }
+    glUseProgram(GL_NONE);
+    return 0;
+}
+
+VideoProgram *VideoProgramCache::GetProgram(int imageFormat) {
+    if (imageFormat < IMAGE_FORMAT_RGBA || imageFormat > IMAGE_FORMAT_I420) {
+        return nullptr;
+    }
+    VideoProgram *program = &m_Programs[imageFormat - 1];
+    return program->program != GL_NONE ? program : nullptr;
+}
@@ -0,0 +1,41 @@
+#ifndef LEARNFFMPEG_VIDEOPROGRAMCACHE_H
+#define LEARNFFMPEG_VIDEOPROGRAMCACHE_H
+
+#include <GLES3/gl3.h>
+#include <ImageDef.h>
+
+//按像素格式区分的着色器程序个数，下标为 IMAGE_FORMAT_XXX - 1
+#define VIDEO_PROGRAM_NUM 4
+
+//链接后解析好的程序和 uniform 位置，位置为 -1 表示着色器中没有该 uniform
+struct VideoProgram {
+    GLuint program;
+    GLint mvpMatrixLoc;     // u_MVPMatrix
+    GLint texSizeLoc;       // u_TexSize，特效着色器使用
+    GLint offsetLoc;        // u_Offset，特效着色器使用
+};
+
+/**
+ * 视频渲染着色器程序缓存，仅在 GL 线程中使用。
+ * 每种像素格式（RGBA/NV21/NV12/I420）一个片段着色器变体，不在像素级按格式分支；
+ * GL 上下文创建时全部编译链接，同时解析 uniform 位置并设置好采样器对应的纹理单元，
+ * 每帧只需 glUseProgram 和少量 glUniform* 调用。
+ */
+class VideoProgramCache {
+public:
+    VideoProgramCache();
+
+    //GL 上下文创建后调用，所有变体共用 vShaderStr，成功返回 0
+    int Init(const char *vShaderStr);
+
+    //不支持的格式或程序创建失败时返回 nullptr
+    VideoProgram *GetProgram(int imageFormat);
+
+private:
+    int CreateProgram(int index, const char *vShaderStr, const char *fShaderStr);
+
+    VideoProgram m_Programs[VIDEO_PROGRAM_NUM];
+};
+
+
+#endif //LEARNFFMPEG_VIDEOPROGRAMCACHE_H
@@ -8,9 +8,14 @@
 #define VIDEO_RENDER_OPENGL             0
 #define VIDEO_RENDER_ANWINDOW           1
 #define VIDEO_RENDER_3D_VR              2
+#define VIDEO_RENDER_HEADLESS           3
 
 #include "ImageDef.h"
 
+extern "C" {
+#include <libavutil/frame.h>
+};
+
 class VideoRender {
 public:
     VideoRender(int type){
@@ -19,7 +24,13 @@ public:
     virtual ~VideoRender(){}
     virtual void Init(int videoWidth, int videoHeight, int *dstSize) = 0;
     virtual void RenderVideoFrame(NativeImage *pImage) = 0;
+    //frame 为 pImage 各平面所在的引用计数帧，渲染器可以 av_frame_ref 持有它直接读取平面，免去拷贝
+    virtual void RenderVideoFrameRef(NativeImage *pImage, AVFrame *frame) {
+        RenderVideoFrame(pImage);
+    }
     virtual void UnInit() = 0;
+    //YUV 帧的色彩空间和范围（YuvConverter.h 中的 YUV_COLOR_*），仅在 CPU 上做颜色转换的渲染器需要
+    virtual void SetColorSpace(int colorSpace, int colorRange) {}
 
     int GetRenderType() {
         return m_RenderType;
@@ -0,0 +1,180 @@
+#include "VideoTextureUploader.h"
+
+//PBO 中各平面的起始偏移对齐
+#define PBO_PLANE_ALIGN 16
+
+VideoTextureUploader::VideoTextureUploader() {
+    memset(m_TextureIds, 0, sizeof(m_TextureIds));
+    memset(m_PboIds, 0, sizeof(m_PboIds));
+    memset(m_PboSize, 0, sizeof(m_PboSize));
+}
+
+VideoTextureUploader::~VideoTextureUploader() {
+    //纹理和 PBO 属于 GL 上下文，析构时不一定在 GL 线程，随上下文一起释放
+}
+
+void VideoTextureUploader::OnSurfaceCreated() {
+    memset(m_TextureIds, 0, sizeof(m_TextureIds));
+    memset(m_PboSize, 0, sizeof(m_PboSize));
+    glGenBuffers(PBO_RING_SIZE, m_PboIds);
+    m_PboIndex = 0;
+    m_Format = 0;
+    m_Width = 0;
+    m_Height = 0;
+}
+
+int VideoTextureUploader::GetPlaneDesc(NativeImage *pImage, VideoPlaneDesc planes[VIDEO_PLANE_NUM]) {
+    int chromaWidth = pImage->width >> 1;
+    int chromaHeight = pImage->height >> 1;
+    switch (pImage->format) {
+        case IMAGE_FORMAT_RGBA:
+            planes[0] = {GL_RGBA8, GL_RGBA, pImage->width, pImage->height, 4};
+            return 1;
+        case IMAGE_FORMAT_NV21:
+        case IMAGE_FORMAT_NV12:
+            planes[0] = {GL_R8, GL_RED, pImage->width, pImage->height, 1};
+            planes[1] = {GL_RG8, GL_RG, chromaWidth, chromaHeight, 2};
+            return 2;
+        case IMAGE_FORMAT_I420:
+            planes[0] = {GL_R8, GL_RED, pImage->width, pImage->height, 1};
+            planes[1] = {GL_R8, GL_RED, chromaWidth, chromaHeight, 1};
+            planes[2] = {GL_R8, GL_RED, chromaWidth, chromaHeight, 1};
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+//源数据行宽，未设置时按紧凑排列处理
+static int GetSrcLineSize(NativeImage *pImage, int index, VideoPlaneDesc *plane) {
+    return pImage->pLineSize[index] > 0 ? pImage->pLineSize[index] : plane->width * plane->bytesPerPixel;
+}
+
+void VideoTextureUploader::UpdateTextureStorage(NativeImage *pImage, VideoPlaneDesc *planes, int planeNum) {
+    if (m_TextureIds[0] != GL_NONE && m_Format == pImage->format && m_Width == pImage->width && m_Height == pImage->height) {
+        return;
+    }
+    LOGCATE("VideoTextureUploader::UpdateTextureStorage format=%d, [w,h]=[%d, %d]", pImage->format, pImage->width, pImage->height);
+
+    //不可变存储不能改尺寸，分辨率或格式变化时重建纹理
+    if (m_TextureIds[0] != GL_NONE) {
+        glDeleteTextures(VIDEO_PLANE_NUM, m_TextureIds);
+    }
+    glGenTextures(VIDEO_PLANE_NUM, m_TextureIds);
+    for (int i = 0; i < VIDEO_PLANE_NUM; ++i) {
+        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (i < planeNum) {
+            glTexStorage2D(GL_TEXTURE_2D, 1, planes[i].internalFormat, planes[i].width, planes[i].height);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, GL_NONE);
+
+    m_Format = pImage->format;
+    m_Width = pImage->width;
+    m_Height = pImage->height;
+}
+
+int VideoTextureUploader::Upload(NativeImage *pImage) {
+    VideoPlaneDesc planes[VIDEO_PLANE_NUM];
+    int planeNum = GetPlaneDesc(pImage, planes);
+    if (planeNum == 0 || pImage->width <= 1 || pImage->height <= 1) {
+        LOGCAT_RATE_LIMIT(LOGCATE, 1000, "VideoTextureUploader::Upload unsupported image format=%d, [w,h]=[%d, %d]",
+                          pImage->format, pImage->width, pImage->height);
+        return -1;
+    }
+
+    UpdateTextureStorage(pImage, planes, planeNum);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (UploadFromPbo(pImage, planes, planeNum) != 0) {
+        UploadFromClient(pImage, planes, planeNum);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, GL_NONE);
+    return 0;
+}
+
+int VideoTextureUploader::UploadFromPbo(NativeImage *pImage, VideoPlaneDesc *planes, int planeNum) {
+    if (m_PboIds[0] == GL_NONE) return -1;
+
+    //行宽能整除像素字节数时整块拷贝并用 GL_UNPACK_ROW_LENGTH 跳过行尾填充，否则逐行拷成紧凑排列
+    int dstLineSize[VIDEO_PLANE_NUM];
+    int dstOffset[VIDEO_PLANE_NUM];
+    int totalSize = 0;
+    for (int i = 0; i < planeNum; ++i) {
+        int srcLineSize = GetSrcLineSize(pImage, i, &planes[i]);
+        int rowBytes = planes[i].width * planes[i].bytesPerPixel;
+        dstLineSize[i] = srcLineSize % planes[i].bytesPerPixel == 0 ? srcLineSize : rowBytes;
+        dstOffset[i] = totalSize;
+        //最后一行只拷贝有效像素，不读源缓冲末尾之外的数据
+        totalSize += dstLineSize[i] * (planes[i].height - 1) + rowBytes;
+        totalSize = (totalSize + PBO_PLANE_ALIGN - 1) & ~(PBO_PLANE_ALIGN - 1);
+    }
+
+    int index = m_PboIndex;
+    m_PboIndex = (m_PboIndex + 1) % PBO_RING_SIZE;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PboIds[index]);
+    if (m_PboSize[index] < totalSize) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        m_PboSize[index] = totalSize;
+    }
+
+    //INVALIDATE 告诉驱动不需要保留旧内容，GPU 仍在读取该 PBO 时驱动可以换一块存储而不是等待
+    uint8_t *pDst = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize,
+                                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (pDst == nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+        return -1;
+    }
+
+    for (int i = 0; i < planeNum; ++i) {
+        int srcLineSize = GetSrcLineSize(pImage, i, &planes[i]);
+        int rowBytes = planes[i].width * planes[i].bytesPerPixel;
+        uint8_t *pSrc = pImage->ppPlane[i];
+        uint8_t *pPlaneDst = pDst + dstOffset[i];
+        if (dstLineSize[i] == srcLineSize) {
+            memcpy(pPlaneDst, pSrc, srcLineSize * (planes[i].height - 1) + rowBytes);
+        } else {
+            for (int y = 0; y < planes[i].height; ++y) {
+                memcpy(pPlaneDst + y * dstLineSize[i], pSrc + y * srcLineSize, rowBytes);
+            }
+        }
+    }
+
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+        return -1;
+    }
+
+    //绑定 PBO 时最后一个参数是缓冲内的偏移，调用立即返回，传输由 GPU 异步完成
+    for (int i = 0; i < planeNum; ++i) {
+        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, dstLineSize[i] / planes[i].bytesPerPixel);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[i].width, planes[i].height, planes[i].format,
+                        GL_UNSIGNED_BYTE, reinterpret_cast<const void *>(static_cast<intptr_t>(dstOffset[i])));
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+    return 0;
+}
+
+void VideoTextureUploader::UploadFromClient(NativeImage *pImage, VideoPlaneDesc *planes, int planeNum) {
+    for (int i = 0; i < planeNum; ++i) {
+        int srcLineSize = GetSrcLineSize(pImage, i, &planes[i]);
+        glBindTexture(GL_TEXTURE_2D, m_TextureIds[i]);
+        if (srcLineSize % planes[i].bytesPerPixel == 0) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, srcLineSize / planes[i].bytesPerPixel);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[i].width, planes[i].height, planes[i].format,
+                            GL_UNSIGNED_BYTE, pImage->ppPlane[i]);
+        } else {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            for (int y = 0; y < planes[i].height; ++y) {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, planes[i].width, 1, planes[i].format,
+                                GL_UNSIGNED_BYTE, pImage->ppPlane[i] + y * srcLineSize);
+            }
+        }
+    }
+}
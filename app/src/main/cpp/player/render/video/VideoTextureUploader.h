@@ -0,0 +1,62 @@
+#ifndef LEARNFFMPEG_VIDEOTEXTUREUPLOADER_H
+#define LEARNFFMPEG_VIDEOTEXTUREUPLOADER_H
+
+#include <GLES3/gl3.h>
+#include <ImageDef.h>
+
+#define VIDEO_PLANE_NUM     3
+#define PBO_RING_SIZE       3   // 像素缓冲环，CPU 写当前 PBO 时 GPU 仍可从前几个 PBO 读取
+
+//单个平面对应的纹理参数
+struct VideoPlaneDesc {
+    GLenum internalFormat;  // 纹理存储格式 GL_R8/GL_RG8/GL_RGBA8
+    GLenum format;          // 上传数据格式 GL_RED/GL_RG/GL_RGBA
+    int width;
+    int height;
+    int bytesPerPixel;
+};
+
+/**
+ * 视频帧纹理上传，仅在 GL 线程中使用。
+ * 纹理用 glTexStorage2D 分配不可变存储，只在分辨率或像素格式变化时重建，每帧用 glTexSubImage2D 更新；
+ * 数据先拷入 PBO 环中的一个缓冲，再由 GPU 从 PBO 异步传输到纹理，CPU 拷贝下一帧时不必等待上一帧的传输完成。
+ * 纹理单元与着色器约定一致：RGBA 用 0，NV12/NV21 的 Y、UV 用 0、1，I420 的 Y、U、V 用 0、1、2。
+ * UV 平面为 GL_RG8，着色器中用 .r/.g 分别取 U、V（NV21 相反）。
+ */
+class VideoTextureUploader {
+public:
+    VideoTextureUploader();
+    ~VideoTextureUploader();
+
+    //GL 上下文创建后调用，上下文重建后旧对象随上下文失效，不需要删除
+    void OnSurfaceCreated();
+
+    //上传一帧，成功返回 0
+    int Upload(NativeImage *pImage);
+
+    GLuint GetTextureId(int index) {
+        return m_TextureIds[index];
+    }
+
+    static int GetPlaneDesc(NativeImage *pImage, VideoPlaneDesc planes[VIDEO_PLANE_NUM]);
+
+private:
+    void UpdateTextureStorage(NativeImage *pImage, VideoPlaneDesc *planes, int planeNum);
+
+    int UploadFromPbo(NativeImage *pImage, VideoPlaneDesc *planes, int planeNum);
+
+    void UploadFromClient(NativeImage *pImage, VideoPlaneDesc *planes, int planeNum);
+
+    GLuint m_TextureIds[VIDEO_PLANE_NUM];
+    GLuint m_PboIds[PBO_RING_SIZE];
+    int m_PboSize[PBO_RING_SIZE];
+    int m_PboIndex = 0;
+
+    //当前纹理存储对应的帧参数
+    int m_Format = 0;
+    int m_Width = 0;
+    int m_Height = 0;
+};
+
+
+#endif //LEARNFFMPEG_VIDEOTEXTUREUPLOADER_H
@@ -0,0 +1,85 @@
+#include <stdlib.h>
+#include <LogUtil.h>
+#include "Clock.h"
+
+Clock::Clock() {
+    m_Speed = 1.0;
+    m_Paused = false;
+    Reset();
+}
+
+void Clock::Reset() {
+    unique_lock<mutex> lock(m_Mutex);
+    m_Pts = AV_NOPTS_VALUE;
+    m_PtsDrift = 0;
+    m_LastUpdated = GetSysCurrentTimeUs();
+}
+
+int64_t Clock::GetClockLocked(int64_t now) {
+    if (m_Pts == AV_NOPTS_VALUE) {
+        return AV_NOPTS_VALUE;
+    }
+    if (m_Paused) {
+        return m_Pts;
+    }
+    return m_PtsDrift + now - (int64_t) ((now - m_LastUpdated) * (1.0 - m_Speed));
+}
+
+int64_t Clock::GetClock() {
+    unique_lock<mutex> lock(m_Mutex);
+    return GetClockLocked(GetSysCurrentTimeUs());
+}
+
+void Clock::SetClockAt(int64_t pts, int64_t time) {
+    unique_lock<mutex> lock(m_Mutex);
+    m_Pts = pts;
+    m_LastUpdated = time;
+    m_PtsDrift = pts - time;
+}
+
+void Clock::SetClock(int64_t pts) {
+    SetClockAt(pts, GetSysCurrentTimeUs());
+}
+
+void Clock::SetSpeed(double speed) {
+    int64_t now = GetSysCurrentTimeUs();
+    unique_lock<mutex> lock(m_Mutex);
+    int64_t pts = GetClockLocked(now);
+    m_Speed = speed;
+    if (pts != AV_NOPTS_VALUE) {
+        m_Pts = pts;
+        m_LastUpdated = now;
+        m_PtsDrift = pts - now;
+    }
+}
+
+double Clock::GetSpeed() {
+    unique_lock<mutex> lock(m_Mutex);
+    return m_Speed;
+}
+
+void Clock::SetPaused(bool paused) {
+    int64_t now = GetSysCurrentTimeUs();
+    unique_lock<mutex> lock(m_Mutex);
+    if (m_Paused == paused) {
+        return;
+    }
+    if (m_Pts != AV_NOPTS_VALUE) {
+        //暂停时冻结当前值，恢复时以当前时刻为起点继续走
+        m_Pts = GetClockLocked(now);
+        m_LastUpdated = now;
+        m_PtsDrift = m_Pts - now;
+    }
+    m_Paused = paused;
+}
+
+void Clock::SyncTo(Clock *master) {
+    int64_t masterClock = master->GetClock();
+    if (masterClock == AV_NOPTS_VALUE) {
+        return;
+    }
+    int64_t clock = GetClock();
+    if (clock == AV_NOPTS_VALUE || llabs(clock - masterClock) > AV_NOSYNC_THRESHOLD) {
+        SetClock(masterClock);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef LEARNFFMPEG_CLOCK_H
+#define LEARNFFMPEG_CLOCK_H
+
+#include <mutex>
+
+extern "C" {
+#include <libavutil/avutil.h>
+};
+
+using namespace std;
+
+//主时钟类型
+enum AVSyncType {
+    AV_SYNC_AUDIO_MASTER,   // 视频向音频同步（默认）
+    AV_SYNC_VIDEO_MASTER,   // 以视频为准，视频帧不丢弃
+    AV_SYNC_EXTERNAL_CLOCK  // 以系统时钟为准
+};
+
+//时钟与主时钟偏差超过该值（us）时直接对齐
+#define AV_NOSYNC_THRESHOLD (10 * 1000 * 1000)
+
+/**
+ * 播放时钟，单位 us。
+ * 记录最近一次设置的 pts 以及设置时刻的系统单调时间（GetSysCurrentTimeUs），读取时按流逝时间和速度外推：
+ * clock = pts + (now - lastUpdated) * speed
+ */
+class Clock {
+public:
+    Clock();
+
+    // 清空时钟，GetClock 返回 AV_NOPTS_VALUE
+    void Reset();
+
+    // 当前时钟值，未设置时返回 AV_NOPTS_VALUE
+    int64_t GetClock();
+
+    void SetClockAt(int64_t pts, int64_t time);
+
+    void SetClock(int64_t pts);
+
+    void SetSpeed(double speed);
+
+    double GetSpeed();
+
+    // 暂停时冻结时钟，恢复时从冻结值继续
+    void SetPaused(bool paused);
+
+    // 时钟未设置或与 master 偏差过大时对齐到 master
+    void SyncTo(Clock *master);
+
+private:
+    int64_t GetClockLocked(int64_t now);
+
+    mutex m_Mutex;
+    int64_t m_Pts;          // 最近一次设置的时钟值
+    int64_t m_PtsDrift;     // m_Pts - m_LastUpdated
+    int64_t m_LastUpdated;  // 最近一次设置时的系统单调时间
+    double m_Speed;
+    bool m_Paused;
+};
+
+
+#endif //LEARNFFMPEG_CLOCK_H
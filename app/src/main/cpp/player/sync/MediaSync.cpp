@@ -2,6 +2,8 @@
 // Created by 字节流动 on 2020/10/16.
 //
 
+#include <TraceRecorder.h>
+#include <YuvConverter.h>
 #include "MediaSync.h"
 
 MediaSync::MediaSync(PlayerState *playerState, VideoMediaDecoder *videoMediaDecoder,
@@ -18,7 +20,8 @@ MediaSync::~MediaSync() {
 }
 
 void MediaSync::Start() {
-    if (m_Thread == nullptr) {
+    //纯音频文件不需要视频同步线程
+    if (m_Thread == nullptr && m_VideoDecoder != nullptr) {
         m_Thread = new thread(DoAVSync, this);
     }
 }
@@ -36,6 +39,7 @@ void MediaSync::SetVideoRender(VideoRender *videoRender) {
 }
 
 void MediaSync::DoAVSync(MediaSync *mediaSync) {
+    TRACE_THREAD_NAME("sync");
     if(mediaSync != nullptr)
         mediaSync->Run();
 }
@@ -43,58 +47,108 @@ void MediaSync::DoAVSync(MediaSync *mediaSync) {
 void MediaSync::Run() {
     InitVideoRender();
 
+    AVFrameQueue *frameQueue = m_VideoDecoder->GetFrameQueue();
     for (;;) {
 
         if (m_PlayerState->m_AbortRequest) {
             break;
         }
 
-        AVFrameQueue *frameQueue = m_VideoDecoder->GetFrameQueue();
-        unique_lock<mutex> lock(frameQueue->GetQueueMutex());
-        if (!m_PlayerState->m_SeekRequest && m_VideoDecoder->GetFrameQueueSize() > 0) {
-            int64_t baseTimestamp = m_PlayerState->m_CurTimestamp;
-            Frame *curFrame = m_VideoDecoder->GetFrameQueue()->FrontFrame();
-            int64_t curTimestamp = curFrame->pts;
-            int delayTime =  baseTimestamp - curTimestamp;
-            if(delayTime > AV_SYNC_THRESHOLD) {
-                m_VideoDecoder->GetFrameQueue()->PopFrame();
-                lock.unlock();
-                if(delayTime > 200)
-                    m_VideoDecoder->GetFrameQueue()->Flush();
-                continue;
-            }
+        //暂停时等待状态变化，不轮询；seek 不阻塞同步线程，过期帧按序号丢弃
+        if (m_PlayerState->m_PauseRequest) {
+            unique_lock<mutex> stateLock(m_PlayerState->m_StateMutex);
+            m_PlayerState->m_StateCond.wait(stateLock, [this] {
+                return m_PlayerState->m_AbortRequest || !m_PlayerState->m_PauseRequest;
+            });
+            continue;
+        }
 
-            while (!(frameQueue->FlushRequest()) && curTimestamp > baseTimestamp && (!m_PlayerState->m_AbortRequest)) {
-                int sleepTime = curTimestamp - baseTimestamp;
-                sleepTime = sleepTime > AV_SYNC_THRESHOLD ? AV_SYNC_THRESHOLD : sleepTime;
-                av_usleep(sleepTime * 1000);
-                if(baseTimestamp < m_PlayerState->m_CurTimestamp)
-                {
-                    baseTimestamp = m_PlayerState->m_CurTimestamp;
-                }
-                else {
-                    break;//
-                }
-            }
+        //队列为空时阻塞，解码线程入队或队列终止时唤醒；只有本线程出队，取到的帧在 PopFrame 之前一直有效
+        Frame *curFrame = nullptr;
+        {
+            TRACE_SCOPE("wait frame");
+            curFrame = frameQueue->PeekReadable();
+        }
+        if (curFrame == nullptr) {
+            break;
+        }
+
+        //seek 之前解出的帧
+        if (curFrame->serial != m_VideoDecoder->GetSerial()) {
+            frameQueue->PopFrame();
+            continue;
+        }
+
+        if (m_PlayerState->m_FreeRun) {
+            //不做同步，有帧即渲染，用于测量流水线吞吐
+            RenderVideo(curFrame->frame);
+            frameQueue->PopFrame();
+            continue;
+        }
 
-            if(!(frameQueue->FlushRequest())) {
-                RenderVideo(curFrame->frame);
-                m_VideoDecoder->GetFrameQueue()->PopFrame();
+        int64_t curTimestamp = curFrame->pts;
+        //主时钟尚未建立（如音频第一帧还未送出）或拖动进度条 seek 后的第一帧直接显示
+        int64_t masterClock = curFrame->immediate ? AV_NOPTS_VALUE : GetMasterClock();
+        int64_t delayTime = masterClock != AV_NOPTS_VALUE ? curTimestamp - masterClock : 0;
+        if (masterClock != AV_NOPTS_VALUE && m_PlayerState->GetMasterSyncType() != AV_SYNC_VIDEO_MASTER) {
+            //落后程度反馈给解码器，持续落后时在解码阶段就跳过帧，而不是解码完再丢
+            m_VideoDecoder->ReportLateness(-delayTime);
+        }
+        if (delayTime < -AV_SYNC_THRESHOLD && m_PlayerState->GetMasterSyncType() != AV_SYNC_VIDEO_MASTER) {
+            //视频落后太多，丢帧追赶
+            frameQueue->PopFrame();
+            m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_DROPPED_VIDEO_FRAMES);
+            if (delayTime < -AV_SYNC_FLUSH_THRESHOLD)
+                frameQueue->Flush();
+            continue;
+        }
+
+        if (delayTime > 0) {
+            //等待到该帧的显示时刻，状态改变时提前唤醒并重新评估
+            int64_t waitTime = delayTime > AV_SYNC_MAX_WAIT ? AV_SYNC_MAX_WAIT : delayTime;
+            if (!WaitForPresentTime(waitTime, curFrame->serial) || waitTime < delayTime) {
+                continue;
             }
-            lock.unlock();
+        }
 
-            while (m_PlayerState->m_PauseRequest && (!m_PlayerState->m_AbortRequest)) {
-                usleep(5 * 1000);
+        if (curFrame->serial == m_VideoDecoder->GetSerial()) {
+            RenderVideo(curFrame->frame);
+            m_PlayerState->m_VideoClock.SetClock(curTimestamp);
+            m_PlayerState->m_ExternalClock.SyncTo(&m_PlayerState->m_VideoClock);
+            if (m_AudioDecoder == nullptr) {
+                //无音频时视频帧时间戳作为当前播放位置
+                m_PlayerState->m_CurTimestamp = curTimestamp / 1000;
             }
-        } else {
-            lock.unlock();
-            usleep(5 * 1000);//休眠 5 ms 继续检查队列是否有数据
         }
+        frameQueue->PopFrame();
     }
 
     UnInitVideoRender();
 }
 
+/**
+ * 在单调时钟上精确等待 waitTimeUs
+ * @param serial 待显示帧的序号，seek 完成（序号改变）时提前返回
+ * @return true 等待到期，false 被暂停、seek、停止打断
+ */
+bool MediaSync::WaitForPresentTime(int64_t waitTimeUs, int serial) {
+    TRACE_SCOPE("wait present time");
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::microseconds(waitTimeUs);
+    unique_lock<mutex> stateLock(m_PlayerState->m_StateMutex);
+    bool interrupted = m_PlayerState->m_StateCond.wait_until(stateLock, deadline, [this, serial] {
+        return m_PlayerState->m_AbortRequest || m_PlayerState->m_PauseRequest
+               || serial != m_VideoDecoder->GetSerial();
+    });
+    return !interrupted;
+}
+
+/**
+ * 主时钟 us，由 PlayerState 按同步类型选择音频、视频或外部时钟，未建立时返回 AV_NOPTS_VALUE
+ */
+int64_t MediaSync::GetMasterClock() {
+    return m_PlayerState->GetMasterClock();
+}
+
 void MediaSync::InitVideoRender() {
     LOGCATE("MediaSync::InitVideoRender");
     if(m_VideoDecoder != nullptr && m_VideoRender != nullptr) {
@@ -106,15 +160,25 @@ void MediaSync::InitVideoRender() {
             m_VideoRender->Init(m_VideoWidth, m_VideoHeight, dstSize);
             m_RenderWidth = dstSize[0];
             m_RenderHeight = dstSize[1];
-            m_RGBAFrame = av_frame_alloc();
-            int bufferSize = av_image_get_buffer_size(DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
-            m_FrameBuffer = (uint8_t *) av_malloc(bufferSize * sizeof(uint8_t));
-            av_image_fill_arrays(m_RGBAFrame->data, m_RGBAFrame->linesize,
-                                 m_FrameBuffer, DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
-
-            m_SwsContext = sws_getContext(m_VideoWidth, m_VideoHeight, m_VideoDecoder->GetCodecContext()->pix_fmt,
-                                          m_RenderWidth, m_RenderHeight, DST_PIXEL_FORMAT,
-                                          SWS_FAST_BILINEAR, NULL, NULL, NULL);
+            AVCodecContext *avCodecContext = m_VideoDecoder->GetCodecContext();
+            int colorSpace = avCodecContext->colorspace == AVCOL_SPC_BT709
+                    || (avCodecContext->colorspace == AVCOL_SPC_UNSPECIFIED && m_VideoHeight >= 720)
+                    ? YUV_COLOR_SPACE_BT709 : YUV_COLOR_SPACE_BT601;
+            int colorRange = avCodecContext->color_range == AVCOL_RANGE_JPEG || avCodecContext->pix_fmt == AV_PIX_FMT_YUVJ420P
+                    ? YUV_COLOR_RANGE_FULL : YUV_COLOR_RANGE_LIMITED;
+            m_VideoRender->SetColorSpace(colorSpace, colorRange);
+
+            if(GetImageFormat(avCodecContext->pix_fmt) == 0) {
+                m_RGBAFrame = av_frame_alloc();
+                int bufferSize = av_image_get_buffer_size(DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
+                m_FrameBuffer = (uint8_t *) av_malloc(bufferSize * sizeof(uint8_t));
+                av_image_fill_arrays(m_RGBAFrame->data, m_RGBAFrame->linesize,
+                                     m_FrameBuffer, DST_PIXEL_FORMAT, m_RenderWidth, m_RenderHeight, 1);
+
+                m_SwsContext = sws_getContext(m_VideoWidth, m_VideoHeight, avCodecContext->pix_fmt,
+                                              m_RenderWidth, m_RenderHeight, DST_PIXEL_FORMAT,
+                                              SWS_FAST_BILINEAR, NULL, NULL, NULL);
+            }
         }
     }
 }
@@ -141,21 +205,16 @@ void MediaSync::UnInitVideoRender() {
 }
 
 void MediaSync::RenderVideo(AVFrame *frame) {
-    LOGCATE("VideoDecoder::OnFrameAvailable frame=%p", frame);
+    LOGCATT("MediaSync::RenderVideo frame=%p", frame);
     if(m_VideoRender != nullptr && frame != nullptr) {
+        int64_t startTime = GetSysCurrentTimeUs();
         AVCodecContext *avCodecContext = m_VideoDecoder->GetCodecContext();
         NativeImage image;
-        LOGCATE("VideoDecoder::OnFrameAvailable frame[w,h]=[%d, %d],format=%d,[line0,line1,line2]=[%d, %d, %d]", frame->width, frame->height, avCodecContext->pix_fmt, frame->linesize[0], frame->linesize[1],frame->linesize[2]);
-        if(m_VideoRender->GetRenderType() == VIDEO_RENDER_ANWINDOW)
-        {
-            sws_scale(m_SwsContext, frame->data, frame->linesize, 0,
-                      m_VideoHeight, m_RGBAFrame->data, m_RGBAFrame->linesize);
-
-            image.format = IMAGE_FORMAT_RGBA;
-            image.width = m_RenderWidth;
-            image.height = m_RenderHeight;
-            image.ppPlane[0] = m_RGBAFrame->data[0];
-        } else if(avCodecContext->pix_fmt == AV_PIX_FMT_YUV420P || avCodecContext->pix_fmt == AV_PIX_FMT_YUVJ420P) {
+        AVFrame *refFrame = frame;
+        LOGCATT("MediaSync::RenderVideo frame[w,h]=[%d, %d],format=%d,[line0,line1,line2]=[%d, %d, %d]", frame->width, frame->height, avCodecContext->pix_fmt, frame->linesize[0], frame->linesize[1],frame->linesize[2]);
+        //I420/NV12/NV21/RGBA 直接交给渲染器（GL 在着色器中转换，ANativeWindow 由 NativeRender 写入窗口缓冲），
+        //其他格式用 sws_scale 转为 RGBA
+        if(avCodecContext->pix_fmt == AV_PIX_FMT_YUV420P || avCodecContext->pix_fmt == AV_PIX_FMT_YUVJ420P) {
             image.format = IMAGE_FORMAT_I420;
             image.width = frame->width;
             image.height = frame->height;
@@ -192,14 +251,29 @@ void MediaSync::RenderVideo(AVFrame *frame) {
             image.pLineSize[0] = frame->linesize[0];
             image.ppPlane[0] = frame->data[0];
         } else {
+            TRACE_SCOPE("sws_scale");
+            refFrame = nullptr;
             sws_scale(m_SwsContext, frame->data, frame->linesize, 0,
                       m_VideoHeight, m_RGBAFrame->data, m_RGBAFrame->linesize);
             image.format = IMAGE_FORMAT_RGBA;
             image.width = m_RenderWidth;
             image.height = m_RenderHeight;
             image.ppPlane[0] = m_RGBAFrame->data[0];
+            image.pLineSize[0] = m_RGBAFrame->linesize[0];
+        }
+        int64_t renderStartTime = GetSysCurrentTimeUs();
+        m_PlayerState->m_Stats.RecordLatency(PLAYER_STAGE_VIDEO_CONVERT, renderStartTime - startTime);
+        {
+            TRACE_SCOPE("RenderVideoFrame");
+            //解码帧直接交给渲染器持有，sws_scale 的输出缓冲会被下一帧覆盖，只能拷贝
+            if (refFrame != nullptr) {
+                m_VideoRender->RenderVideoFrameRef(&image, refFrame);
+            } else {
+                m_VideoRender->RenderVideoFrame(&image);
+            }
         }
-        m_VideoRender->RenderVideoFrame(&image);
         m_VideoDecoder->RequestRender();
+        m_PlayerState->m_Stats.Increment(PLAYER_COUNTER_RENDERED_VIDEO_FRAMES);
+        m_PlayerState->m_Stats.RecordLatency(PLAYER_STAGE_VIDEO_RENDER, GetSysCurrentTimeUs() - renderStartTime);
     }
 }
@@ -11,13 +11,18 @@ extern "C" {
 #include <libavutil/frame.h>
 }
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <render/video/VideoRender.h>
 #include <decoder/VideoMediaDecoder.h>
 #include <decoder/AudioMediaDecoder.h>
 
 using namespace std;
 
-#define AV_SYNC_THRESHOLD 25 //同步阈值设为 25 ms
+#define AV_SYNC_THRESHOLD       (25 * 1000)     //同步阈值 25 ms，单位 us
+#define AV_SYNC_FLUSH_THRESHOLD (200 * 1000)    //落后超过 200 ms 时清空帧队列，单位 us
+#define AV_SYNC_MAX_WAIT        (1000 * 1000)   //单次最长等待 1 s，防止时间戳异常时长时间阻塞，单位 us
 
 class MediaSync {
 public:
@@ -32,6 +37,8 @@ public:
 private:
     static void DoAVSync(MediaSync *mediaSync);
     void Run();
+    bool WaitForPresentTime(int64_t waitTimeUs, int serial);
+    int64_t GetMasterClock();
     void InitVideoRender();
     void UnInitVideoRender();
     void RenderVideo(AVFrame *frame);
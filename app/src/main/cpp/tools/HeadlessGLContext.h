@@ -0,0 +1,95 @@
+#ifndef LEARNFFMPEG_HEADLESSGLCONTEXT_H
+#define LEARNFFMPEG_HEADLESSGLCONTEXT_H
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#include <stdio.h>
+
+//Mesa surfaceless 平台上不需要窗口系统，llvmpipe 软件渲染即可跑 GL 渲染路径的测试
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+//无此平台或创建上下文失败时测试以该返回码退出，ctest 记为跳过
+#define HEADLESS_GL_SKIP 77
+
+/**
+ * 桌面 Linux 上的离屏 GLES 3.0 上下文，渲染目标为 width x height 的 RGBA8 FBO。
+ * 仅供 host 测试使用，Init 所在线程即 GL 线程。
+ */
+class HeadlessGLContext {
+public:
+    ~HeadlessGLContext() {
+        UnInit();
+    }
+
+    //成功返回 0
+    int Init(int width, int height) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay == nullptr) {
+            fprintf(stderr, "HeadlessGLContext::Init eglGetPlatformDisplayEXT unavailable\n");
+            return -1;
+        }
+        m_Display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (m_Display == EGL_NO_DISPLAY || !eglInitialize(m_Display, nullptr, nullptr)) {
+            fprintf(stderr, "HeadlessGLContext::Init no surfaceless display\n");
+            m_Display = EGL_NO_DISPLAY;
+            return -1;
+        }
+        eglBindAPI(EGL_OPENGL_ES_API);
+
+        EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR, EGL_NONE};
+        EGLConfig config = nullptr;
+        EGLint configNum = 0;
+        eglChooseConfig(m_Display, configAttribs, &config, 1, &configNum);
+        EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+        m_Context = eglCreateContext(m_Display, configNum > 0 ? config : nullptr, EGL_NO_CONTEXT, contextAttribs);
+        if (m_Context == EGL_NO_CONTEXT || !eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context)) {
+            fprintf(stderr, "HeadlessGLContext::Init create context fail, eglError=0x%x\n", eglGetError());
+            return -1;
+        }
+        fprintf(stderr, "HeadlessGLContext::Init GL_RENDERER=%s, GL_VERSION=%s\n",
+                glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+        glGenRenderbuffers(1, &m_ColorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_ColorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glGenFramebuffers(1, &m_Fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorBuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            fprintf(stderr, "HeadlessGLContext::Init framebuffer incomplete\n");
+            return -1;
+        }
+        glViewport(0, 0, width, height);
+        return 0;
+    }
+
+    void UnInit() {
+        if (m_Display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_Context != EGL_NO_CONTEXT) {
+            eglDestroyContext(m_Display, m_Context);
+            m_Context = EGL_NO_CONTEXT;
+        }
+        eglTerminate(m_Display);
+        m_Display = EGL_NO_DISPLAY;
+        m_Fbo = GL_NONE;
+        m_ColorBuffer = GL_NONE;
+    }
+
+    GLuint GetFbo() {
+        return m_Fbo;
+    }
+
+private:
+    EGLDisplay m_Display = EGL_NO_DISPLAY;
+    EGLContext m_Context = EGL_NO_CONTEXT;
+    GLuint m_Fbo = GL_NONE;
+    GLuint m_ColorBuffer = GL_NONE;
+};
+
+
+#endif //LEARNFFMPEG_HEADLESSGLCONTEXT_H
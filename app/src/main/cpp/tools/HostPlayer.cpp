@@ -0,0 +1,77 @@
+// 桌面 Linux 上的无界面播放器：用 HeadlessRender + WavFileRender 跑通
+// 解封装 -> 解码 -> 同步 -> 渲染 的完整链路，便于 perf/valgrind 分析。
+// WavFileRender 按实时速率节流并报告缓冲量，默认的音频主时钟同步与设备上行为一致。
+//
+// usage: host-player <url> [-v video.yuv] [-a audio.wav] [-t trace.json]
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <condition_variable>
+#include <MediaPlayer.h>
+#include <TraceRecorder.h>
+#include <render/video/HeadlessRender.h>
+#include <render/audio/WavFileRender.h>
+
+static mutex s_Mutex;
+static condition_variable s_Cond;
+static bool s_PlayerDone = false;
+
+static void OnPlayerMessage(void *context, int msgType, float msgCode) {
+    if(msgType == PLAYER_MSG_PLAYER_DONE) {
+        unique_lock<mutex> lock(s_Mutex);
+        s_PlayerDone = true;
+        s_Cond.notify_all();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s <url> [-v video.yuv] [-a audio.wav] [-t trace.json]\n", argv[0]);
+        return 1;
+    }
+
+    const char *url = argv[1];
+    const char *videoOutPath = nullptr;
+    const char *audioOutPath = nullptr;
+    const char *tracePath = nullptr;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if(strcmp(argv[i], "-v") == 0) {
+            videoOutPath = argv[i + 1];
+        } else if(strcmp(argv[i], "-a") == 0) {
+            audioOutPath = argv[i + 1];
+        } else if(strcmp(argv[i], "-t") == 0) {
+            tracePath = argv[i + 1];
+        }
+    }
+
+    TraceRecorder::GetInstance()->SetEnabled(tracePath != nullptr);
+
+    HeadlessRender videoRender(videoOutPath);
+    WavFileRender audioRender(audioOutPath, AUDIO_DST_SAMPLE_RATE, AUDIO_DST_CHANNEL_COUNTS, 16);
+
+    MediaPlayer player;
+    player.SetMessageCallback(nullptr, OnPlayerMessage);
+    player.SetPlayerOption(PLAYER_OPTION_LOOP, 0);
+    player.SetPlayerOption(PLAYER_OPTION_AUTO_EXIT, 1);
+    player.Init(url, &videoRender, &audioRender);
+    player.Play();
+
+    {
+        unique_lock<mutex> lock(s_Mutex);
+        while (!s_PlayerDone) {
+            s_Cond.wait(lock);
+        }
+    }
+
+    player.UnInit();
+
+    if(tracePath != nullptr) {
+        TraceRecorder::GetInstance()->DumpChromeTrace(tracePath);
+    }
+
+    fprintf(stdout, "%s: %ld video frames rendered, %lld audio bytes rendered\n",
+            url, videoRender.GetFrameCount(), (long long) audioRender.GetDataSize());
+    return 0;
+}
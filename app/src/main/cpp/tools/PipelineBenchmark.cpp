@@ -0,0 +1,232 @@
+// 解封装 -> 解码 -> 同步 -> 渲染 流水线吞吐基准测试。
+// 对语料中的每个文件以 free-run 模式（不按时钟等待）跑完整播放器，
+// 渲染端使用丢弃数据的 HeadlessRender/WavFileRender，输出每个文件的
+// 帧率、包率、各阶段单次耗时分位数和峰值内存，结果写成 JSON 便于在 CI 中对比回归。
+//
+// usage: pipeline-benchmark [-o result.json] [-p] <file|dir> [<file|dir> ...]
+//   -p  开启 PLAYER_OPTION_PACKET_POOL，与默认结果对比内存池的收益
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <MediaPlayer.h>
+#include <render/video/HeadlessRender.h>
+#include <render/audio/WavFileRender.h>
+
+struct BenchmarkResult {
+    std::string url;
+    int result = 0;
+    long width = 0;
+    long height = 0;
+    double duration = 0;     // 媒体时长 s
+    double wallTime = 0;     // 实际耗时 s
+    int64_t packets = 0;
+    int64_t videoFrames = 0;
+    long peakRssKb = 0;
+    PlayerStatsSnapshot stats = {};
+};
+
+static mutex s_Mutex;
+static condition_variable s_Cond;
+static bool s_PlayerDone = false;
+
+static void OnPlayerMessage(void *context, int msgType, float msgCode) {
+    if(msgType == PLAYER_MSG_PLAYER_DONE) {
+        unique_lock<mutex> lock(s_Mutex);
+        s_PlayerDone = true;
+        s_Cond.notify_all();
+    }
+}
+
+//重置并读取进程峰值常驻内存（VmHWM），使每个文件的峰值互不影响；
+//写 clear_refs 失败时（老内核）退化为进程启动以来的峰值
+static void ResetPeakRss() {
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if(fp != nullptr) {
+        fputs("5", fp);
+        fclose(fp);
+    }
+}
+
+static long GetPeakRssKb() {
+    long peakKb = -1;
+    char line[256];
+    FILE *fp = fopen("/proc/self/status", "r");
+    if(fp != nullptr) {
+        while (fgets(line, sizeof(line), fp) != nullptr) {
+            if(strncmp(line, "VmHWM:", 6) == 0) {
+                sscanf(line + 6, "%ld", &peakKb);
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    if(peakKb < 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        peakKb = usage.ru_maxrss;
+    }
+    return peakKb;
+}
+
+static void CollectCorpus(const char *path, std::vector<std::string> &corpus) {
+    struct stat st;
+    if(stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path);
+        if(dir == nullptr) return;
+        std::vector<std::string> entries;
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if(entry->d_name[0] == '.') continue;
+            entries.push_back(std::string(path) + "/" + entry->d_name);
+        }
+        closedir(dir);
+        std::sort(entries.begin(), entries.end());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            CollectCorpus(entries[i].c_str(), corpus);
+        }
+    } else {
+        corpus.push_back(path);
+    }
+}
+
+static int RunBenchmark(const char *url, bool usePacketPool, BenchmarkResult *benchmarkResult) {
+    benchmarkResult->url = url;
+
+    HeadlessRender videoRender(nullptr);
+    WavFileRender audioRender(nullptr, AUDIO_DST_SAMPLE_RATE, AUDIO_DST_CHANNEL_COUNTS, 16, false);
+
+    s_PlayerDone = false;
+    ResetPeakRss();
+
+    MediaPlayer player;
+    player.SetMessageCallback(nullptr, OnPlayerMessage);
+    player.SetPlayerOption(PLAYER_OPTION_LOOP, 0);
+    player.SetPlayerOption(PLAYER_OPTION_AUTO_EXIT, 1);
+    player.SetPlayerOption(PLAYER_OPTION_FREE_RUN, 1);
+    player.SetPlayerOption(PLAYER_OPTION_PACKET_POOL, usePacketPool ? 1 : 0);
+
+    int64_t startTime = GetSysCurrentTimeUs();
+    player.Init(url, &videoRender, &audioRender);
+    player.Play();
+
+    {
+        unique_lock<mutex> lock(s_Mutex);
+        while (!s_PlayerDone) {
+            s_Cond.wait(lock);
+        }
+    }
+    benchmarkResult->wallTime = (GetSysCurrentTimeUs() - startTime) / 1000000.0;
+    benchmarkResult->peakRssKb = GetPeakRssKb();
+
+    //播放线程已结束，解码上下文已释放，只有统计数据和时长仍然可读
+    benchmarkResult->duration = player.GetMediaParams(MEDIA_PARAM_VIDEO_DURATION);
+    player.GetStatsSnapshot(&benchmarkResult->stats);
+    benchmarkResult->packets = benchmarkResult->stats.counters[PLAYER_COUNTER_DEMUXED_PACKETS];
+    benchmarkResult->videoFrames = benchmarkResult->stats.counters[PLAYER_COUNTER_DECODED_VIDEO_FRAMES];
+    benchmarkResult->width = videoRender.GetVideoWidth();
+    benchmarkResult->height = videoRender.GetVideoHeight();
+
+    player.UnInit();
+
+    benchmarkResult->result = benchmarkResult->packets > 0 ? 0 : -1;
+    return benchmarkResult->result;
+}
+
+static void WriteJsonString(FILE *fp, const std::string &str) {
+    fputc('"', fp);
+    for (size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        if(c == '"' || c == '\\') {
+            fputc('\\', fp);
+            fputc(c, fp);
+        } else if((unsigned char) c < 0x20) {
+            fprintf(fp, "\\u%04x", c);
+        } else {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void WriteJson(FILE *fp, const std::vector<BenchmarkResult> &results) {
+    fprintf(fp, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        double wallTime = r.wallTime > 0 ? r.wallTime : 1e-6;
+        fprintf(fp, "    {\n      \"file\": ");
+        WriteJsonString(fp, r.url);
+        fprintf(fp, ",\n      \"result\": %d,\n", r.result);
+        fprintf(fp, "      \"width\": %ld,\n      \"height\": %ld,\n", r.width, r.height);
+        fprintf(fp, "      \"media_duration_s\": %.3f,\n      \"wall_time_s\": %.3f,\n", r.duration, r.wallTime);
+        for (int j = 0; j < PLAYER_COUNTER_COUNT; ++j) {
+            fprintf(fp, "      \"%s\": %lld,\n", PlayerStats::GetCounterName(j), (long long) r.stats.counters[j]);
+        }
+        fprintf(fp, "      \"packets_per_sec\": %.2f,\n      \"video_frames_per_sec\": %.2f,\n",
+                r.packets / wallTime, r.videoFrames / wallTime);
+        fprintf(fp, "      \"peak_rss_kb\": %ld,\n", r.peakRssKb);
+        fprintf(fp, "      \"stages_us\": {\n");
+        for (int j = 0; j < PLAYER_STAGE_COUNT; ++j) {
+            const int64_t *stage = r.stats.stages[j];
+            fprintf(fp, "        \"%s\": {\"count\": %lld, \"mean\": %lld, \"p50\": %lld, \"p90\": %lld, \"p99\": %lld, \"max\": %lld}%s\n",
+                    PlayerStats::GetStageName(j), (long long) stage[PLAYER_STAGE_STAT_COUNT], (long long) stage[PLAYER_STAGE_STAT_MEAN],
+                    (long long) stage[PLAYER_STAGE_STAT_P50], (long long) stage[PLAYER_STAGE_STAT_P90], (long long) stage[PLAYER_STAGE_STAT_P99],
+                    (long long) stage[PLAYER_STAGE_STAT_MAX], j + 1 < PLAYER_STAGE_COUNT ? "," : "");
+        }
+        fprintf(fp, "      }\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *outPath = nullptr;
+    bool usePacketPool = false;
+    std::vector<std::string> corpus;
+    for (int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if(strcmp(argv[i], "-p") == 0) {
+            usePacketPool = true;
+        } else {
+            CollectCorpus(argv[i], corpus);
+        }
+    }
+
+    if(corpus.empty()) {
+        fprintf(stderr, "usage: %s [-o result.json] [-p] <file|dir> [<file|dir> ...]\n", argv[0]);
+        return 1;
+    }
+
+    int failCount = 0;
+    std::vector<BenchmarkResult> results;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        BenchmarkResult benchmarkResult;
+        if(RunBenchmark(corpus[i].c_str(), usePacketPool, &benchmarkResult) != 0) {
+            failCount++;
+        }
+        fprintf(stderr, "[%zu/%zu] %s: %.1f video fps, %.1f packets/s, video decode p99 %lld us, peak rss %ld KB\n",
+                i + 1, corpus.size(), corpus[i].c_str(),
+                benchmarkResult.videoFrames / (benchmarkResult.wallTime > 0 ? benchmarkResult.wallTime : 1e-6),
+                benchmarkResult.packets / (benchmarkResult.wallTime > 0 ? benchmarkResult.wallTime : 1e-6),
+                (long long) benchmarkResult.stats.stages[PLAYER_STAGE_VIDEO_DECODE][PLAYER_STAGE_STAT_P99], benchmarkResult.peakRssKb);
+        results.push_back(benchmarkResult);
+    }
+
+    FILE *fp = outPath != nullptr ? fopen(outPath, "w") : stdout;
+    if(fp == nullptr) {
+        fprintf(stderr, "open %s fail\n", outPath);
+        return 1;
+    }
+    WriteJson(fp, results);
+    if(fp != stdout) fclose(fp);
+
+    return failCount == 0 ? 0 : 2;
+}
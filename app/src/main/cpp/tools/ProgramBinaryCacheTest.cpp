@@ -0,0 +1,216 @@
+// GLUtils 程序二进制缓存测试，在 Mesa surfaceless EGL（llvmpipe 软件渲染）上运行：
+// 冷启动未命中并写入缓存文件，再次创建命中，缓存文件被截断或内容损坏时回退到编译并重新写入，
+// 着色器源码不同时使用各自的文件；每次创建的程序都实际绘制一帧校验输出颜色。
+//
+// usage: EGL_PLATFORM=surfaceless program-binary-cache-test
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <GLUtils.h>
+#include "HeadlessGLContext.h"
+
+#define TEST_RENDER_WIDTH   16
+#define TEST_RENDER_HEIGHT  16
+
+static const char vShaderStr[] =
+        "#version 300 es\n"
+        "layout(location = 0) in vec4 a_position;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = a_position;\n"
+        "}";
+
+static const char fShaderStr[] =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "layout(location = 0) out vec4 outColor;\n"
+        "void main()\n"
+        "{\n"
+        "    outColor = vec4(0.2, 0.4, 0.6, 1.0);\n"
+        "}";
+
+//与 fShaderStr 只差输出颜色，缓存键不同
+static const char fShaderStr2[] =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "layout(location = 0) out vec4 outColor;\n"
+        "void main()\n"
+        "{\n"
+        "    outColor = vec4(0.8, 0.6, 0.4, 1.0);\n"
+        "}";
+
+static const int COLOR1[3] = {51, 102, 153};
+static const int COLOR2[3] = {204, 153, 102};
+
+//缓存目录中的 .bin 文件，另外统计残留的 .tmp 文件
+static std::vector<std::string> ListCacheFiles(const std::string &dir, int *tmpCount) {
+    std::vector<std::string> files;
+    *tmpCount = 0;
+    DIR *pDir = opendir(dir.c_str());
+    if (pDir == nullptr) return files;
+    struct dirent *entry;
+    while ((entry = readdir(pDir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0) {
+            files.push_back(dir + "/" + name);
+        } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+            (*tmpCount)++;
+        }
+    }
+    closedir(pDir);
+    return files;
+}
+
+static long GetFileSize(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long) st.st_size : -1;
+}
+
+//用程序绘制全屏矩形，颜色与 expected 一致返回 true
+static bool DrawAndCheck(GLuint program, const int expected[3]) {
+    if (program == 0) return false;
+    GLfloat vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    glUseProgram(program);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    uint8_t pixel[4] = {0};
+    glReadPixels(TEST_RENDER_WIDTH / 2, TEST_RENDER_HEIGHT / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    glUseProgram(GL_NONE);
+    bool match = true;
+    for (int c = 0; c < 3; ++c) {
+        if (abs(pixel[c] - expected[c]) > 1) match = false;
+    }
+    if (!match) {
+        fprintf(stderr, "  pixel=(%d, %d, %d) expected=(%d, %d, %d)\n", pixel[0], pixel[1], pixel[2],
+                expected[0], expected[1], expected[2]);
+    }
+    return match;
+}
+
+class ProgramCacheTest {
+public:
+    ProgramCacheTest(const std::string &dir) : m_Dir(dir) {
+    }
+
+    //创建并绘制一次，检查命中/未命中计数的变化和缓存文件个数
+    void Run(const char *name, const char *fShader, const int color[3], int expectedHit, int expectedMiss, int expectedFiles) {
+        int hit0, miss0, hit1, miss1, tmpCount;
+        GLUtils::GetProgramCacheStats(hit0, miss0);
+        GLuint program = GLUtils::CreateProgram(vShaderStr, fShader);
+        GLUtils::GetProgramCacheStats(hit1, miss1);
+        bool drawn = DrawAndCheck(program, color);
+        std::vector<std::string> files = ListCacheFiles(m_Dir, &tmpCount);
+        GLUtils::DeleteProgram(program);
+
+        bool pass = drawn && hit1 - hit0 == expectedHit && miss1 - miss0 == expectedMiss
+                    && (int) files.size() == expectedFiles && tmpCount == 0 && glGetError() == GL_NO_ERROR;
+        printf("%s %s: [hit, miss]=[+%d, +%d] expected [+%d, +%d], files=%zu expected %d, tmp=%d, draw %s\n",
+               pass ? "PASS" : "FAIL", name, hit1 - hit0, miss1 - miss0, expectedHit, expectedMiss,
+               files.size(), expectedFiles, tmpCount, drawn ? "ok" : "wrong");
+        if (!pass) m_FailCount++;
+    }
+
+    void Expect(const char *name, bool pass) {
+        printf("%s %s\n", pass ? "PASS" : "FAIL", name);
+        if (!pass) m_FailCount++;
+    }
+
+    int GetFailCount() {
+        return m_FailCount;
+    }
+
+private:
+    std::string m_Dir;
+    int m_FailCount = 0;
+};
+
+static void RemoveDir(const std::string &dir) {
+    int tmpCount;
+    std::vector<std::string> files = ListCacheFiles(dir, &tmpCount);
+    for (size_t i = 0; i < files.size(); ++i) {
+        remove(files[i].c_str());
+    }
+    rmdir(dir.c_str());
+}
+
+int main(int argc, char *argv[]) {
+    HeadlessGLContext context;
+    if (context.Init(TEST_RENDER_WIDTH, TEST_RENDER_HEIGHT) != 0) {
+        printf("SKIP no headless GLES 3.0 context, run with EGL_PLATFORM=surfaceless on Mesa\n");
+        return HEADLESS_GL_SKIP;
+    }
+    GLint formatNum = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatNum);
+    if (formatNum <= 0) {
+        printf("SKIP driver reports no program binary formats\n");
+        return HEADLESS_GL_SKIP;
+    }
+
+    char dirTemplate[] = "/tmp/program-cache-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr) {
+        printf("FAIL mkdtemp\n");
+        return 1;
+    }
+    std::string dir = dirTemplate;
+    ProgramCacheTest test(dir);
+
+    //未设置缓存目录时不读写文件，也不计数
+    GLUtils::SetProgramCacheDir(nullptr);
+    test.Run("cache off", fShaderStr, COLOR1, 0, 0, 0);
+
+    GLUtils::SetProgramCacheDir(dir.c_str());
+    test.Run("cold", fShaderStr, COLOR1, 0, 1, 1);
+    test.Run("warm", fShaderStr, COLOR1, 1, 0, 1);
+
+    int tmpCount;
+    std::vector<std::string> files = ListCacheFiles(dir, &tmpCount);
+    std::string cacheFile = files.empty() ? std::string() : files[0];
+    long cacheSize = GetFileSize(cacheFile);
+    test.Expect("cache file written", cacheSize > 0);
+
+    //截断到二进制数据中间：读取失败，删除后重新编译并写入完整文件，之后再次命中
+    if (cacheSize > 0) {
+        test.Expect("truncate binary", truncate(cacheFile.c_str(), cacheSize / 2) == 0);
+        test.Run("truncated binary", fShaderStr, COLOR1, 0, 1, 1);
+        test.Expect("truncated binary rewritten", GetFileSize(cacheFile) == cacheSize);
+        test.Run("warm after truncated binary", fShaderStr, COLOR1, 1, 0, 1);
+
+        //截断到文件头中间
+        test.Expect("truncate header", truncate(cacheFile.c_str(), 10) == 0);
+        test.Run("truncated header", fShaderStr, COLOR1, 0, 1, 1);
+        test.Expect("truncated header rewritten", GetFileSize(cacheFile) == cacheSize);
+
+        //文件头完整但内容损坏
+        FILE *fp = fopen(cacheFile.c_str(), "r+b");
+        if (fp != nullptr) {
+            fseek(fp, 0, SEEK_SET);
+            fputs("garbage!", fp);
+            fclose(fp);
+        }
+        test.Run("corrupt header", fShaderStr, COLOR1, 0, 1, 1);
+        test.Run("warm after corrupt header", fShaderStr, COLOR1, 1, 0, 1);
+    }
+
+    //源码不同的程序使用各自的缓存文件，互不覆盖
+    test.Run("second program cold", fShaderStr2, COLOR2, 0, 1, 2);
+    test.Run("second program warm", fShaderStr2, COLOR2, 1, 0, 2);
+    test.Run("first program still warm", fShaderStr, COLOR1, 1, 0, 2);
+
+    GLUtils::SetProgramCacheDir(nullptr);
+    RemoveDir(dir);
+
+    int failCount = test.GetFailCount();
+    printf("%s: %d failure(s)\n", failCount == 0 ? "PASS" : "FAIL", failCount);
+    return failCount == 0 ? 0 : 1;
+}
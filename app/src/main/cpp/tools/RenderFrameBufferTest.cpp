@@ -0,0 +1,190 @@
+// RenderFrameBuffer 三缓冲压力测试：同步线程交替用 PushFrameRef/PushFrameCopy 推送 20 万帧，
+// GL 线程不停地 AcquireLatest 并读取整帧，检查：
+// 1. 读到的帧没有撕裂（整帧像素都属于同一帧）；
+// 2. 读到的帧序号只增不减，最后一定能取到最后一帧；
+// 3. 引用计数帧的解码缓冲全部归还：运行中最多只被三个槽位持有，析构后全部释放，
+//    生产者额外持有的引用计数回到 1。
+//
+// usage: render-frame-buffer-test [frameCount]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include <RenderFrameBuffer.h>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/mem.h>
+};
+
+#define TEST_FRAME_COUNT    200000
+#define TEST_WIDTH          64
+#define TEST_HEIGHT         64
+#define TEST_KEEP_REFS      3       // 最后几帧生产者额外保留引用，析构后检查引用计数
+
+static atomic<int64_t> s_CreatedBuffers(0);
+static atomic<int64_t> s_FreedBuffers(0);
+
+static void FreeBuffer(void *opaque, uint8_t *data) {
+    s_FreedBuffers.fetch_add(1);
+    av_free(data);
+}
+
+//每个像素都写成帧序号，读取时据此判断是否撕裂
+static void FillPixels(uint8_t *data, int lineSize, uint32_t value) {
+    for (int y = 0; y < TEST_HEIGHT; ++y) {
+        uint32_t *row = reinterpret_cast<uint32_t *>(data + y * lineSize);
+        for (int x = 0; x < TEST_WIDTH; ++x) {
+            row[x] = value;
+        }
+    }
+}
+
+//整帧像素一致时返回帧序号，否则返回 0
+static uint32_t ReadFrameValue(const NativeImage *pImage) {
+    if (pImage->ppPlane[0] == nullptr || pImage->width != TEST_WIDTH || pImage->height != TEST_HEIGHT) {
+        return 0;
+    }
+    uint32_t value = reinterpret_cast<const uint32_t *>(pImage->ppPlane[0])[0];
+    for (int y = 0; y < TEST_HEIGHT; ++y) {
+        const uint32_t *row = reinterpret_cast<const uint32_t *>(pImage->ppPlane[0] + y * pImage->pLineSize[0]);
+        for (int x = 0; x < TEST_WIDTH; ++x) {
+            if (row[x] != value) return 0;
+        }
+    }
+    return value;
+}
+
+struct ProducerResult {
+    int64_t maxOutstanding = 0;
+    int allocFail = 0;
+    AVBufferRef *keptRefs[TEST_KEEP_REFS] = {nullptr};
+};
+
+static void Produce(RenderFrameBuffer *frameBuffer, int frameCount, ProducerResult *result) {
+    AVFrame *frame = av_frame_alloc();
+    uint8_t *copyData = static_cast<uint8_t *>(malloc(TEST_WIDTH * 4 * TEST_HEIGHT));
+    for (uint32_t i = 1; i <= (uint32_t) frameCount; ++i) {
+        NativeImage image;
+        image.format = IMAGE_FORMAT_RGBA;
+        image.width = TEST_WIDTH;
+        image.height = TEST_HEIGHT;
+        if (i % 2) {
+            //模拟解码帧：引用计数缓冲，推送后生产者立即释放自己的引用
+            int lineSize = TEST_WIDTH * 4 + 32;
+            int size = lineSize * TEST_HEIGHT;
+            uint8_t *data = static_cast<uint8_t *>(av_malloc(size));
+            AVBufferRef *buf = data ? av_buffer_create(data, size, FreeBuffer, nullptr, 0) : nullptr;
+            if (buf == nullptr) {
+                av_free(data);
+                result->allocFail++;
+                continue;
+            }
+            s_CreatedBuffers.fetch_add(1);
+            FillPixels(buf->data, lineSize, i);
+            frame->buf[0] = buf;
+            frame->data[0] = buf->data;
+            frame->linesize[0] = lineSize;
+            frame->width = TEST_WIDTH;
+            frame->height = TEST_HEIGHT;
+            frame->format = AV_PIX_FMT_RGBA;
+            if (i + 2 * TEST_KEEP_REFS > (uint32_t) frameCount) {
+                for (int k = 0; k < TEST_KEEP_REFS; ++k) {
+                    if (result->keptRefs[k] == nullptr) {
+                        result->keptRefs[k] = av_buffer_ref(buf);
+                        break;
+                    }
+                }
+            }
+            image.ppPlane[0] = frame->data[0];
+            image.pLineSize[0] = lineSize;
+            frameBuffer->PushFrameRef(&image, frame);
+            av_frame_unref(frame);
+        } else {
+            //模拟 sws_scale 输出：普通内存，下一帧会被覆盖
+            FillPixels(copyData, TEST_WIDTH * 4, i);
+            image.ppPlane[0] = copyData;
+            image.pLineSize[0] = TEST_WIDTH * 4;
+            frameBuffer->PushFrameCopy(&image);
+            FillPixels(copyData, TEST_WIDTH * 4, 0xDEADBEEF);
+        }
+        int64_t outstanding = s_CreatedBuffers.load() - s_FreedBuffers.load();
+        if (outstanding > result->maxOutstanding) result->maxOutstanding = outstanding;
+    }
+    free(copyData);
+    av_frame_free(&frame);
+}
+
+int main(int argc, char *argv[]) {
+    int frameCount = argc > 1 ? atoi(argv[1]) : TEST_FRAME_COUNT;
+    if (frameCount < 2 * TEST_KEEP_REFS) frameCount = 2 * TEST_KEEP_REFS;
+
+    RenderFrameBuffer *frameBuffer = new RenderFrameBuffer();
+    ProducerResult producerResult;
+    atomic<bool> producerDone(false);
+    thread producer([&]() {
+        Produce(frameBuffer, frameCount, &producerResult);
+        producerDone.store(true);
+    });
+
+    int64_t acquired = 0, torn = 0, backwards = 0;
+    uint32_t lastValue = 0;
+    for (;;) {
+        //生产者结束后再取一次，确保拿到最后一帧
+        bool done = producerDone.load();
+        if (frameBuffer->AcquireLatest()) {
+            uint32_t value = ReadFrameValue(&frameBuffer->GetReadFrame()->image);
+            acquired++;
+            if (value == 0) {
+                torn++;
+            } else {
+                if (value <= lastValue) backwards++;
+                lastValue = value;
+            }
+        }
+        if (done) break;
+    }
+    producer.join();
+
+    int failCount = 0;
+    bool pass = torn == 0;
+    printf("%s torn frames: %lld of %lld acquired\n", pass ? "PASS" : "FAIL", (long long) torn, (long long) acquired);
+    if (!pass) failCount++;
+
+    pass = backwards == 0 && lastValue == (uint32_t) frameCount;
+    printf("%s order: %lld backwards, last frame %u of %d\n", pass ? "PASS" : "FAIL", (long long) backwards,
+           lastValue, frameCount);
+    if (!pass) failCount++;
+
+    //三个槽位各持有至多一个引用，生产者推送时还可能持有一个
+    pass = producerResult.allocFail == 0 && producerResult.maxOutstanding <= RENDER_FRAME_SLOT_NUM + 1;
+    printf("%s outstanding buffers while running: max %lld\n", pass ? "PASS" : "FAIL",
+           (long long) producerResult.maxOutstanding);
+    if (!pass) failCount++;
+
+    int keptHeld = 0;
+    for (int k = 0; k < TEST_KEEP_REFS; ++k) {
+        if (producerResult.keptRefs[k] && av_buffer_get_ref_count(producerResult.keptRefs[k]) > 1) keptHeld++;
+    }
+    delete frameBuffer;
+
+    int keptReleased = 0;
+    for (int k = 0; k < TEST_KEEP_REFS; ++k) {
+        if (producerResult.keptRefs[k] && av_buffer_get_ref_count(producerResult.keptRefs[k]) == 1) keptReleased++;
+        av_buffer_unref(&producerResult.keptRefs[k]);
+    }
+    pass = keptHeld > 0 && keptReleased == TEST_KEEP_REFS;
+    printf("%s teardown: %d of the last frames held by slots, %d of %d refcounts back to 1\n", pass ? "PASS" : "FAIL",
+           keptHeld, keptReleased, TEST_KEEP_REFS);
+    if (!pass) failCount++;
+
+    pass = s_CreatedBuffers.load() == s_FreedBuffers.load();
+    printf("%s buffers freed: %lld of %lld\n", pass ? "PASS" : "FAIL", (long long) s_FreedBuffers.load(),
+           (long long) s_CreatedBuffers.load());
+    if (!pass) failCount++;
+
+    printf("%s: %d failure(s)\n", failCount == 0 ? "PASS" : "FAIL", failCount);
+    return failCount == 0 ? 0 : 1;
+}
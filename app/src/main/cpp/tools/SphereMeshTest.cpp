@@ -0,0 +1,197 @@
+// SphereMesh 与原 VRGLRender::GenerateMesh 的三角形列表对比：
+// 三角形带按 GL_TRIANGLE_STRIP 规则展开（奇数个三角形交换前两个顶点），去掉退化三角形后，
+// 应与原列表的三角形一一对应，绕向、顶点位置和纹理坐标都相同。
+// 默认的 9 度网格还检查顶点数、索引数和退化三角形个数。
+//
+// usage: sphere-mesh-test
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <map>
+#include <vector>
+#include <SphereMesh.h>
+
+#define TEST_RADIUS         3.0f    // VRGLRender 的 BALL_RADIUS * UNIT_SIZE
+#define TEST_PI             3.1415926535897932384626433832802
+#define TEST_RADIAN(angle)  ((angle) / 180 * TEST_PI)
+#define POSITION_EPSILON    1e-5f
+#define TEXCOORD_EPSILON    1e-6f
+
+struct TestTriangle {
+    glm::vec3 position[3];
+    glm::vec2 texCoord[3];
+};
+
+//原实现：每格两个三角形 (v1, v2, v4)、(v4, v2, v3)，顶点不共享
+static std::vector<TestTriangle> GenerateTriangleList(float radius, int angleSpan) {
+    std::vector<glm::vec3> vertexCoords;
+    for (float vAngle = 90; vAngle > -90; vAngle = vAngle - angleSpan) {
+        for (float hAngle = 360; hAngle > 0; hAngle = hAngle - angleSpan) {
+            double xozLength = radius * cos(TEST_RADIAN(vAngle));
+            glm::vec3 v1((float) (xozLength * cos(TEST_RADIAN(hAngle))), (float) (radius * sin(TEST_RADIAN(vAngle))),
+                         (float) (xozLength * sin(TEST_RADIAN(hAngle))));
+            glm::vec3 v4((float) (xozLength * cos(TEST_RADIAN(hAngle - angleSpan))), v1.y,
+                         (float) (xozLength * sin(TEST_RADIAN(hAngle - angleSpan))));
+            xozLength = radius * cos(TEST_RADIAN(vAngle - angleSpan));
+            float y = (float) (radius * sin(TEST_RADIAN(vAngle - angleSpan)));
+            glm::vec3 v2((float) (xozLength * cos(TEST_RADIAN(hAngle))), y, (float) (xozLength * sin(TEST_RADIAN(hAngle))));
+            glm::vec3 v3((float) (xozLength * cos(TEST_RADIAN(hAngle - angleSpan))), y,
+                         (float) (xozLength * sin(TEST_RADIAN(hAngle - angleSpan))));
+            glm::vec3 quad[6] = {v1, v2, v4, v4, v2, v3};
+            vertexCoords.insert(vertexCoords.end(), quad, quad + 6);
+        }
+    }
+
+    std::vector<glm::vec2> textureCoords;
+    int width = 360 / angleSpan;
+    int height = 180 / angleSpan;
+    float dw = 1.0f / width;
+    float dh = 1.0f / height;
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            float s = j * dw;
+            float t = i * dh;
+            glm::vec2 v1(s, t), v2(s, t + dh), v3(s + dw, t + dh), v4(s + dw, t);
+            glm::vec2 quad[6] = {v1, v2, v4, v4, v2, v3};
+            textureCoords.insert(textureCoords.end(), quad, quad + 6);
+        }
+    }
+
+    std::vector<TestTriangle> triangles(vertexCoords.size() / 3);
+    for (size_t i = 0; i < vertexCoords.size() && i < textureCoords.size(); ++i) {
+        triangles[i / 3].position[i % 3] = vertexCoords[i];
+        triangles[i / 3].texCoord[i % 3] = textureCoords[i];
+    }
+    return triangles;
+}
+
+//展开三角形带，跳过有重复索引的退化三角形
+static std::vector<TestTriangle> ExpandStrip(const SphereMesh *mesh, int *degenerateCount) {
+    const std::vector<SphereVertex> &vertices = mesh->GetVertices();
+    const std::vector<GLushort> &indices = mesh->GetIndices();
+    std::vector<TestTriangle> triangles;
+    *degenerateCount = 0;
+    for (size_t k = 0; k + 2 < indices.size(); ++k) {
+        GLushort a = indices[k], b = indices[k + 1], c = indices[k + 2];
+        if (a == b || b == c || a == c) {
+            (*degenerateCount)++;
+            continue;
+        }
+        if (k % 2) {
+            GLushort tmp = a;
+            a = b;
+            b = tmp;
+        }
+        GLushort triangle[3] = {a, b, c};
+        TestTriangle testTriangle;
+        for (int v = 0; v < 3; ++v) {
+            testTriangle.position[v] = vertices[triangle[v]].position;
+            testTriangle.texCoord[v] = vertices[triangle[v]].texCoord;
+        }
+        triangles.push_back(testTriangle);
+    }
+    return triangles;
+}
+
+//纹理坐标在网格中唯一，用格点编号标识顶点；first 为编号最小的顶点，从它开始旋转不改变绕向
+static std::vector<int> GetTriangleKey(const TestTriangle &triangle, int angleSpan, int *first) {
+    int cols = 360 / angleSpan;
+    int rows = 180 / angleSpan;
+    int ids[3];
+    for (int v = 0; v < 3; ++v) {
+        int j = (int) lroundf(triangle.texCoord[v].x * cols);
+        int i = (int) lroundf(triangle.texCoord[v].y * rows);
+        ids[v] = i * (cols + 1) + j;
+    }
+    *first = ids[0] < ids[1] ? (ids[0] < ids[2] ? 0 : 2) : (ids[1] < ids[2] ? 1 : 2);
+    return std::vector<int>{ids[*first], ids[(*first + 1) % 3], ids[(*first + 2) % 3]};
+}
+
+static bool IsSameVertex(const TestTriangle &t1, int v1, const TestTriangle &t2, int v2) {
+    glm::vec3 dp = t1.position[v1] - t2.position[v2];
+    glm::vec2 dt = t1.texCoord[v1] - t2.texCoord[v2];
+    return fabsf(dp.x) < POSITION_EPSILON && fabsf(dp.y) < POSITION_EPSILON && fabsf(dp.z) < POSITION_EPSILON
+           && fabsf(dt.x) < TEXCOORD_EPSILON && fabsf(dt.y) < TEXCOORD_EPSILON;
+}
+
+//与原列表一一对应时返回 0，否则返回多出、缺少或顶点不一致的三角形个数
+static int CompareTriangles(const std::vector<TestTriangle> &expected, const std::vector<TestTriangle> &actual,
+                            int angleSpan) {
+    std::map<std::vector<int>, size_t> expectedIndex;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        int first;
+        expectedIndex[GetTriangleKey(expected[i], angleSpan, &first)] = i;
+    }
+    //原列表中不应有重复的三角形
+    int mismatch = (int) (expected.size() - expectedIndex.size());
+    std::vector<bool> matched(expected.size(), false);
+    for (size_t i = 0; i < actual.size(); ++i) {
+        int actualFirst, expectedFirst;
+        auto iter = expectedIndex.find(GetTriangleKey(actual[i], angleSpan, &actualFirst));
+        if (iter == expectedIndex.end() || matched[iter->second]) {
+            mismatch++;
+            continue;
+        }
+        const TestTriangle &triangle = expected[iter->second];
+        GetTriangleKey(triangle, angleSpan, &expectedFirst);
+        bool same = true;
+        for (int v = 0; v < 3; ++v) {
+            if (!IsSameVertex(triangle, (expectedFirst + v) % 3, actual[i], (actualFirst + v) % 3)) same = false;
+        }
+        if (!same) {
+            mismatch++;
+            continue;
+        }
+        matched[iter->second] = true;
+    }
+    for (size_t i = 0; i < matched.size(); ++i) {
+        if (!matched[i]) mismatch++;
+    }
+    return mismatch;
+}
+
+int main(int argc, char *argv[]) {
+    int failCount = 0;
+    const int angleSpans[] = {9, 10, 30, 45, 90};
+    for (size_t s = 0; s < sizeof(angleSpans) / sizeof(angleSpans[0]); ++s) {
+        int angleSpan = angleSpans[s];
+        const SphereMesh *mesh = SphereMesh::GetMesh(TEST_RADIUS, angleSpan);
+        if (mesh == nullptr) {
+            printf("FAIL angle span %d: no mesh\n", angleSpan);
+            failCount++;
+            continue;
+        }
+        int rows = 180 / angleSpan;
+        int cols = 360 / angleSpan;
+        int degenerateCount = 0;
+        std::vector<TestTriangle> expected = GenerateTriangleList(TEST_RADIUS, angleSpan);
+        std::vector<TestTriangle> actual = ExpandStrip(mesh, &degenerateCount);
+        int mismatch = CompareTriangles(expected, actual, angleSpan);
+
+        size_t vertexCount = mesh->GetVertices().size();
+        size_t indexCount = mesh->GetIndices().size();
+        bool pass = mismatch == 0 && (int) expected.size() == rows * cols * 2
+                    && vertexCount == (size_t) ((rows + 1) * (cols + 1))
+                    && indexCount == (size_t) (rows * 2 * (cols + 1) + (rows - 1) * 2)
+                    && degenerateCount == (rows - 1) * 4;
+        //VRGLRender 使用的默认网格
+        if (angleSpan == 9) {
+            pass = pass && actual.size() == 1600 && vertexCount == 861 && indexCount == 1678 && degenerateCount == 76;
+        }
+        printf("%s angle span %d: %zu triangles (list %zu), %d mismatching, %zu vertices, %zu indices, %d degenerate\n",
+               pass ? "PASS" : "FAIL", angleSpan, actual.size(), expected.size(), mismatch, vertexCount, indexCount,
+               degenerateCount);
+        if (!pass) failCount++;
+    }
+
+    //同一参数只生成一次，非法参数返回空
+    bool pass = SphereMesh::GetMesh(TEST_RADIUS, 9) == SphereMesh::GetMesh(TEST_RADIUS, 9)
+                && SphereMesh::GetMesh(TEST_RADIUS, 9) != SphereMesh::GetMesh(TEST_RADIUS * 2, 9)
+                && SphereMesh::GetMesh(TEST_RADIUS, 7) == nullptr && SphereMesh::GetMesh(TEST_RADIUS, 0) == nullptr;
+    printf("%s mesh cache and invalid angle spans\n", pass ? "PASS" : "FAIL");
+    if (!pass) failCount++;
+
+    printf("%s: %d failure(s)\n", failCount == 0 ? "PASS" : "FAIL", failCount);
+    return failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+// VideoBufferPool 端到端测试：同一段视频用 MediaPlayer 解码两遍，一遍打开 PLAYER_OPTION_VIDEO_BUFFER_POOL，
+// 一遍关闭，HeadlessRender 输出的原始帧必须逐字节一致，且打开时确实由池分配了帧缓冲。
+// 未指定文件时先用 libavcodec 编码一段宽高不是 16 倍数、带 B 帧的 MPEG-4 短片。
+//
+// usage: video-buffer-pool-test [url]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <MediaPlayer.h>
+#include <render/video/HeadlessRender.h>
+#include <render/audio/WavFileRender.h>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+};
+
+#define TEST_CLIP_WIDTH     174
+#define TEST_CLIP_HEIGHT    98
+#define TEST_CLIP_FRAMES    48
+#define TEST_CLIP_FPS       24
+
+static mutex s_Mutex;
+static condition_variable s_Cond;
+static bool s_PlayerDone = false;
+
+static void OnPlayerMessage(void *context, int msgType, float msgCode) {
+    if(msgType == PLAYER_MSG_PLAYER_DONE) {
+        unique_lock<mutex> lock(s_Mutex);
+        s_PlayerDone = true;
+        s_Cond.notify_all();
+    }
+}
+
+//逐帧变化的渐变图案，保证每帧都有运动和色度细节
+static void FillFrame(AVFrame *frame, int index) {
+    for (int y = 0; y < frame->height; ++y) {
+        for (int x = 0; x < frame->width; ++x) {
+            frame->data[0][y * frame->linesize[0] + x] = (uint8_t) (x * 3 + y * 2 + index * 5);
+        }
+    }
+    for (int y = 0; y < frame->height / 2; ++y) {
+        for (int x = 0; x < frame->width / 2; ++x) {
+            frame->data[1][y * frame->linesize[1] + x] = (uint8_t) (128 + y + index * 3);
+            frame->data[2][y * frame->linesize[2] + x] = (uint8_t) (64 + x + index * 2);
+        }
+    }
+}
+
+static int WritePackets(AVCodecContext *codecCtx, AVFormatContext *formatCtx, AVStream *stream, AVFrame *frame) {
+    int result = avcodec_send_frame(codecCtx, frame);
+    AVPacket *packet = av_packet_alloc();
+    while (result >= 0) {
+        result = avcodec_receive_packet(codecCtx, packet);
+        if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) {
+            result = 0;
+            break;
+        }
+        if (result < 0) break;
+        av_packet_rescale_ts(packet, codecCtx->time_base, stream->time_base);
+        packet->stream_index = stream->index;
+        result = av_interleaved_write_frame(formatCtx, packet);
+    }
+    av_packet_free(&packet);
+    return result;
+}
+
+//编码测试短片，成功返回 0
+static int GenerateClip(const char *path) {
+    int result = -1;
+    AVFormatContext *formatCtx = nullptr;
+    AVCodecContext *codecCtx = nullptr;
+    AVFrame *frame = nullptr;
+    do {
+        if (avformat_alloc_output_context2(&formatCtx, nullptr, nullptr, path) < 0) break;
+        AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+        if (codec == nullptr) {
+            printf("  no MPEG-4 encoder in this FFmpeg build\n");
+            break;
+        }
+        AVStream *stream = avformat_new_stream(formatCtx, nullptr);
+        codecCtx = avcodec_alloc_context3(codec);
+        if (stream == nullptr || codecCtx == nullptr) break;
+        codecCtx->width = TEST_CLIP_WIDTH;
+        codecCtx->height = TEST_CLIP_HEIGHT;
+        codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+        codecCtx->time_base = (AVRational) {1, TEST_CLIP_FPS};
+        codecCtx->framerate = (AVRational) {TEST_CLIP_FPS, 1};
+        codecCtx->gop_size = 12;
+        codecCtx->max_b_frames = 2;
+        codecCtx->bit_rate = 400000;
+        if (formatCtx->oformat->flags & AVFMT_GLOBALHEADER) {
+            codecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        if (avcodec_open2(codecCtx, codec, nullptr) < 0) break;
+        if (avcodec_parameters_from_context(stream->codecpar, codecCtx) < 0) break;
+        stream->time_base = codecCtx->time_base;
+        if (avio_open(&formatCtx->pb, path, AVIO_FLAG_WRITE) < 0) break;
+        if (avformat_write_header(formatCtx, nullptr) < 0) break;
+
+        frame = av_frame_alloc();
+        frame->format = codecCtx->pix_fmt;
+        frame->width = codecCtx->width;
+        frame->height = codecCtx->height;
+        if (av_frame_get_buffer(frame, 0) < 0) break;
+        int i = 0;
+        for (; i < TEST_CLIP_FRAMES; ++i) {
+            if (av_frame_make_writable(frame) < 0) break;
+            FillFrame(frame, i);
+            frame->pts = i;
+            if (WritePackets(codecCtx, formatCtx, stream, frame) < 0) break;
+        }
+        if (i < TEST_CLIP_FRAMES || WritePackets(codecCtx, formatCtx, stream, nullptr) < 0) break;
+        if (av_write_trailer(formatCtx) < 0) break;
+        result = 0;
+    } while (false);
+
+    av_frame_free(&frame);
+    avcodec_free_context(&codecCtx);
+    if (formatCtx != nullptr) {
+        if (formatCtx->pb != nullptr) avio_closep(&formatCtx->pb);
+        avformat_free_context(formatCtx);
+    }
+    return result;
+}
+
+//不做同步、不跳帧地解码整段视频，原始帧写入 outPath，返回渲染的帧数
+static long RunPlayer(const char *url, bool useBufferPool, const char *outPath, PlayerStatsSnapshot *stats) {
+    HeadlessRender videoRender(outPath);
+    WavFileRender audioRender(nullptr, AUDIO_DST_SAMPLE_RATE, AUDIO_DST_CHANNEL_COUNTS, 16, false);
+
+    s_PlayerDone = false;
+    MediaPlayer player;
+    player.SetMessageCallback(nullptr, OnPlayerMessage);
+    player.SetPlayerOption(PLAYER_OPTION_LOOP, 0);
+    player.SetPlayerOption(PLAYER_OPTION_AUTO_EXIT, 1);
+    player.SetPlayerOption(PLAYER_OPTION_FREE_RUN, 1);
+    player.SetPlayerOption(PLAYER_OPTION_VIDEO_FRAME_SKIP, 0);
+    player.SetPlayerOption(PLAYER_OPTION_VIDEO_BUFFER_POOL, useBufferPool ? 1 : 0);
+    player.Init(url, &videoRender, &audioRender);
+    player.Play();
+
+    {
+        unique_lock<mutex> lock(s_Mutex);
+        while (!s_PlayerDone) {
+            s_Cond.wait(lock);
+        }
+    }
+    player.GetStatsSnapshot(stats);
+    player.UnInit();
+    videoRender.UnInit();
+    return videoRender.GetFrameCount();
+}
+
+//两个文件内容一致返回 true，size 为文件长度
+static bool CompareFiles(const char *path1, const char *path2, long *size) {
+    FILE *fp1 = fopen(path1, "rb");
+    FILE *fp2 = fopen(path2, "rb");
+    bool same = fp1 != nullptr && fp2 != nullptr;
+    *size = 0;
+    while (same) {
+        int c1 = fgetc(fp1);
+        int c2 = fgetc(fp2);
+        if (c1 != c2) same = false;
+        if (c1 == EOF || c2 == EOF) break;
+        (*size)++;
+    }
+    if (fp1 != nullptr) fclose(fp1);
+    if (fp2 != nullptr) fclose(fp2);
+    return same;
+}
+
+int main(int argc, char *argv[]) {
+    char dirTemplate[] = "/tmp/video-buffer-pool-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr) {
+        printf("FAIL mkdtemp\n");
+        return 1;
+    }
+    std::string dir = dirTemplate;
+    std::string clipPath = dir + "/clip.mp4";
+    std::string pooledPath = dir + "/pooled.yuv";
+    std::string defaultPath = dir + "/default.yuv";
+
+    int failCount = 0;
+    const char *url = argc > 1 ? argv[1] : clipPath.c_str();
+    if (argc <= 1) {
+        bool pass = GenerateClip(url) == 0;
+        printf("%s generate %dx%d MPEG-4 clip, %d frames\n", pass ? "PASS" : "FAIL", TEST_CLIP_WIDTH,
+               TEST_CLIP_HEIGHT, TEST_CLIP_FRAMES);
+        if (!pass) {
+            rmdir(dir.c_str());
+            return 1;
+        }
+    }
+
+    PlayerStatsSnapshot pooledStats, defaultStats;
+    long pooledFrames = RunPlayer(url, true, pooledPath.c_str(), &pooledStats);
+    long defaultFrames = RunPlayer(url, false, defaultPath.c_str(), &defaultStats);
+
+    bool pass = pooledFrames > 0 && pooledFrames == defaultFrames
+                && (argc > 1 || pooledFrames == TEST_CLIP_FRAMES);
+    printf("%s frames rendered: pool on %ld, pool off %ld\n", pass ? "PASS" : "FAIL", pooledFrames, defaultFrames);
+    if (!pass) failCount++;
+
+    long size = 0;
+    pass = CompareFiles(pooledPath.c_str(), defaultPath.c_str(), &size) && size > 0;
+    printf("%s output identical: %ld bytes\n", pass ? "PASS" : "FAIL", size);
+    if (!pass) failCount++;
+
+    int64_t pooled = pooledStats.counters[PLAYER_COUNTER_VIDEO_POOLED_BUFFERS];
+    int64_t fallback = pooledStats.counters[PLAYER_COUNTER_VIDEO_FALLBACK_BUFFERS];
+    pass = pooled > 0;
+    printf("%s pool on: pooled %lld, fallback %lld\n", pass ? "PASS" : "FAIL", (long long) pooled, (long long) fallback);
+    if (!pass) failCount++;
+
+    pooled = defaultStats.counters[PLAYER_COUNTER_VIDEO_POOLED_BUFFERS];
+    pass = pooled == 0;
+    printf("%s pool off: pooled %lld\n", pass ? "PASS" : "FAIL", (long long) pooled);
+    if (!pass) failCount++;
+
+    remove(pooledPath.c_str());
+    remove(defaultPath.c_str());
+    remove(clipPath.c_str());
+    rmdir(dir.c_str());
+
+    printf("%s: %d failure(s)\n", failCount == 0 ? "PASS" : "FAIL", failCount);
+    return failCount == 0 ? 0 : 1;
+}
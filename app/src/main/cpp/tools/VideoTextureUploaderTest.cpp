@@ -0,0 +1,282 @@
+// VideoTextureUploader 离屏像素校验，在 Mesa surfaceless EGL（llvmpipe 软件渲染）上运行：
+// 1. 逐字节回读每个平面的纹理与源数据对比，覆盖 RGBA/NV12/NV21/I420 在紧凑、带行尾填充、
+//    奇数行宽（不能整除像素字节数，走逐行拷贝）三种排列下的上传，每种连续多帧以覆盖整个 PBO 环；
+// 2. 用 VideoProgramCache 的各格式着色器绘制纯色帧，校验 YUV -> RGB 转换和纹理单元绑定。
+//
+// usage: EGL_PLATFORM=surfaceless video-texture-uploader-test
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <VideoTextureUploader.h>
+#include <VideoProgramCache.h>
+#include "HeadlessGLContext.h"
+
+#define TEST_FRAME_NUM      (PBO_RING_SIZE + 2)
+#define TEST_RENDER_WIDTH   64
+#define TEST_RENDER_HEIGHT  36
+#define PADDING_BYTE        0xAA
+
+enum StrideMode {
+    STRIDE_TIGHT = 0,
+    STRIDE_PADDED,      // 行尾 64 字节对齐的填充，模拟解码器输出
+    STRIDE_ODD,         // 奇数行宽，不能整除多字节像素
+    STRIDE_MODE_NUM
+};
+
+static const char *STRIDE_MODE_NAMES[STRIDE_MODE_NUM] = {"tight", "padded", "odd"};
+
+struct TestFormat {
+    int format;
+    const char *name;
+};
+
+static const TestFormat TEST_FORMATS[] = {
+        {IMAGE_FORMAT_RGBA, "RGBA"},
+        {IMAGE_FORMAT_NV12, "NV12"},
+        {IMAGE_FORMAT_NV21, "NV21"},
+        {IMAGE_FORMAT_I420, "I420"},
+};
+
+static const char vShaderStr[] =
+        "#version 300 es\n"
+        "layout(location = 0) in vec4 a_position;\n"
+        "layout(location = 1) in vec2 a_texCoord;\n"
+        "uniform mat4 u_MVPMatrix;\n"
+        "out vec2 v_texCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = u_MVPMatrix * a_position;\n"
+        "    v_texCoord = a_texCoord;\n"
+        "}";
+
+//一帧的源数据，平面按 StrideMode 排列，缓冲区在最后一行有效像素处结束
+struct TestImage {
+    NativeImage image;
+    std::vector<uint8_t> planes[VIDEO_PLANE_NUM];
+};
+
+//填充函数返回第 frame 帧平面 plane 中 (x, y) 像素第 c 个分量的值
+typedef uint8_t (*PixelFunc)(int format, int frame, int plane, int x, int y, int c);
+
+static uint8_t PatternPixel(int format, int frame, int plane, int x, int y, int c) {
+    return (uint8_t) (x * 7 + y * 13 + c * 59 + plane * 31 + frame * 5);
+}
+
+//纯色帧：Y=128, U=100, V=180，RGBA 为 (10, 200, 60)
+static uint8_t SolidPixel(int format, int frame, int plane, int x, int y, int c) {
+    static const uint8_t RGBA[4] = {10, 200, 60, 255};
+    if (format == IMAGE_FORMAT_RGBA) return RGBA[c];
+    if (plane == 0) return 128;
+    switch (format) {
+        case IMAGE_FORMAT_NV12:
+            return c == 0 ? 100 : 180;
+        case IMAGE_FORMAT_NV21:
+            return c == 0 ? 180 : 100;
+        default:
+            return plane == 1 ? 100 : 180;
+    }
+}
+
+static int GetLineSize(int rowBytes, int strideMode) {
+    switch (strideMode) {
+        case STRIDE_PADDED:
+            return ((rowBytes + 63) & ~63) + (rowBytes % 64 == 0 ? 64 : 0);
+        case STRIDE_ODD:
+            return rowBytes + (rowBytes % 2 == 0 ? 3 : 2);
+        default:
+            return rowBytes;
+    }
+}
+
+static int FillImage(TestImage *pTestImage, int format, int width, int height, int strideMode, int frame, PixelFunc func) {
+    NativeImage *pImage = &pTestImage->image;
+    *pImage = NativeImage();
+    pImage->format = format;
+    pImage->width = width;
+    pImage->height = height;
+
+    VideoPlaneDesc planes[VIDEO_PLANE_NUM];
+    int planeNum = VideoTextureUploader::GetPlaneDesc(pImage, planes);
+    for (int i = 0; i < planeNum; ++i) {
+        int rowBytes = planes[i].width * planes[i].bytesPerPixel;
+        int lineSize = GetLineSize(rowBytes, strideMode);
+        std::vector<uint8_t> &data = pTestImage->planes[i];
+        data.assign((size_t) (lineSize * (planes[i].height - 1) + rowBytes), PADDING_BYTE);
+        for (int y = 0; y < planes[i].height; ++y) {
+            for (int x = 0; x < planes[i].width; ++x) {
+                for (int c = 0; c < planes[i].bytesPerPixel; ++c) {
+                    data[y * lineSize + x * planes[i].bytesPerPixel + c] = func(format, frame, i, x, y, c);
+                }
+            }
+        }
+        pImage->ppPlane[i] = data.data();
+        pImage->pLineSize[i] = lineSize;
+    }
+    return planeNum;
+}
+
+//把纹理挂到临时 FBO 上读回，R8/RG8 纹理读出的 RGBA 中只有前一或两个分量有效
+static void ReadTexture(GLuint textureId, int width, int height, GLuint restoreFbo, std::vector<uint8_t> &pixels) {
+    GLuint fbo = GL_NONE;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
+    pixels.assign((size_t) (width * height * 4), 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, restoreFbo);
+    glDeleteFramebuffers(1, &fbo);
+}
+
+//逐平面比较纹理与源数据，返回不一致的分量个数
+static int CheckPlanes(VideoTextureUploader &uploader, TestImage *pTestImage, GLuint restoreFbo) {
+    NativeImage *pImage = &pTestImage->image;
+    VideoPlaneDesc planes[VIDEO_PLANE_NUM];
+    int planeNum = VideoTextureUploader::GetPlaneDesc(pImage, planes);
+    int mismatch = 0;
+    std::vector<uint8_t> pixels;
+    for (int i = 0; i < planeNum; ++i) {
+        ReadTexture(uploader.GetTextureId(i), planes[i].width, planes[i].height, restoreFbo, pixels);
+        for (int y = 0; y < planes[i].height; ++y) {
+            for (int x = 0; x < planes[i].width; ++x) {
+                for (int c = 0; c < planes[i].bytesPerPixel; ++c) {
+                    uint8_t expected = pImage->ppPlane[i][y * pImage->pLineSize[i] + x * planes[i].bytesPerPixel + c];
+                    uint8_t actual = pixels[(y * planes[i].width + x) * 4 + c];
+                    if (actual != expected) {
+                        if (mismatch == 0) {
+                            fprintf(stderr, "  plane %d (%d, %d)[%d] expected %d, got %d\n", i, x, y, c, expected, actual);
+                        }
+                        mismatch++;
+                    }
+                }
+            }
+        }
+    }
+    return mismatch;
+}
+
+static int TestUploadPixels(VideoTextureUploader &uploader, GLuint restoreFbo) {
+    static const int SIZES[][2] = {{37, 22}, {64, 36}, {17, 9}};
+    int failCount = 0;
+    for (size_t f = 0; f < sizeof(TEST_FORMATS) / sizeof(TEST_FORMATS[0]); ++f) {
+        for (int strideMode = 0; strideMode < STRIDE_MODE_NUM; ++strideMode) {
+            for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); ++s) {
+                int mismatch = 0;
+                int result = 0;
+                for (int frame = 0; frame < TEST_FRAME_NUM; ++frame) {
+                    TestImage testImage;
+                    FillImage(&testImage, TEST_FORMATS[f].format, SIZES[s][0], SIZES[s][1], strideMode, frame, PatternPixel);
+                    result |= uploader.Upload(&testImage.image);
+                    mismatch += CheckPlanes(uploader, &testImage, restoreFbo);
+                }
+                bool pass = result == 0 && mismatch == 0 && glGetError() == GL_NO_ERROR;
+                printf("%s upload %s %s %dx%d: mismatch=%d\n", pass ? "PASS" : "FAIL", TEST_FORMATS[f].name,
+                       STRIDE_MODE_NAMES[strideMode], SIZES[s][0], SIZES[s][1], mismatch);
+                if (!pass) failCount++;
+            }
+        }
+    }
+    return failCount;
+}
+
+static void GetSolidColor(int format, int rgb[3]) {
+    if (format == IMAGE_FORMAT_RGBA) {
+        for (int c = 0; c < 3; ++c) {
+            rgb[c] = SolidPixel(format, 0, 0, 0, 0, c);
+        }
+        return;
+    }
+    //与着色器中的 BT.601 系数一致
+    float y = 128 / 255.0f, u = 100 / 255.0f - 0.5f, v = 180 / 255.0f - 0.5f;
+    rgb[0] = (int) ((y + 1.403f * v) * 255 + 0.5f);
+    rgb[1] = (int) ((y - 0.344f * u - 0.714f * v) * 255 + 0.5f);
+    rgb[2] = (int) ((y + 1.770f * u) * 255 + 0.5f);
+}
+
+static int TestRenderColor(VideoTextureUploader &uploader) {
+    VideoProgramCache programCache;
+    if (programCache.Init(vShaderStr) != 0) {
+        printf("FAIL render: VideoProgramCache::Init\n");
+        return 1;
+    }
+
+    GLfloat vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    GLfloat texCoords[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    GLfloat identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    GLuint vao = GL_NONE, vbos[2];
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(2, vbos);
+    glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, vbos[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(texCoords), texCoords, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    int failCount = 0;
+    std::vector<uint8_t> pixels((size_t) (TEST_RENDER_WIDTH * TEST_RENDER_HEIGHT * 4));
+    for (size_t f = 0; f < sizeof(TEST_FORMATS) / sizeof(TEST_FORMATS[0]); ++f) {
+        TestImage testImage;
+        int planeNum = FillImage(&testImage, TEST_FORMATS[f].format, TEST_RENDER_WIDTH, TEST_RENDER_HEIGHT, STRIDE_ODD, 0, SolidPixel);
+        uploader.Upload(&testImage.image);
+
+        VideoProgram *program = programCache.GetProgram(TEST_FORMATS[f].format);
+        if (program == nullptr) {
+            printf("FAIL render %s: no program\n", TEST_FORMATS[f].name);
+            failCount++;
+            continue;
+        }
+        glUseProgram(program->program);
+        glUniformMatrix4fv(program->mvpMatrixLoc, 1, GL_FALSE, identity);
+        for (int i = 0; i < planeNum; ++i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, uploader.GetTextureId(i));
+        }
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, TEST_RENDER_WIDTH, TEST_RENDER_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        int expected[3];
+        GetSolidColor(TEST_FORMATS[f].format, expected);
+        int maxDiff = 0;
+        for (int p = 0; p < TEST_RENDER_WIDTH * TEST_RENDER_HEIGHT; ++p) {
+            for (int c = 0; c < 3; ++c) {
+                int diff = abs(pixels[p * 4 + c] - expected[c]);
+                if (diff > maxDiff) maxDiff = diff;
+            }
+        }
+        //RGBA 直接采样应完全一致，YUV 转换允许 GPU 浮点精度带来的误差
+        bool pass = maxDiff <= (TEST_FORMATS[f].format == IMAGE_FORMAT_RGBA ? 0 : 2) && glGetError() == GL_NO_ERROR;
+        printf("%s render %s: pixel=(%d, %d, %d) expected=(%d, %d, %d) maxDiff=%d\n", pass ? "PASS" : "FAIL",
+               TEST_FORMATS[f].name, pixels[0], pixels[1], pixels[2], expected[0], expected[1], expected[2], maxDiff);
+        if (!pass) failCount++;
+    }
+
+    glDeleteBuffers(2, vbos);
+    glDeleteVertexArrays(1, &vao);
+    return failCount;
+}
+
+int main(int argc, char *argv[]) {
+    HeadlessGLContext context;
+    if (context.Init(TEST_RENDER_WIDTH, TEST_RENDER_HEIGHT) != 0) {
+        printf("SKIP no headless GLES 3.0 context, run with EGL_PLATFORM=surfaceless on Mesa\n");
+        return HEADLESS_GL_SKIP;
+    }
+
+    VideoTextureUploader uploader;
+    uploader.OnSurfaceCreated();
+
+    int failCount = TestUploadPixels(uploader, context.GetFbo());
+    failCount += TestRenderColor(uploader);
+
+    printf("%s: %d failure(s)\n", failCount == 0 ? "PASS" : "FAIL", failCount);
+    return failCount == 0 ? 0 : 1;
+}
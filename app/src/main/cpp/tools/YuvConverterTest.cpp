@@ -0,0 +1,216 @@
+// YuvConverter 各颜色转换实现的一致性测试：
+// 1. C 实现与浮点参考公式对比，BT.601/BT.709、limited/full range 下每个分量误差不超过 3；
+// 2. 当前编译目标和 CPU 支持的每个 SIMD 实现（SSE2/AVX2/NEON）与 C 实现逐字节一致，
+//    覆盖 I420/NV12/NV21、宽度 1..1920（各种尾部长度），并检查不会写出目标行之外。
+//
+// usage: yuv-converter-test
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <YuvConverter.h>
+
+#define TEST_MAX_WIDTH      1920
+#define TEST_HEIGHT         3       // 奇数行，最后一行色度只对应一行亮度
+#define TEST_MAX_ERROR      3
+#define DST_GUARD_SIZE      64
+#define DST_GUARD_BYTE      0xCD
+
+static const char *SIMD_NAMES[] = {"sse2", "avx2", "neon"};
+
+struct TestFormat {
+    int format;
+    const char *name;
+};
+
+static const TestFormat TEST_FORMATS[] = {
+        {IMAGE_FORMAT_I420, "I420"},
+        {IMAGE_FORMAT_NV12, "NV12"},
+        {IMAGE_FORMAT_NV21, "NV21"},
+};
+
+static const int COLOR_SETTINGS[][2] = {
+        {YUV_COLOR_SPACE_BT601, YUV_COLOR_RANGE_LIMITED},
+        {YUV_COLOR_SPACE_BT601, YUV_COLOR_RANGE_FULL},
+        {YUV_COLOR_SPACE_BT709, YUV_COLOR_RANGE_LIMITED},
+        {YUV_COLOR_SPACE_BT709, YUV_COLOR_RANGE_FULL},
+};
+
+static uint32_t s_Seed = 12345;
+
+static uint8_t NextRandom() {
+    s_Seed = s_Seed * 1103515245 + 12345;
+    return (uint8_t) (s_Seed >> 16);
+}
+
+//一帧随机源数据，行尾带填充，校验实现使用的是行宽而不是像素宽度
+struct TestImage {
+    NativeImage image;
+    std::vector<uint8_t> planes[3];
+};
+
+static void FillImage(TestImage *pTestImage, int format, int width, int height) {
+    NativeImage *pImage = &pTestImage->image;
+    *pImage = NativeImage();
+    pImage->format = format;
+    pImage->width = width;
+    pImage->height = height;
+
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    int planeNum = format == IMAGE_FORMAT_I420 ? 3 : 2;
+    for (int i = 0; i < planeNum; ++i) {
+        int rowBytes = i == 0 ? width : (format == IMAGE_FORMAT_I420 ? chromaWidth : chromaWidth * 2);
+        int rows = i == 0 ? height : chromaHeight;
+        int lineSize = rowBytes + 7;
+        std::vector<uint8_t> &data = pTestImage->planes[i];
+        data.resize((size_t) (lineSize * rows));
+        for (size_t j = 0; j < data.size(); ++j) {
+            data[j] = NextRandom();
+        }
+        pImage->ppPlane[i] = data.data();
+        pImage->pLineSize[i] = lineSize;
+    }
+}
+
+static void GetYuv(const NativeImage *pImage, int x, int y, int *yy, int *u, int *v) {
+    *yy = pImage->ppPlane[0][y * pImage->pLineSize[0] + x];
+    int cx = x >> 1, cy = y >> 1;
+    if (pImage->format == IMAGE_FORMAT_I420) {
+        *u = pImage->ppPlane[1][cy * pImage->pLineSize[1] + cx];
+        *v = pImage->ppPlane[2][cy * pImage->pLineSize[2] + cx];
+    } else {
+        const uint8_t *p = pImage->ppPlane[1] + cy * pImage->pLineSize[1] + cx * 2;
+        *u = pImage->format == IMAGE_FORMAT_NV12 ? p[0] : p[1];
+        *v = pImage->format == IMAGE_FORMAT_NV12 ? p[1] : p[0];
+    }
+}
+
+//浮点参考：按 Kr/Kb 定义的 YCbCr -> RGB
+static void ReferencePixel(int y, int u, int v, int colorSpace, int colorRange, int rgb[3]) {
+    double kr = colorSpace == YUV_COLOR_SPACE_BT709 ? 0.2126 : 0.299;
+    double kb = colorSpace == YUV_COLOR_SPACE_BT709 ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+    double yf = y, uf = u - 128.0, vf = v - 128.0;
+    if (colorRange == YUV_COLOR_RANGE_LIMITED) {
+        yf = (y - 16) * 255.0 / 219.0;
+        uf *= 255.0 / 224.0;
+        vf *= 255.0 / 224.0;
+    }
+    double r = yf + 2.0 * (1.0 - kr) * vf;
+    double b = yf + 2.0 * (1.0 - kb) * uf;
+    double g = (yf - kr * r - kb * b) / kg;
+    double values[3] = {r, g, b};
+    for (int c = 0; c < 3; ++c) {
+        double value = values[c] < 0 ? 0 : (values[c] > 255 ? 255 : values[c]);
+        rgb[c] = (int) lround(value);
+    }
+}
+
+//转换整帧，目标每行之后留有哨兵字节，被改写时返回 -1
+static int Convert(YuvConverter &converter, TestImage *pTestImage, std::vector<uint8_t> &dst) {
+    NativeImage *pImage = &pTestImage->image;
+    int dstStride = pImage->width * 4 + DST_GUARD_SIZE;
+    dst.assign((size_t) (dstStride * pImage->height), DST_GUARD_BYTE);
+    if (converter.ConvertToRgba(pImage, dst.data(), dstStride, pImage->width, pImage->height) != 0) {
+        return -1;
+    }
+    for (int y = 0; y < pImage->height; ++y) {
+        for (int i = pImage->width * 4; i < dstStride; ++i) {
+            if (dst[y * dstStride + i] != DST_GUARD_BYTE) return -1;
+        }
+    }
+    return 0;
+}
+
+//C 实现与浮点参考的最大误差
+static int TestReference(YuvConverter &converter, int colorSpace, int colorRange) {
+    int maxError = 0;
+    std::vector<uint8_t> dst;
+    for (size_t f = 0; f < sizeof(TEST_FORMATS) / sizeof(TEST_FORMATS[0]); ++f) {
+        for (int width = 1; width <= TEST_MAX_WIDTH; width += 37) {
+            TestImage testImage;
+            FillImage(&testImage, TEST_FORMATS[f].format, width, TEST_HEIGHT);
+            if (Convert(converter, &testImage, dst) != 0) return 256;
+            int dstStride = width * 4 + DST_GUARD_SIZE;
+            for (int y = 0; y < TEST_HEIGHT; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    int yy, u, v, rgb[3];
+                    GetYuv(&testImage.image, x, y, &yy, &u, &v);
+                    ReferencePixel(yy, u, v, colorSpace, colorRange, rgb);
+                    const uint8_t *out = &dst[y * dstStride + x * 4];
+                    for (int c = 0; c < 3; ++c) {
+                        int error = abs(out[c] - rgb[c]);
+                        if (error > maxError) maxError = error;
+                    }
+                    if (out[3] != 255) return 256;
+                }
+            }
+        }
+    }
+    return maxError;
+}
+
+//SIMD 实现与 C 实现不一致的宽度个数
+static int TestSimdParity(YuvConverter &converter, const char *simdName, int format) {
+    int mismatchWidths = 0;
+    std::vector<uint8_t> expected, actual;
+    for (int width = 1; width <= TEST_MAX_WIDTH; ++width) {
+        TestImage testImage;
+        FillImage(&testImage, format, width, TEST_HEIGHT);
+        YuvConverter::SetSimd("c");
+        int result = Convert(converter, &testImage, expected);
+        YuvConverter::SetSimd(simdName);
+        result |= Convert(converter, &testImage, actual);
+        if (result != 0 || expected != actual) {
+            if (mismatchWidths == 0) {
+                fprintf(stderr, "  %s first mismatch at width %d%s\n", simdName, width,
+                        result != 0 ? " (wrote past the destination row)" : "");
+            }
+            mismatchWidths++;
+        }
+    }
+    return mismatchWidths;
+}
+
+int main(int argc, char *argv[]) {
+    printf("default implementation: %s\n", YuvConverter::GetSimdName());
+    YuvConverter converter;
+    int failCount = 0;
+
+    YuvConverter::SetSimd("c");
+    for (size_t s = 0; s < sizeof(COLOR_SETTINGS) / sizeof(COLOR_SETTINGS[0]); ++s) {
+        converter.SetColorSpace(COLOR_SETTINGS[s][0], COLOR_SETTINGS[s][1]);
+        int maxError = TestReference(converter, COLOR_SETTINGS[s][0], COLOR_SETTINGS[s][1]);
+        bool pass = maxError <= TEST_MAX_ERROR;
+        printf("%s c vs reference %s %s: max error %d\n", pass ? "PASS" : "FAIL",
+               COLOR_SETTINGS[s][0] == YUV_COLOR_SPACE_BT709 ? "BT.709" : "BT.601",
+               COLOR_SETTINGS[s][1] == YUV_COLOR_RANGE_FULL ? "full" : "limited", maxError);
+        if (!pass) failCount++;
+    }
+
+    int simdCount = 0;
+    for (size_t i = 0; i < sizeof(SIMD_NAMES) / sizeof(SIMD_NAMES[0]); ++i) {
+        if (YuvConverter::SetSimd(SIMD_NAMES[i]) != 0) {
+            printf("SKIP %s: not supported by this build or CPU\n", SIMD_NAMES[i]);
+            continue;
+        }
+        simdCount++;
+        for (size_t s = 0; s < sizeof(COLOR_SETTINGS) / sizeof(COLOR_SETTINGS[0]); ++s) {
+            converter.SetColorSpace(COLOR_SETTINGS[s][0], COLOR_SETTINGS[s][1]);
+            for (size_t f = 0; f < sizeof(TEST_FORMATS) / sizeof(TEST_FORMATS[0]); ++f) {
+                int mismatchWidths = TestSimdParity(converter, SIMD_NAMES[i], TEST_FORMATS[f].format);
+                bool pass = mismatchWidths == 0;
+                printf("%s %s vs c %s, color setting %zu, widths 1..%d: %d mismatching widths\n", pass ? "PASS" : "FAIL",
+                       SIMD_NAMES[i], TEST_FORMATS[f].name, s, TEST_MAX_WIDTH, mismatchWidths);
+                if (!pass) failCount++;
+            }
+        }
+    }
+    printf("%d SIMD implementation(s) compared\n", simdCount);
+
+    printf("%s: %d failure(s)\n", failCount == 0 ? "PASS" : "FAIL", failCount);
+    return failCount == 0 ? 0 : 1;
+}
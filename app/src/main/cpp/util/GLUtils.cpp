@@ -3,6 +3,173 @@
 #include <stdlib.h>
 #include <cstring>
 #include <GLES2/gl2ext.h>
+#include <cstdio>
+#include <mutex>
+#include <atomic>
+
+//程序二进制缓存文件头，后面紧跟 glGetProgramBinary 得到的数据
+#define PROGRAM_BINARY_MAGIC    0x4250474C  // "LGPB"
+#define PROGRAM_BINARY_VERSION  1
+
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;           // 着色器源码和驱动信息的哈希，文件名冲突或内容损坏时用于校验
+    uint32_t binaryFormat;
+    uint32_t length;
+};
+
+static std::mutex s_ProgramCacheMutex;
+static std::string s_ProgramCacheDir;
+static std::atomic<int> s_ProgramCacheHit(0);
+static std::atomic<int> s_ProgramCacheMiss(0);
+
+//FNV-1a 64 位，字符串末尾的 '\0' 一并计入，避免 "ab"+"c" 与 "a"+"bc" 得到相同的值
+static uint64_t HashString(uint64_t hash, const char *str)
+{
+    if (str == nullptr) str = "";
+    do {
+        hash ^= (uint8_t) *str;
+        hash *= 1099511628211ULL;
+    } while (*str++ != '\0');
+    return hash;
+}
+
+//驱动升级或换 GPU 后旧的二进制不可用，键中加入 GL_VENDOR/GL_RENDERER/GL_VERSION
+static uint64_t GetProgramKey(const char *pVertexShaderSource, const char *pFragShaderSource)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hash = HashString(hash, pVertexShaderSource);
+    hash = HashString(hash, pFragShaderSource);
+    hash = HashString(hash, (const char *) glGetString(GL_VENDOR));
+    hash = HashString(hash, (const char *) glGetString(GL_RENDERER));
+    hash = HashString(hash, (const char *) glGetString(GL_VERSION));
+    return hash;
+}
+
+//未设置缓存目录或驱动不支持程序二进制时返回 false
+static bool GetProgramCachePath(uint64_t key, std::string &path)
+{
+    {
+        std::unique_lock<std::mutex> lock(s_ProgramCacheMutex);
+        if (s_ProgramCacheDir.empty()) return false;
+        path = s_ProgramCacheDir;
+    }
+    GLint formatNum = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatNum);
+    if (formatNum <= 0) return false;
+
+    char fileName[64];
+    sprintf(fileName, "/program_%016llx.bin", (unsigned long long) key);
+    path += fileName;
+    return true;
+}
+
+static bool IsProgramBinaryFormatSupported(GLenum binaryFormat)
+{
+    GLint formatNum = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatNum);
+    if (formatNum <= 0) return false;
+    GLint *formats = (GLint *) malloc(sizeof(GLint) * formatNum);
+    if (formats == nullptr) return false;
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats);
+    bool supported = false;
+    for (int i = 0; i < formatNum; ++i) {
+        if ((GLenum) formats[i] == binaryFormat) {
+            supported = true;
+            break;
+        }
+    }
+    free(formats);
+    return supported;
+}
+
+//命中返回链接好的程序，文件不存在、校验失败或驱动拒绝该二进制时返回 0
+static GLuint LoadProgramBinary(const std::string &path, uint64_t key)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) return 0;
+
+    GLuint program = 0;
+    void *binary = nullptr;
+    bool invalid = true;
+    do {
+        ProgramBinaryHeader header;
+        if (fread(&header, sizeof(header), 1, fp) != 1) break;
+        if (header.magic != PROGRAM_BINARY_MAGIC || header.version != PROGRAM_BINARY_VERSION
+            || header.key != key || header.length == 0) {
+            LOGCATE("GLUtils::LoadProgramBinary header mismatch, path=%s", path.c_str());
+            break;
+        }
+        if (!IsProgramBinaryFormatSupported(header.binaryFormat)) {
+            LOGCATE("GLUtils::LoadProgramBinary unsupported binaryFormat=0x%x", header.binaryFormat);
+            break;
+        }
+        binary = malloc(header.length);
+        if (binary == nullptr || fread(binary, header.length, 1, fp) != 1) break;
+
+        program = glCreateProgram();
+        if (program == 0) {
+            invalid = false;
+            break;
+        }
+        glProgramBinary(program, header.binaryFormat, binary, header.length);
+        GLint linkStatus = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+        if (linkStatus != GL_TRUE) {
+            LOGCATE("GLUtils::LoadProgramBinary glProgramBinary rejected, binaryFormat=0x%x", header.binaryFormat);
+            glDeleteProgram(program);
+            program = 0;
+            break;
+        }
+        invalid = false;
+    } while (false);
+
+    if (binary) free(binary);
+    fclose(fp);
+    //无效的缓存文件删掉，编译成功后会重新写入
+    if (invalid) remove(path.c_str());
+    return program;
+}
+
+static void SaveProgramBinary(GLuint program, const std::string &path, uint64_t key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    void *binary = malloc((size_t) length);
+    if (binary == nullptr) return;
+
+    ProgramBinaryHeader header;
+    GLsizei binaryLength = 0;
+    GLenum binaryFormat = GL_NONE;
+    glGetProgramBinary(program, length, &binaryLength, &binaryFormat, binary);
+    do {
+        if (binaryLength <= 0) break;
+        header.magic = PROGRAM_BINARY_MAGIC;
+        header.version = PROGRAM_BINARY_VERSION;
+        header.key = key;
+        header.binaryFormat = binaryFormat;
+        header.length = (uint32_t) binaryLength;
+
+        //先写临时文件再 rename，进程中途被杀也不会留下半个文件
+        std::string tmpPath = path + ".tmp";
+        FILE *fp = fopen(tmpPath.c_str(), "wb");
+        if (fp == nullptr) {
+            LOGCATE("GLUtils::SaveProgramBinary open fail, path=%s", tmpPath.c_str());
+            break;
+        }
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+                  && fwrite(binary, (size_t) binaryLength, 1, fp) == 1;
+        ok = fclose(fp) == 0 && ok;
+        if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            LOGCATE("GLUtils::SaveProgramBinary write fail, path=%s", path.c_str());
+            remove(tmpPath.c_str());
+        }
+    } while (false);
+    free(binary);
+}
 
 GLuint GLUtils::LoadShader(GLenum shaderType, const char *pSource)
 {
@@ -40,49 +207,81 @@ GLuint GLUtils::LoadShader(GLenum shaderType, const char *pSource)
 GLuint GLUtils::CreateProgram(const char *pVertexShaderSource, const char *pFragShaderSource, GLuint &vertexShaderHandle, GLuint &fragShaderHandle)
 {
     GLuint program = 0;
+    const char *cacheState = "off";
     FUN_BEGIN_TIME("GLUtils::CreateProgram")
-        vertexShaderHandle = LoadShader(GL_VERTEX_SHADER, pVertexShaderSource);
-        if (!vertexShaderHandle) return program;
-        fragShaderHandle = LoadShader(GL_FRAGMENT_SHADER, pFragShaderSource);
-        if (!fragShaderHandle) return program;
+        uint64_t key = 0;
+        std::string cachePath;
+        bool cacheEnabled = false;
+        if (pVertexShaderSource && pFragShaderSource) {
+            key = GetProgramKey(pVertexShaderSource, pFragShaderSource);
+            cacheEnabled = GetProgramCachePath(key, cachePath);
+        }
+        if (cacheEnabled) {
+            program = LoadProgramBinary(cachePath, key);
+            if (program) {
+                cacheState = "hit";
+                s_ProgramCacheHit++;
+                vertexShaderHandle = 0;
+                fragShaderHandle = 0;
+            } else {
+                cacheState = "miss";
+                s_ProgramCacheMiss++;
+            }
+        }
 
-        program = glCreateProgram();
-        if (program)
-        {
-            glAttachShader(program, vertexShaderHandle);
-            CheckGLError("glAttachShader");
-            glAttachShader(program, fragShaderHandle);
-            CheckGLError("glAttachShader");
-            glLinkProgram(program);
-            GLint linkStatus = GL_FALSE;
-            glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+        if (program == 0) {
+            vertexShaderHandle = LoadShader(GL_VERTEX_SHADER, pVertexShaderSource);
+            if (!vertexShaderHandle) return program;
+            fragShaderHandle = LoadShader(GL_FRAGMENT_SHADER, pFragShaderSource);
+            if (!fragShaderHandle) return program;
 
-            glDetachShader(program, vertexShaderHandle);
-            glDeleteShader(vertexShaderHandle);
-            vertexShaderHandle = 0;
-            glDetachShader(program, fragShaderHandle);
-            glDeleteShader(fragShaderHandle);
-            fragShaderHandle = 0;
-            if (linkStatus != GL_TRUE)
+            program = glCreateProgram();
+            if (program)
             {
-                GLint bufLength = 0;
-                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &bufLength);
-                if (bufLength)
+                glAttachShader(program, vertexShaderHandle);
+                CheckGLError("glAttachShader");
+                glAttachShader(program, fragShaderHandle);
+                CheckGLError("glAttachShader");
+                if (cacheEnabled)
                 {
-                    char* buf = (char*) malloc((size_t)bufLength);
-                    if (buf)
+                    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                }
+                glLinkProgram(program);
+                GLint linkStatus = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+
+                glDetachShader(program, vertexShaderHandle);
+                glDeleteShader(vertexShaderHandle);
+                vertexShaderHandle = 0;
+                glDetachShader(program, fragShaderHandle);
+                glDeleteShader(fragShaderHandle);
+                fragShaderHandle = 0;
+                if (linkStatus != GL_TRUE)
+                {
+                    GLint bufLength = 0;
+                    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &bufLength);
+                    if (bufLength)
                     {
-                        glGetProgramInfoLog(program, bufLength, NULL, buf);
-                        LOGCATE("GLUtils::CreateProgram Could not link program:\n%s\n", buf);
-                        free(buf);
+                        char* buf = (char*) malloc((size_t)bufLength);
+                        if (buf)
+                        {
+                            glGetProgramInfoLog(program, bufLength, NULL, buf);
+                            LOGCATE("GLUtils::CreateProgram Could not link program:\n%s\n", buf);
+                            free(buf);
+                        }
                     }
+                    glDeleteProgram(program);
+                    program = 0;
+                }
+                else if (cacheEnabled)
+                {
+                    SaveProgramBinary(program, cachePath, key);
                 }
-                glDeleteProgram(program);
-                program = 0;
             }
         }
     FUN_END_TIME("GLUtils::CreateProgram")
-    LOGCATE("GLUtils::CreateProgram program = %d", program);
+    LOGCATE("GLUtils::CreateProgram program = %d, binary cache %s [hit, miss]=[%d, %d]", program, cacheState,
+            s_ProgramCacheHit.load(), s_ProgramCacheMiss.load());
 	return program;
 }
 
@@ -152,6 +351,19 @@ void GLUtils::DeleteProgram(GLuint &program)
     }
 }
 
+void GLUtils::SetProgramCacheDir(const char *dir)
+{
+    LOGCATE("GLUtils::SetProgramCacheDir dir=%s", dir ? dir : "");
+    std::unique_lock<std::mutex> lock(s_ProgramCacheMutex);
+    s_ProgramCacheDir = dir ? dir : "";
+}
+
+void GLUtils::GetProgramCacheStats(int &hit, int &miss)
+{
+    hit = s_ProgramCacheHit.load();
+    miss = s_ProgramCacheMiss.load();
+}
+
 void GLUtils::CheckGLError(const char *pGLOperation)
 {
     for (GLint error = glGetError(); error; error = glGetError())
@@ -25,6 +25,12 @@ public:
 
     static void DeleteProgram(GLuint &program);
 
+    //程序二进制缓存目录，设置后 CreateProgram 优先从磁盘加载 glGetProgramBinary 的结果，传空关闭缓存
+    static void SetProgramCacheDir(const char *dir);
+
+    //进程内程序二进制缓存的累计命中/未命中次数，未设置缓存目录时不计数
+    static void GetProgramCacheStats(int &hit, int &miss);
+
     static void CheckGLError(const char *pGLOperation);
 
     static void setBool(GLuint programId, const std::string &name, bool value) {
@@ -13,11 +13,35 @@
 #include "stdint.h"
 #include "LogUtil.h"
 
+extern "C" {
+#include <libavutil/pixfmt.h>
+};
+
 #define IMAGE_FORMAT_RGBA           0x01
 #define IMAGE_FORMAT_NV21           0x02
 #define IMAGE_FORMAT_NV12           0x03
 #define IMAGE_FORMAT_I420           0x04
 
+//解码输出的 AVPixelFormat 对应的 IMAGE_FORMAT_XXX，渲染器可以直接处理这些格式；
+//返回 0 表示需要先用 sws_scale 转为 RGBA
+static inline int GetImageFormat(int pixelFormat)
+{
+	switch (pixelFormat)
+	{
+		case AV_PIX_FMT_YUV420P:
+		case AV_PIX_FMT_YUVJ420P:
+			return IMAGE_FORMAT_I420;
+		case AV_PIX_FMT_NV12:
+			return IMAGE_FORMAT_NV12;
+		case AV_PIX_FMT_NV21:
+			return IMAGE_FORMAT_NV21;
+		case AV_PIX_FMT_RGBA:
+			return IMAGE_FORMAT_RGBA;
+		default:
+			return 0;
+	}
+}
+
 #define IMAGE_FORMAT_RGBA_EXT       "RGB32"
 #define IMAGE_FORMAT_NV21_EXT       "NV21"
 #define IMAGE_FORMAT_NV12_EXT       "NV12"
@@ -111,8 +135,8 @@ public:
 
 	static void CopyNativeImage(NativeImage *pSrcImg, NativeImage *pDstImg)
 	{
-	    LOGCATE("NativeImageUtil::CopyNativeImage src[w,h,format]=[%d, %d, %d], dst[w,h,format]=[%d, %d, %d]", pSrcImg->width, pSrcImg->height, pSrcImg->format, pDstImg->width, pDstImg->height, pDstImg->format);
-        LOGCATE("NativeImageUtil::CopyNativeImage src[line0,line1,line2]=[%d, %d, %d], dst[line0,line1,line2]=[%d, %d, %d]", pSrcImg->pLineSize[0], pSrcImg->pLineSize[1], pSrcImg->pLineSize[2], pDstImg->pLineSize[0], pDstImg->pLineSize[1], pDstImg->pLineSize[2]);
+	    LOGCATT("NativeImageUtil::CopyNativeImage src[w,h,format]=[%d, %d, %d], dst[w,h,format]=[%d, %d, %d]", pSrcImg->width, pSrcImg->height, pSrcImg->format, pDstImg->width, pDstImg->height, pDstImg->format);
+        LOGCATT("NativeImageUtil::CopyNativeImage src[line0,line1,line2]=[%d, %d, %d], dst[line0,line1,line2]=[%d, %d, %d]", pSrcImg->pLineSize[0], pSrcImg->pLineSize[1], pSrcImg->pLineSize[2], pDstImg->pLineSize[0], pDstImg->pLineSize[1], pDstImg->pLineSize[2]);
 
         if(pSrcImg == nullptr || pSrcImg->ppPlane[0] == nullptr) return;
 
@@ -120,7 +144,7 @@ public:
 		   pSrcImg->width != pDstImg->width ||
 		   pSrcImg->height != pDstImg->height)
 		{
-			LOGCATE("NativeImageUtil::CopyNativeImage invalid params.");
+			LOGCAT_RATE_LIMIT(LOGCATE, 1000, "NativeImageUtil::CopyNativeImage invalid params.");
 			return;
 		}
 
@@ -204,7 +228,7 @@ public:
 				break;
 			default:
 			{
-				LOGCATE("NativeImageUtil::CopyNativeImage do not support the format. Format = %d", pSrcImg->format);
+				LOGCAT_RATE_LIMIT(LOGCATE, 1000, "NativeImageUtil::CopyNativeImage do not support the format. Format = %d", pSrcImg->format);
 			}
 				break;
 		}
@@ -0,0 +1,104 @@
+#ifndef LEARNFFMPEG_LATENCYHISTOGRAM_H
+#define LEARNFFMPEG_LATENCYHISTOGRAM_H
+
+#include <stdint.h>
+#include <atomic>
+
+//对数-线性分桶的延时直方图（HDR Histogram 的简化版），单位 us
+//每个 2 的幂区间划分为 32 个子桶，相对误差约 3%，记录操作无锁，可在多个线程中并发调用
+#define HISTOGRAM_SUB_BUCKET_BITS   5
+#define HISTOGRAM_SUB_BUCKET_COUNT  (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKET_COUNT      (HISTOGRAM_SUB_BUCKET_COUNT * 40)
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() {
+        Reset();
+    }
+
+    void Reset() {
+        for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i) {
+            m_Buckets[i].store(0, std::memory_order_relaxed);
+        }
+        m_Count.store(0, std::memory_order_relaxed);
+        m_Sum.store(0, std::memory_order_relaxed);
+        m_Max.store(0, std::memory_order_relaxed);
+    }
+
+    void Record(int64_t valueUs) {
+        if (valueUs < 0) valueUs = 0;
+        m_Buckets[BucketIndex(static_cast<uint64_t>(valueUs))].fetch_add(1, std::memory_order_relaxed);
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+        m_Sum.fetch_add(static_cast<uint64_t>(valueUs), std::memory_order_relaxed);
+        uint64_t max = m_Max.load(std::memory_order_relaxed);
+        while (static_cast<uint64_t>(valueUs) > max &&
+               !m_Max.compare_exchange_weak(max, static_cast<uint64_t>(valueUs), std::memory_order_relaxed)) {
+        }
+    }
+
+    int64_t GetCount() const {
+        return static_cast<int64_t>(m_Count.load(std::memory_order_relaxed));
+    }
+
+    int64_t GetMax() const {
+        return static_cast<int64_t>(m_Max.load(std::memory_order_relaxed));
+    }
+
+    int64_t GetMean() const {
+        uint64_t count = m_Count.load(std::memory_order_relaxed);
+        return count ? static_cast<int64_t>(m_Sum.load(std::memory_order_relaxed) / count) : 0;
+    }
+
+    //percentile 取值 [0, 100]，返回所在桶的中值
+    int64_t GetPercentile(double percentile) const {
+        uint64_t count = m_Count.load(std::memory_order_relaxed);
+        if (count == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(percentile / 100.0 * count + 0.5);
+        if (target < 1) target = 1;
+        if (target > count) target = count;
+
+        uint64_t accumulated = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i) {
+            accumulated += m_Buckets[i].load(std::memory_order_relaxed);
+            if (accumulated >= target) {
+                int64_t value = static_cast<int64_t>(BucketLowerBound(i) + (BucketWidth(i) >> 1));
+                return value < GetMax() ? value : GetMax();
+            }
+        }
+        return GetMax();
+    }
+
+private:
+    static int BucketIndex(uint64_t value) {
+        if (value < 2 * HISTOGRAM_SUB_BUCKET_COUNT) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+        int index = (shift + 1) * HISTOGRAM_SUB_BUCKET_COUNT + static_cast<int>(value >> shift) - HISTOGRAM_SUB_BUCKET_COUNT;
+        return index < HISTOGRAM_BUCKET_COUNT ? index : HISTOGRAM_BUCKET_COUNT - 1;
+    }
+
+    static uint64_t BucketLowerBound(int index) {
+        if (index < 2 * HISTOGRAM_SUB_BUCKET_COUNT) {
+            return static_cast<uint64_t>(index);
+        }
+        int shift = index / HISTOGRAM_SUB_BUCKET_COUNT - 1;
+        uint64_t sub = static_cast<uint64_t>(index % HISTOGRAM_SUB_BUCKET_COUNT + HISTOGRAM_SUB_BUCKET_COUNT);
+        return sub << shift;
+    }
+
+    static uint64_t BucketWidth(int index) {
+        if (index < 2 * HISTOGRAM_SUB_BUCKET_COUNT) {
+            return 1;
+        }
+        return static_cast<uint64_t>(1) << (index / HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    }
+
+    std::atomic<uint64_t> m_Buckets[HISTOGRAM_BUCKET_COUNT];
+    std::atomic<uint64_t> m_Count;
+    std::atomic<uint64_t> m_Sum;
+    std::atomic<uint64_t> m_Max;
+};
+
+#endif //LEARNFFMPEG_LATENCYHISTOGRAM_H
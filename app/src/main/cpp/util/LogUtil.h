@@ -5,15 +5,86 @@
 #ifndef BYTEFLOW_LOGUTIL_H
 #define BYTEFLOW_LOGUTIL_H
 
-#include<android/log.h>
-#include <sys/time.h>
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
 
 #define  LOG_TAG "ByteFlow"
 
-#define  LOGCATE(...)  __android_log_print(ANDROID_LOG_ERROR,LOG_TAG,__VA_ARGS__)
-#define  LOGCATV(...)  __android_log_print(ANDROID_LOG_VERBOSE,LOG_TAG,__VA_ARGS__)
-#define  LOGCATD(...)  __android_log_print(ANDROID_LOG_DEBUG,LOG_TAG,__VA_ARGS__)
-#define  LOGCATI(...)  __android_log_print(ANDROID_LOG_INFO,LOG_TAG,__VA_ARGS__)
+//日志级别，低于 LOG_LEVEL 的日志在编译期直接被移除，不产生任何格式化开销
+//LOG_LEVEL 由 CMake 选项 LOG_LEVEL 注入（TRACE/VERBOSE/DEBUG/INFO/ERROR），默认 DEBUG
+#define LOG_LEVEL_TRACE   0
+#define LOG_LEVEL_VERBOSE 1
+#define LOG_LEVEL_DEBUG   2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_ERROR   4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_NOOP(...) ((void)0)
+
+#ifdef __ANDROID__
+#include<android/log.h>
+
+#define  LOG_PRINT_E(...)  __android_log_print(ANDROID_LOG_ERROR,LOG_TAG,__VA_ARGS__)
+#define  LOG_PRINT_I(...)  __android_log_print(ANDROID_LOG_INFO,LOG_TAG,__VA_ARGS__)
+#define  LOG_PRINT_D(...)  __android_log_print(ANDROID_LOG_DEBUG,LOG_TAG,__VA_ARGS__)
+#define  LOG_PRINT_V(...)  __android_log_print(ANDROID_LOG_VERBOSE,LOG_TAG,__VA_ARGS__)
+#else
+//host build (desktop Linux), logs go to stderr
+#include <stdio.h>
+
+#define  HOST_LOG_PRINT(LEVEL, ...) do { \
+    fprintf(stderr, "%s %s: ", LEVEL, LOG_TAG); \
+    fprintf(stderr, __VA_ARGS__); \
+    fputc('\n', stderr); } while (0)
+
+#define  LOG_PRINT_E(...)  HOST_LOG_PRINT("E", __VA_ARGS__)
+#define  LOG_PRINT_I(...)  HOST_LOG_PRINT("I", __VA_ARGS__)
+#define  LOG_PRINT_D(...)  HOST_LOG_PRINT("D", __VA_ARGS__)
+#define  LOG_PRINT_V(...)  HOST_LOG_PRINT("V", __VA_ARGS__)
+#endif
+
+//LOGCATE 始终保留
+#define  LOGCATE(...)  LOG_PRINT_E(__VA_ARGS__)
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define  LOGCATI(...)  LOG_PRINT_I(__VA_ARGS__)
+#else
+#define  LOGCATI(...)  LOG_NOOP(__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define  LOGCATD(...)  LOG_PRINT_D(__VA_ARGS__)
+#else
+#define  LOGCATD(...)  LOG_NOOP(__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_VERBOSE
+#define  LOGCATV(...)  LOG_PRINT_V(__VA_ARGS__)
+#else
+#define  LOGCATV(...)  LOG_NOOP(__VA_ARGS__)
+#endif
+
+//TRACE 用于逐包、逐帧的日志，输出到 verbose 通道
+#if LOG_LEVEL <= LOG_LEVEL_TRACE
+#define  LOGCATT(...)  LOG_PRINT_V(__VA_ARGS__)
+#else
+#define  LOGCATT(...)  LOG_NOOP(__VA_ARGS__)
+#endif
+
+//运行期限流，同一调用点在 INTERVAL_MS 内最多输出一次，用于热路径上仍需保留的日志
+//LOG_MACRO 为 LOGCATE/LOGCATI 等，被编译期移除的级别不会产生任何开销
+#define LOGCAT_RATE_LIMIT(LOG_MACRO, INTERVAL_MS, ...) do { \
+    static std::atomic<int64_t> s_LastLogTime(0); \
+    int64_t now = GetSysCurrentTimeUs(); \
+    int64_t last = s_LastLogTime.load(std::memory_order_relaxed); \
+    if ((last == 0 || now - last >= (int64_t)(INTERVAL_MS) * 1000) && \
+        s_LastLogTime.compare_exchange_strong(last, now, std::memory_order_relaxed)) { \
+        LOG_MACRO(__VA_ARGS__); \
+    } } while (0)
 
 #define ByteFlowPrintE LOGCATE
 #define ByteFlowPrintV LOGCATV
@@ -22,26 +93,32 @@
 
 #define FUN_BEGIN_TIME(FUN) {\
     LOGCATE("%s:%s func start", __FILE__, FUN); \
-    long long t0 = GetSysCurrentTime();
+    int64_t t0 = GetSysCurrentTimeUs();
 
 #define FUN_END_TIME(FUN) \
-    long long t1 = GetSysCurrentTime(); \
-    LOGCATE("%s:%s func cost time %ldms", __FILE__, FUN, (long)(t1-t0));}
+    int64_t t1 = GetSysCurrentTimeUs(); \
+    LOGCATE("%s:%s func cost time %.3fms", __FILE__, FUN, (t1-t0) / 1000.0);}
 
 #define BEGIN_TIME(FUN) {\
     LOGCATE("%s func start", FUN); \
-    long long t0 = GetSysCurrentTime();
+    int64_t t0 = GetSysCurrentTimeUs();
 
 #define END_TIME(FUN) \
-    long long t1 = GetSysCurrentTime(); \
-    LOGCATE("%s func cost time %ldms", FUN, (long)(t1-t0));}
+    int64_t t1 = GetSysCurrentTimeUs(); \
+    LOGCATE("%s func cost time %.3fms", FUN, (t1-t0) / 1000.0);}
+
+//单调时钟，单位 us，不受系统时间修改影响，所有计时和音视频同步都应使用它
+static inline int64_t GetSysCurrentTimeUs()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (int64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
 
-static long long GetSysCurrentTime()
+//单调时钟，单位 ms
+static inline long long GetSysCurrentTime()
 {
-	struct timeval time;
-	gettimeofday(&time, NULL);
-	long long curTime = ((long long)(time.tv_sec))*1000+time.tv_usec/1000;
-	return curTime;
+	return GetSysCurrentTimeUs() / 1000;
 }
 
 #define GO_CHECK_GL_ERROR(...)   LOGCATE("CHECK_GL_ERROR %s glGetError = %d, line = %d, ",  __FUNCTION__, glGetError(), __LINE__)
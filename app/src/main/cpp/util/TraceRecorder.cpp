@@ -0,0 +1,102 @@
+#include "TraceRecorder.h"
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+TraceRecorder *TraceRecorder::GetInstance() {
+    static TraceRecorder s_Instance;
+    return &s_Instance;
+}
+
+//静态存储已清零，这里不逐个初始化槽位，未开启 trace 时缓冲区不占用物理内存
+TraceRecorder::TraceRecorder() : m_WriteIndex(0), m_Enabled(false) {
+}
+
+int TraceRecorder::GetThreadId() {
+    static thread_local int s_ThreadId = 0;
+    if (s_ThreadId == 0) {
+        s_ThreadId = static_cast<int>(syscall(SYS_gettid));
+    }
+    return s_ThreadId;
+}
+
+void TraceRecorder::Record(const char *name, int64_t beginUs, int64_t durationUs) {
+    uint64_t index = m_WriteIndex.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent &event = m_Events[index & (TRACE_BUFFER_CAPACITY - 1)];
+    //先标记为写入中，导出线程读到 0 或前后序号不一致时跳过该槽
+    event.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.beginUs.store(beginUs, std::memory_order_relaxed);
+    event.durationUs.store(durationUs, std::memory_order_relaxed);
+    event.tid.store(GetThreadId(), std::memory_order_relaxed);
+    event.seq.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::SetThreadName(const char *name) {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_ThreadNames[GetThreadId()] = name;
+}
+
+static void WriteJsonString(FILE *fp, const char *str) {
+    fputc('"', fp);
+    for (const char *p = str; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', fp);
+            fputc(*p, fp);
+        } else if ((unsigned char) *p < 0x20) {
+            fprintf(fp, "\\u%04x", *p);
+        } else {
+            fputc(*p, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+int TraceRecorder::DumpChromeTrace(const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (fp == nullptr) {
+        LOGCATE("TraceRecorder::DumpChromeTrace open %s fail", path);
+        return -1;
+    }
+
+    int pid = getpid();
+    int eventCount = 0;
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        for (std::map<int, std::string>::iterator it = m_ThreadNames.begin(); it != m_ThreadNames.end(); ++it) {
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                    eventCount++ ? ",\n" : "", pid, it->first);
+            WriteJsonString(fp, it->second.c_str());
+            fprintf(fp, "}}");
+        }
+    }
+
+    //从最旧的槽开始，按写入顺序导出
+    uint64_t writeIndex = m_WriteIndex.load(std::memory_order_acquire);
+    uint64_t start = writeIndex > TRACE_BUFFER_CAPACITY ? writeIndex - TRACE_BUFFER_CAPACITY : 0;
+    for (uint64_t index = start; index < writeIndex; ++index) {
+        TraceEvent &event = m_Events[index & (TRACE_BUFFER_CAPACITY - 1)];
+        uint64_t seq = event.seq.load(std::memory_order_acquire);
+        if (seq != index + 1) continue;
+        const char *name = event.name.load(std::memory_order_relaxed);
+        int64_t beginUs = event.beginUs.load(std::memory_order_relaxed);
+        int64_t durationUs = event.durationUs.load(std::memory_order_relaxed);
+        int tid = event.tid.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (event.seq.load(std::memory_order_relaxed) != seq) continue;
+
+        fprintf(fp, "%s{\"name\":", eventCount++ ? ",\n" : "");
+        WriteJsonString(fp, name);
+        fprintf(fp, ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%d}",
+                (long long) beginUs, (long long) durationUs, pid, tid);
+    }
+
+    fprintf(fp, "\n]}\n");
+    int result = ferror(fp) ? -1 : 0;
+    fclose(fp);
+    LOGCATE("TraceRecorder::DumpChromeTrace path=%s, events=%d, result=%d", path, eventCount, result);
+    return result;
+}
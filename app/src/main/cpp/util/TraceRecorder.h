@@ -0,0 +1,82 @@
+#ifndef LEARNFFMPEG_TRACERECORDER_H
+#define LEARNFFMPEG_TRACERECORDER_H
+
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <string>
+#include <LogUtil.h>
+
+//环形缓冲容量，须为 2 的幂，写满后覆盖最旧的事件
+#define TRACE_BUFFER_CAPACITY (64 * 1024)
+
+//一个已完成的耗时区间，对应 Chrome trace 的 "X" 事件；name 必须是字符串常量
+struct TraceEvent {
+    std::atomic<uint64_t> seq;          // 写入序号 + 1，0 表示空槽或正在写入
+    std::atomic<const char *> name;
+    std::atomic<int64_t> beginUs;
+    std::atomic<int64_t> durationUs;
+    std::atomic<int> tid;
+};
+
+//进程内全局的 trace 记录器，各线程无锁写入，按需导出为 Chrome trace JSON
+//（chrome://tracing 或 ui.perfetto.dev 打开）
+class TraceRecorder {
+public:
+    static TraceRecorder *GetInstance();
+
+    void SetEnabled(bool enabled) {
+        m_Enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled() const {
+        return m_Enabled.load(std::memory_order_relaxed);
+    }
+
+    void Record(const char *name, int64_t beginUs, int64_t durationUs);
+
+    //为当前线程命名，导出时显示为线程名
+    void SetThreadName(const char *name);
+
+    //导出当前缓冲中的事件，成功返回 0
+    int DumpChromeTrace(const char *path);
+
+    static int GetThreadId();
+
+private:
+    TraceRecorder();
+
+    TraceEvent m_Events[TRACE_BUFFER_CAPACITY];
+    std::atomic<uint64_t> m_WriteIndex;
+    std::atomic<bool> m_Enabled;
+
+    std::mutex m_Mutex;
+    std::map<int, std::string> m_ThreadNames;
+};
+
+//作用域耗时，未开启 trace 时只有一次原子读
+class TraceScope {
+public:
+    TraceScope(const char *name) : m_Name(name), m_BeginUs(0) {
+        if (TraceRecorder::GetInstance()->IsEnabled()) {
+            m_BeginUs = GetSysCurrentTimeUs();
+        }
+    }
+
+    ~TraceScope() {
+        if (m_BeginUs != 0) {
+            TraceRecorder::GetInstance()->Record(m_Name, m_BeginUs, GetSysCurrentTimeUs() - m_BeginUs);
+        }
+    }
+
+private:
+    const char *m_Name;
+    int64_t m_BeginUs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(NAME) TraceScope TRACE_CONCAT(traceScope, __LINE__)(NAME)
+#define TRACE_THREAD_NAME(NAME) TraceRecorder::GetInstance()->SetThreadName(NAME)
+
+#endif //LEARNFFMPEG_TRACERECORDER_H
@@ -0,0 +1,436 @@
+#include "YuvConverter.h"
+#include <math.h>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define YUV_HAS_NEON 1
+#if !defined(__aarch64__)
+#include <sys/auxv.h>
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YUV_HAS_X86 1
+#endif
+
+#define YUV_FIX_ROUND (1 << (YUV_FIX_SHIFT - 1))
+
+static inline uint8_t Clamp255(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline void YuvPixelToRgba(int y, int u, int v, uint8_t *rgba, const YuvConstants *k) {
+    int yy = (y - k->yOffset) * k->yGain + YUV_FIX_ROUND;
+    u -= 128;
+    v -= 128;
+    rgba[0] = Clamp255((yy + k->rv * v) >> YUV_FIX_SHIFT);
+    rgba[1] = Clamp255((yy - (k->gu * u + k->gv * v)) >> YUV_FIX_SHIFT);
+    rgba[2] = Clamp255((yy + k->bu * u) >> YUV_FIX_SHIFT);
+    rgba[3] = 255;
+}
+
+static void I420ToRgbaRow_C(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                            uint8_t *rgba, int width, const YuvConstants *k) {
+    for (int x = 0; x < width; ++x) {
+        YuvPixelToRgba(y[x], u[x >> 1], v[x >> 1], rgba + x * 4, k);
+    }
+}
+
+static void NVToRgbaRow_C(const uint8_t *y, const uint8_t *uv, uint8_t *rgba,
+                          int width, const YuvConstants *k, int swapUV) {
+    for (int x = 0; x < width; ++x) {
+        const uint8_t *p = uv + (x >> 1) * 2;
+        YuvPixelToRgba(y[x], p[swapUV], p[1 - swapUV], rgba + x * 4, k);
+    }
+}
+
+#if YUV_HAS_X86
+
+//8 个色度样本 u16/v16（已减 128）与 16 个亮度样本转 16 个 RGBA 像素
+static inline void YuvToRgba16_SSE2(__m128i y8, __m128i u16, __m128i v16, uint8_t *rgba, const YuvConstants *k) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i yOffset = _mm_set1_epi16(k->yOffset);
+    const __m128i yGain = _mm_set1_epi16(k->yGain);
+    const __m128i round = _mm_set1_epi16(YUV_FIX_ROUND);
+
+    __m128i rv = _mm_mullo_epi16(v16, _mm_set1_epi16(k->rv));
+    __m128i guv = _mm_add_epi16(_mm_mullo_epi16(u16, _mm_set1_epi16(k->gu)),
+                                _mm_mullo_epi16(v16, _mm_set1_epi16(k->gv)));
+    __m128i bu = _mm_mullo_epi16(u16, _mm_set1_epi16(k->bu));
+
+    __m128i yLo = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), yOffset), yGain), round);
+    __m128i yHi = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), yOffset), yGain), round);
+
+    //每个色度样本对应两个亮度样本
+    __m128i r8 = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_adds_epi16(yLo, _mm_unpacklo_epi16(rv, rv)), YUV_FIX_SHIFT),
+            _mm_srai_epi16(_mm_adds_epi16(yHi, _mm_unpackhi_epi16(rv, rv)), YUV_FIX_SHIFT));
+    __m128i g8 = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_subs_epi16(yLo, _mm_unpacklo_epi16(guv, guv)), YUV_FIX_SHIFT),
+            _mm_srai_epi16(_mm_subs_epi16(yHi, _mm_unpackhi_epi16(guv, guv)), YUV_FIX_SHIFT));
+    __m128i b8 = _mm_packus_epi16(
+            _mm_srai_epi16(_mm_adds_epi16(yLo, _mm_unpacklo_epi16(bu, bu)), YUV_FIX_SHIFT),
+            _mm_srai_epi16(_mm_adds_epi16(yHi, _mm_unpackhi_epi16(bu, bu)), YUV_FIX_SHIFT));
+    __m128i a8 = _mm_set1_epi8(-1);
+
+    __m128i rgLo = _mm_unpacklo_epi8(r8, g8);
+    __m128i rgHi = _mm_unpackhi_epi8(r8, g8);
+    __m128i baLo = _mm_unpacklo_epi8(b8, a8);
+    __m128i baHi = _mm_unpackhi_epi8(b8, a8);
+    _mm_storeu_si128((__m128i *) (rgba), _mm_unpacklo_epi16(rgLo, baLo));
+    _mm_storeu_si128((__m128i *) (rgba + 16), _mm_unpackhi_epi16(rgLo, baLo));
+    _mm_storeu_si128((__m128i *) (rgba + 32), _mm_unpacklo_epi16(rgHi, baHi));
+    _mm_storeu_si128((__m128i *) (rgba + 48), _mm_unpackhi_epi16(rgHi, baHi));
+}
+
+static void I420ToRgbaRow_SSE2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                               uint8_t *rgba, int width, const YuvConstants *k) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i y8 = _mm_loadu_si128((const __m128i *) (y + x));
+        __m128i u16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (u + x / 2)), zero), c128);
+        __m128i v16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (v + x / 2)), zero), c128);
+        YuvToRgba16_SSE2(y8, u16, v16, rgba + x * 4, k);
+    }
+    I420ToRgbaRow_C(y + x, u + x / 2, v + x / 2, rgba + x * 4, width - x, k);
+}
+
+static void NVToRgbaRow_SSE2(const uint8_t *y, const uint8_t *uv, uint8_t *rgba,
+                             int width, const YuvConstants *k, int swapUV) {
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    const __m128i c128 = _mm_set1_epi16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i y8 = _mm_loadu_si128((const __m128i *) (y + x));
+        __m128i uv8 = _mm_loadu_si128((const __m128i *) (uv + x));
+        __m128i c0 = _mm_sub_epi16(_mm_and_si128(uv8, lowMask), c128);
+        __m128i c1 = _mm_sub_epi16(_mm_srli_epi16(uv8, 8), c128);
+        YuvToRgba16_SSE2(y8, swapUV ? c1 : c0, swapUV ? c0 : c1, rgba + x * 4, k);
+    }
+    NVToRgbaRow_C(y + x, uv + x, rgba + x * 4, width - x, k, swapUV);
+}
+
+//AVX2 的 unpack/pack 在 128 位通道内进行，先按 64 位重排再交织，保证输出像素顺序
+__attribute__((target("avx2")))
+static inline void YuvToRgba32_AVX2(__m256i yLo8, __m256i yHi8, __m256i u16, __m256i v16,
+                                    uint8_t *rgba, const YuvConstants *k) {
+    const __m256i yOffset = _mm256_set1_epi16(k->yOffset);
+    const __m256i yGain = _mm256_set1_epi16(k->yGain);
+    const __m256i round = _mm256_set1_epi16(YUV_FIX_ROUND);
+
+    __m256i rv = _mm256_mullo_epi16(v16, _mm256_set1_epi16(k->rv));
+    __m256i guv = _mm256_add_epi16(_mm256_mullo_epi16(u16, _mm256_set1_epi16(k->gu)),
+                                   _mm256_mullo_epi16(v16, _mm256_set1_epi16(k->gv)));
+    __m256i bu = _mm256_mullo_epi16(u16, _mm256_set1_epi16(k->bu));
+    rv = _mm256_permute4x64_epi64(rv, 0xD8);
+    guv = _mm256_permute4x64_epi64(guv, 0xD8);
+    bu = _mm256_permute4x64_epi64(bu, 0xD8);
+
+    //yLo8/yHi8 为像素 0-15 / 16-31 零扩展后的 16 位值
+    __m256i yLo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(yLo8, yOffset), yGain), round);
+    __m256i yHi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(yHi8, yOffset), yGain), round);
+
+    __m256i r8 = _mm256_packus_epi16(
+            _mm256_srai_epi16(_mm256_adds_epi16(yLo, _mm256_unpacklo_epi16(rv, rv)), YUV_FIX_SHIFT),
+            _mm256_srai_epi16(_mm256_adds_epi16(yHi, _mm256_unpackhi_epi16(rv, rv)), YUV_FIX_SHIFT));
+    __m256i g8 = _mm256_packus_epi16(
+            _mm256_srai_epi16(_mm256_subs_epi16(yLo, _mm256_unpacklo_epi16(guv, guv)), YUV_FIX_SHIFT),
+            _mm256_srai_epi16(_mm256_subs_epi16(yHi, _mm256_unpackhi_epi16(guv, guv)), YUV_FIX_SHIFT));
+    __m256i b8 = _mm256_packus_epi16(
+            _mm256_srai_epi16(_mm256_adds_epi16(yLo, _mm256_unpacklo_epi16(bu, bu)), YUV_FIX_SHIFT),
+            _mm256_srai_epi16(_mm256_adds_epi16(yHi, _mm256_unpackhi_epi16(bu, bu)), YUV_FIX_SHIFT));
+    __m256i a8 = _mm256_set1_epi8(-1);
+
+    __m256i rgLo = _mm256_unpacklo_epi8(r8, g8);
+    __m256i rgHi = _mm256_unpackhi_epi8(r8, g8);
+    __m256i baLo = _mm256_unpacklo_epi8(b8, a8);
+    __m256i baHi = _mm256_unpackhi_epi8(b8, a8);
+    __m256i p0 = _mm256_unpacklo_epi16(rgLo, baLo);
+    __m256i p1 = _mm256_unpackhi_epi16(rgLo, baLo);
+    __m256i p2 = _mm256_unpacklo_epi16(rgHi, baHi);
+    __m256i p3 = _mm256_unpackhi_epi16(rgHi, baHi);
+    _mm256_storeu_si256((__m256i *) (rgba), _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256((__m256i *) (rgba + 32), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256((__m256i *) (rgba + 64), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256((__m256i *) (rgba + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void I420ToRgbaRow_AVX2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                               uint8_t *rgba, int width, const YuvConstants *k) {
+    const __m256i c128 = _mm256_set1_epi16(128);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i yLo = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (y + x)));
+        __m256i yHi = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (y + x + 16)));
+        __m256i u16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (u + x / 2))), c128);
+        __m256i v16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (v + x / 2))), c128);
+        YuvToRgba32_AVX2(yLo, yHi, u16, v16, rgba + x * 4, k);
+    }
+    I420ToRgbaRow_SSE2(y + x, u + x / 2, v + x / 2, rgba + x * 4, width - x, k);
+}
+
+__attribute__((target("avx2")))
+static void NVToRgbaRow_AVX2(const uint8_t *y, const uint8_t *uv, uint8_t *rgba,
+                             int width, const YuvConstants *k, int swapUV) {
+    const __m256i lowMask = _mm256_set1_epi16(0x00FF);
+    const __m256i c128 = _mm256_set1_epi16(128);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i yLo = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (y + x)));
+        __m256i yHi = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) (y + x + 16)));
+        __m256i uv8 = _mm256_loadu_si256((const __m256i *) (uv + x));
+        __m256i c0 = _mm256_sub_epi16(_mm256_and_si256(uv8, lowMask), c128);
+        __m256i c1 = _mm256_sub_epi16(_mm256_srli_epi16(uv8, 8), c128);
+        YuvToRgba32_AVX2(yLo, yHi, swapUV ? c1 : c0, swapUV ? c0 : c1, rgba + x * 4, k);
+    }
+    NVToRgbaRow_SSE2(y + x, uv + x, rgba + x * 4, width - x, k, swapUV);
+}
+
+#endif //YUV_HAS_X86
+
+#if YUV_HAS_NEON
+
+static inline void YuvToRgba16_NEON(uint8x16_t y8, int16x8_t u16, int16x8_t v16, uint8_t *rgba, const YuvConstants *k) {
+    const int16x8_t yOffset = vdupq_n_s16(k->yOffset);
+    const int16x8_t yGain = vdupq_n_s16(k->yGain);
+    const int16x8_t round = vdupq_n_s16(YUV_FIX_ROUND);
+
+    int16x8_t rv = vmulq_n_s16(v16, k->rv);
+    int16x8_t guv = vaddq_s16(vmulq_n_s16(u16, k->gu), vmulq_n_s16(v16, k->gv));
+    int16x8_t bu = vmulq_n_s16(u16, k->bu);
+    int16x8x2_t rv2 = vzipq_s16(rv, rv);
+    int16x8x2_t guv2 = vzipq_s16(guv, guv);
+    int16x8x2_t bu2 = vzipq_s16(bu, bu);
+
+    int16x8_t yLo = vaddq_s16(vmulq_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8))), yOffset), yGain), round);
+    int16x8_t yHi = vaddq_s16(vmulq_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8))), yOffset), yGain), round);
+
+    uint8x16x4_t out;
+    out.val[0] = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(yLo, rv2.val[0]), YUV_FIX_SHIFT)),
+                             vqmovun_s16(vshrq_n_s16(vqaddq_s16(yHi, rv2.val[1]), YUV_FIX_SHIFT)));
+    out.val[1] = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqsubq_s16(yLo, guv2.val[0]), YUV_FIX_SHIFT)),
+                             vqmovun_s16(vshrq_n_s16(vqsubq_s16(yHi, guv2.val[1]), YUV_FIX_SHIFT)));
+    out.val[2] = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(yLo, bu2.val[0]), YUV_FIX_SHIFT)),
+                             vqmovun_s16(vshrq_n_s16(vqaddq_s16(yHi, bu2.val[1]), YUV_FIX_SHIFT)));
+    out.val[3] = vdupq_n_u8(255);
+    vst4q_u8(rgba, out);
+}
+
+static void I420ToRgbaRow_NEON(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                               uint8_t *rgba, int width, const YuvConstants *k) {
+    const int16x8_t c128 = vdupq_n_s16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t y8 = vld1q_u8(y + x);
+        int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x / 2))), c128);
+        int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x / 2))), c128);
+        YuvToRgba16_NEON(y8, u16, v16, rgba + x * 4, k);
+    }
+    I420ToRgbaRow_C(y + x, u + x / 2, v + x / 2, rgba + x * 4, width - x, k);
+}
+
+static void NVToRgbaRow_NEON(const uint8_t *y, const uint8_t *uv, uint8_t *rgba,
+                             int width, const YuvConstants *k, int swapUV) {
+    const int16x8_t c128 = vdupq_n_s16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t y8 = vld1q_u8(y + x);
+        uint8x8x2_t uv8 = vld2_u8(uv + x);
+        int16x8_t c0 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uv8.val[0])), c128);
+        int16x8_t c1 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uv8.val[1])), c128);
+        YuvToRgba16_NEON(y8, swapUV ? c1 : c0, swapUV ? c0 : c1, rgba + x * 4, k);
+    }
+    NVToRgbaRow_C(y + x, uv + x, rgba + x * 4, width - x, k, swapUV);
+}
+
+#endif //YUV_HAS_NEON
+
+struct YuvRowFuncs {
+    I420ToRgbaRowFunc i420Row;
+    NVToRgbaRowFunc nvRow;
+    const char *name;
+};
+
+#define YUV_ROW_FUNCS_MAX 3
+
+//当前 CPU 支持的实现，按优先级从低到高排列，第一个总是 C
+static int GetSupportedRowFuncs(YuvRowFuncs funcs[YUV_ROW_FUNCS_MAX]) {
+    int count = 0;
+    funcs[count++] = {I420ToRgbaRow_C, NVToRgbaRow_C, "c"};
+#if YUV_HAS_NEON
+#if defined(__aarch64__)
+    bool hasNeon = true;
+#else
+    bool hasNeon = (getauxval(AT_HWCAP) & (1 << 12)) != 0; // HWCAP_NEON
+#endif
+    if (hasNeon) {
+        funcs[count++] = {I420ToRgbaRow_NEON, NVToRgbaRow_NEON, "neon"};
+    }
+#elif YUV_HAS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        funcs[count++] = {I420ToRgbaRow_SSE2, NVToRgbaRow_SSE2, "sse2"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        funcs[count++] = {I420ToRgbaRow_AVX2, NVToRgbaRow_AVX2, "avx2"};
+    }
+#endif
+    return count;
+}
+
+static YuvRowFuncs DetectRowFuncs() {
+    YuvRowFuncs funcs[YUV_ROW_FUNCS_MAX];
+    int count = GetSupportedRowFuncs(funcs);
+    return funcs[count - 1];
+}
+
+static YuvRowFuncs &GetRowFuncs() {
+    static YuvRowFuncs s_RowFuncs = DetectRowFuncs();
+    return s_RowFuncs;
+}
+
+//水平线性插值缩放一行 RGBA，16.16 定点，像素中心对齐
+static void ScaleRgbaRow(const uint8_t *src, int srcWidth, uint8_t *dst, int dstWidth) {
+    int64_t step = ((int64_t) srcWidth << 16) / dstWidth;
+    int64_t x = step / 2 - (1 << 15);
+    for (int i = 0; i < dstWidth; ++i, x += step) {
+        int xi = 0;
+        int frac = 0;
+        if (x > 0) {
+            xi = (int) (x >> 16);
+            frac = (int) ((x >> 8) & 0xFF);
+        }
+        if (xi >= srcWidth - 1) {
+            xi = srcWidth - 1;
+            frac = 0;
+        }
+        const uint8_t *p0 = src + xi * 4;
+        const uint8_t *p1 = frac ? p0 + 4 : p0;
+        uint8_t *out = dst + i * 4;
+        out[0] = (uint8_t) ((p0[0] * (256 - frac) + p1[0] * frac) >> 8);
+        out[1] = (uint8_t) ((p0[1] * (256 - frac) + p1[1] * frac) >> 8);
+        out[2] = (uint8_t) ((p0[2] * (256 - frac) + p1[2] * frac) >> 8);
+        out[3] = (uint8_t) ((p0[3] * (256 - frac) + p1[3] * frac) >> 8);
+    }
+}
+
+YuvConverter::YuvConverter() {
+    GetYuvConstants(YUV_COLOR_SPACE_BT601, YUV_COLOR_RANGE_LIMITED, &m_Constants);
+}
+
+YuvConverter::~YuvConverter() {
+    if (m_RowBuffer != nullptr) {
+        free(m_RowBuffer);
+        m_RowBuffer = nullptr;
+    }
+}
+
+const char *YuvConverter::GetSimdName() {
+    return GetRowFuncs().name;
+}
+
+int YuvConverter::SetSimd(const char *name) {
+    YuvRowFuncs funcs[YUV_ROW_FUNCS_MAX];
+    int count = GetSupportedRowFuncs(funcs);
+    for (int i = 0; i < count; ++i) {
+        if (name != nullptr && strcmp(funcs[i].name, name) == 0) {
+            GetRowFuncs() = funcs[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void YuvConverter::GetYuvConstants(int colorSpace, int colorRange, YuvConstants *k) {
+    //R = Y + rv*V, G = Y - gu*U - gv*V, B = Y + bu*U
+    double kr = 0.299, kb = 0.114;
+    if (colorSpace == YUV_COLOR_SPACE_BT709) {
+        kr = 0.2126;
+        kb = 0.0722;
+    }
+    double kg = 1.0 - kr - kb;
+    double rv = 2.0 * (1.0 - kr);
+    double bu = 2.0 * (1.0 - kb);
+    double gu = bu * kb / kg;
+    double gv = rv * kr / kg;
+
+    double yGain = 1.0, uvGain = 1.0;
+    k->yOffset = 0;
+    if (colorRange == YUV_COLOR_RANGE_LIMITED) {
+        yGain = 255.0 / 219.0;
+        uvGain = 255.0 / 224.0;
+        k->yOffset = 16;
+    }
+    const double scale = 1 << YUV_FIX_SHIFT;
+    k->yGain = (int16_t) lround(yGain * scale);
+    k->rv = (int16_t) lround(rv * uvGain * scale);
+    k->gu = (int16_t) lround(gu * uvGain * scale);
+    k->gv = (int16_t) lround(gv * uvGain * scale);
+    k->bu = (int16_t) lround(bu * uvGain * scale);
+}
+
+void YuvConverter::SetColorSpace(int colorSpace, int colorRange) {
+    GetYuvConstants(colorSpace, colorRange, &m_Constants);
+}
+
+void YuvConverter::ConvertRow(const NativeImage *src, int srcY, uint8_t *rgba) {
+    const YuvRowFuncs &funcs = GetRowFuncs();
+    const uint8_t *y = src->ppPlane[0] + srcY * src->pLineSize[0];
+    switch (src->format) {
+        case IMAGE_FORMAT_I420:
+            funcs.i420Row(y, src->ppPlane[1] + (srcY >> 1) * src->pLineSize[1],
+                          src->ppPlane[2] + (srcY >> 1) * src->pLineSize[2], rgba, src->width, &m_Constants);
+            break;
+        case IMAGE_FORMAT_NV12:
+        case IMAGE_FORMAT_NV21:
+            funcs.nvRow(y, src->ppPlane[1] + (srcY >> 1) * src->pLineSize[1], rgba, src->width, &m_Constants,
+                        src->format == IMAGE_FORMAT_NV21);
+            break;
+        case IMAGE_FORMAT_RGBA:
+            memcpy(rgba, y, src->width * 4);
+            break;
+        default:
+            break;
+    }
+}
+
+int YuvConverter::ConvertToRgba(const NativeImage *src, uint8_t *dst, int dstStride, int dstWidth, int dstHeight) {
+    if (src == nullptr || dst == nullptr || src->ppPlane[0] == nullptr
+        || src->width <= 0 || src->height <= 0 || dstWidth <= 0 || dstHeight <= 0) {
+        return -1;
+    }
+    if (src->format != IMAGE_FORMAT_I420 && src->format != IMAGE_FORMAT_NV12
+        && src->format != IMAGE_FORMAT_NV21 && src->format != IMAGE_FORMAT_RGBA) {
+        LOGCAT_RATE_LIMIT(LOGCATE, 1000, "YuvConverter::ConvertToRgba do not support the format. Format = %d", src->format);
+        return -1;
+    }
+
+    //宽度相同时直接转换到目标行，否则先转换到行缓冲再水平缩放
+    bool scaleX = src->width != dstWidth;
+    if (scaleX && m_RowBufferSize < src->width * 4) {
+        if (m_RowBuffer != nullptr) free(m_RowBuffer);
+        m_RowBufferSize = src->width * 4;
+        m_RowBuffer = static_cast<uint8_t *>(malloc(m_RowBufferSize));
+    }
+
+    int lastSrcY = -1;
+    for (int dy = 0; dy < dstHeight; ++dy) {
+        uint8_t *dstRow = dst + dy * dstStride;
+        int srcY = (int) (((int64_t) (2 * dy + 1) * src->height) / (2 * dstHeight));
+        if (srcY == lastSrcY) {
+            //垂直放大时相邻目标行对应同一源行，直接复制
+            memcpy(dstRow, dstRow - dstStride, dstWidth * 4);
+            continue;
+        }
+        lastSrcY = srcY;
+        if (scaleX) {
+            ConvertRow(src, srcY, m_RowBuffer);
+            ScaleRgbaRow(m_RowBuffer, src->width, dstRow, dstWidth);
+        } else {
+            ConvertRow(src, srcY, dstRow);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef LEARNFFMPEG_YUVCONVERTER_H
+#define LEARNFFMPEG_YUVCONVERTER_H
+
+#include "ImageDef.h"
+
+#define YUV_COLOR_SPACE_BT601       0
+#define YUV_COLOR_SPACE_BT709       1
+
+#define YUV_COLOR_RANGE_LIMITED     0   // Y [16, 235], UV [16, 240]
+#define YUV_COLOR_RANGE_FULL        1   // Y/UV [0, 255]
+
+//定点系数，放大 2^YUV_FIX_SHIFT 倍
+#define YUV_FIX_SHIFT               6
+
+struct YuvConstants {
+    int16_t yOffset;
+    int16_t yGain;
+    int16_t rv;
+    int16_t gu;
+    int16_t gv;
+    int16_t bu;
+};
+
+typedef void (*I420ToRgbaRowFunc)(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                  uint8_t *rgba, int width, const YuvConstants *k);
+typedef void (*NVToRgbaRowFunc)(const uint8_t *y, const uint8_t *uv, uint8_t *rgba,
+                                int width, const YuvConstants *k, int swapUV);
+
+//I420/NV12/NV21/RGBA -> RGBA 的颜色转换与缩放，直接写入目标缓冲（如 ANativeWindow_Buffer）。
+//颜色转换按 CPU 特性在运行时选择 NEON/AVX2/SSE2/C 实现；缩放为水平线性、垂直最近邻
+class YuvConverter {
+public:
+    YuvConverter();
+    ~YuvConverter();
+
+    void SetColorSpace(int colorSpace, int colorRange);
+
+    //dstStride 为目标每行字节数，成功返回 0
+    int ConvertToRgba(const NativeImage *src, uint8_t *dst, int dstStride, int dstWidth, int dstHeight);
+
+    //当前使用的实现，"neon" "avx2" "sse2" "c"
+    static const char *GetSimdName();
+
+    //强制使用指定实现，供各实现的一致性测试使用；须在没有转换进行时调用，
+    //编译目标或当前 CPU 不支持该实现时返回 -1
+    static int SetSimd(const char *name);
+
+    static void GetYuvConstants(int colorSpace, int colorRange, YuvConstants *k);
+
+private:
+    void ConvertRow(const NativeImage *src, int srcY, uint8_t *rgba);
+
+    YuvConstants m_Constants;
+    uint8_t *m_RowBuffer = nullptr;
+    int m_RowBufferSize = 0;
+};
+
+#endif //LEARNFFMPEG_YUVCONVERTER_H
@@ -52,6 +52,7 @@ public class MainActivity extends AppCompatActivity {
         super.onCreate(savedInstanceState);
         setContentView(R.layout.activity_main);
         ((TextView)findViewById(R.id.text_view)).setText("FFmpeg Version Info:\n" + FFMediaPlayer.GetFFmpegVersion());
+        FFMediaPlayer.SetProgramCacheDir(getCacheDir().getAbsolutePath());
 
     }
 
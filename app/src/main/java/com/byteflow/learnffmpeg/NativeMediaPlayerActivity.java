@@ -27,6 +27,8 @@ import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_DECODER_INIT_ERRO
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_DECODER_READY;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_DECODING_TIME;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_REQUEST_RENDER;
+import static com.byteflow.learnffmpeg.media.FFMediaPlayer.SEEK_MODE_ACCURATE;
+import static com.byteflow.learnffmpeg.media.FFMediaPlayer.SEEK_MODE_SCRUB;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.VIDEO_RENDER_ANWINDOW;
 
 public class NativeMediaPlayerActivity extends AppCompatActivity implements SurfaceHolder.Callback, FFMediaPlayer.EventCallback{
@@ -51,7 +53,9 @@ public class NativeMediaPlayerActivity extends AppCompatActivity implements Surf
         mSeekBar.setOnSeekBarChangeListener(new SeekBar.OnSeekBarChangeListener() {
             @Override
             public void onProgressChanged(SeekBar seekBar, int i, boolean b) {
-
+                if(b && mMediaPlayer != null) {
+                    mMediaPlayer.seekToPosition(i, SEEK_MODE_SCRUB);
+                }
             }
 
             @Override
@@ -63,7 +67,7 @@ public class NativeMediaPlayerActivity extends AppCompatActivity implements Surf
             public void onStopTrackingTouch(SeekBar seekBar) {
                 Log.d(TAG, "onStopTrackingTouch() called with: progress = [" + seekBar.getProgress() + "]");
                 if(mMediaPlayer != null) {
-                    mMediaPlayer.seekToPosition(mSeekBar.getProgress());
+                    mMediaPlayer.seekToPosition(mSeekBar.getProgress(), SEEK_MODE_ACCURATE);
                     mIsTouch = false;
                 }
 
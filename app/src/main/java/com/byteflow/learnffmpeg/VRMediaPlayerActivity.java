@@ -29,6 +29,8 @@ import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_DECODER_INIT_ERRO
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_DECODER_READY;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_DECODING_TIME;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.MSG_REQUEST_RENDER;
+import static com.byteflow.learnffmpeg.media.FFMediaPlayer.SEEK_MODE_ACCURATE;
+import static com.byteflow.learnffmpeg.media.FFMediaPlayer.SEEK_MODE_SCRUB;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.VIDEO_GL_RENDER;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.VIDEO_RENDER_3D_VR;
 import static com.byteflow.learnffmpeg.media.FFMediaPlayer.VIDEO_RENDER_OPENGL;
@@ -59,7 +61,9 @@ public class VRMediaPlayerActivity extends AppCompatActivity implements GLSurfac
         mSeekBar.setOnSeekBarChangeListener(new SeekBar.OnSeekBarChangeListener() {
             @Override
             public void onProgressChanged(SeekBar seekBar, int i, boolean b) {
-
+                if(b && mMediaPlayer != null) {
+                    mMediaPlayer.seekToPosition(i, SEEK_MODE_SCRUB);
+                }
             }
 
             @Override
@@ -71,7 +75,7 @@ public class VRMediaPlayerActivity extends AppCompatActivity implements GLSurfac
             public void onStopTrackingTouch(SeekBar seekBar) {
                 Log.d(TAG, "onStopTrackingTouch() called with: progress = [" + seekBar.getProgress() + "]");
                 if(mMediaPlayer != null) {
-                    mMediaPlayer.seekToPosition(mSeekBar.getProgress());
+                    mMediaPlayer.seekToPosition(mSeekBar.getProgress(), SEEK_MODE_ACCURATE);
                     mIsTouch = false;
                 }
 
@@ -22,6 +22,48 @@ public class FFMediaPlayer {
     public static final int MEDIA_PARAM_VIDEO_HEIGHT    = 0x0002;
     public static final int MEDIA_PARAM_VIDEO_DURATION  = 0x0003;
 
+    //getStatsSnapshot() 返回数组的下标，与 native PlayerStats.h 保持一致
+    public static final int STATS_DEMUXED_PACKETS               = 0;
+    public static final int STATS_DECODED_VIDEO_FRAMES          = 1;
+    public static final int STATS_DECODED_AUDIO_FRAMES          = 2;
+    public static final int STATS_RENDERED_VIDEO_FRAMES         = 3;
+    public static final int STATS_DROPPED_VIDEO_FRAMES          = 4;
+    public static final int STATS_AUDIO_UNDERRUNS               = 5;
+    public static final int STATS_VIDEO_PACKET_QUEUE_PEAK_BYTES = 6;
+    public static final int STATS_AUDIO_PACKET_QUEUE_PEAK_BYTES = 7;
+    public static final int STATS_VIDEO_FRAME_QUEUE_PEAK        = 8;
+    public static final int STATS_SKIPPED_VIDEO_FRAMES          = 9;
+    public static final int STATS_VIDEO_SKIP_LEVEL              = 10;
+    public static final int STATS_VIDEO_SKIP_LEVEL_PEAK         = 11;
+    public static final int STATS_SEEKS                         = 12;
+    public static final int STATS_COALESCED_SEEKS               = 13;
+    public static final int STATS_SEEK_DISCARDED_VIDEO_FRAMES   = 14;
+    public static final int STATS_VIDEO_POOLED_BUFFERS          = 15;
+    public static final int STATS_VIDEO_FALLBACK_BUFFERS        = 16;
+    public static final int STATS_COUNTER_NUM                   = 17;
+
+    //阶段耗时（us），下标为 STATS_COUNTER_NUM + stage * STATS_STAGE_STAT_NUM + stat
+    public static final int STATS_STAGE_DEMUX                   = 0;
+    public static final int STATS_STAGE_VIDEO_DECODE            = 1;
+    public static final int STATS_STAGE_AUDIO_DECODE            = 2;
+    public static final int STATS_STAGE_VIDEO_CONVERT           = 3;
+    public static final int STATS_STAGE_AUDIO_CONVERT           = 4;
+    public static final int STATS_STAGE_VIDEO_RENDER            = 5;
+    public static final int STATS_STAGE_AUDIO_RENDER            = 6;
+
+    public static final int STATS_STAGE_STAT_COUNT              = 0;
+    public static final int STATS_STAGE_STAT_MEAN               = 1;
+    public static final int STATS_STAGE_STAT_P50                = 2;
+    public static final int STATS_STAGE_STAT_P90                = 3;
+    public static final int STATS_STAGE_STAT_P99                = 4;
+    public static final int STATS_STAGE_STAT_MAX                = 5;
+    public static final int STATS_STAGE_STAT_NUM                = 6;
+
+    //seekToPosition 的定位方式，与 native PlayerState.h 中的 SeekMode 一致
+    public static final int SEEK_MODE_DEFAULT           = 0;
+    public static final int SEEK_MODE_SCRUB             = 1;    // 拖动进度条过程中，定位到最近的关键帧并立即显示
+    public static final int SEEK_MODE_ACCURATE          = 2;    // 松开进度条时，解码到精确位置再显示
+
     public static final int VIDEO_RENDER_OPENGL         = 0;
     public static final int VIDEO_RENDER_ANWINDOW       = 1;
     public static final int VIDEO_RENDER_3D_VR          = 2;
@@ -34,6 +76,11 @@ public class FFMediaPlayer {
         return native_GetFFmpegVersion();
     }
 
+    //GL 着色器程序二进制缓存目录，需在 GL 渲染的 Surface 创建前设置，传 null 关闭缓存
+    public static void SetProgramCacheDir(String dir) {
+        native_SetProgramCacheDir(dir);
+    }
+
     public void init(String url, int videoRenderType, Surface surface) {
         mNativePlayerHandle = native_Init(url, videoRenderType, surface);
     }
@@ -47,7 +94,12 @@ public class FFMediaPlayer {
     }
 
     public void seekToPosition(float position) {
-        native_SeekToPosition(mNativePlayerHandle, position);
+        native_SeekToPosition(mNativePlayerHandle, position, SEEK_MODE_DEFAULT);
+    }
+
+    //不阻塞，上一次 seek 尚未执行时只保留最新的目标
+    public void seekToPosition(float position, int seekMode) {
+        native_SeekToPosition(mNativePlayerHandle, position, seekMode);
     }
 
     public void stop() {
@@ -66,6 +118,14 @@ public class FFMediaPlayer {
         return native_GetMediaParams(mNativePlayerHandle, paramType);
     }
 
+    public long[] getStatsSnapshot() {
+        return native_GetStatsSnapshot(mNativePlayerHandle);
+    }
+
+    public static long getStageStat(long[] snapshot, int stage, int stat) {
+        return snapshot[STATS_COUNTER_NUM + stage * STATS_STAGE_STAT_NUM + stat];
+    }
+
     private void playerEventCallback(int msgType, float msgValue) {
         if(mEventCallback != null)
             mEventCallback.onPlayerEvent(msgType, msgValue);
@@ -78,7 +138,7 @@ public class FFMediaPlayer {
 
     private native void native_Play(long playerHandle);
 
-    private native void native_SeekToPosition(long playerHandle, float position);
+    private native void native_SeekToPosition(long playerHandle, float position, int seekMode);
 
     private native void native_Pause(long playerHandle);
 
@@ -88,6 +148,8 @@ public class FFMediaPlayer {
 
     private native long native_GetMediaParams(long playerHandle, int paramType);
 
+    private native long[] native_GetStatsSnapshot(long playerHandle);
+
     //for GL render
     public static native void native_OnSurfaceCreated(int renderType);
     public static native void native_OnSurfaceChanged(int renderType, int width, int height);
@@ -96,6 +158,12 @@ public class FFMediaPlayer {
     public static native void native_SetGesture(int renderType, float xRotateAngle, float yRotateAngle, float scale);
     public static native void native_SetTouchLoc(int renderType, float touchX, float touchY);
 
+    //trace 记录，导出为 Chrome trace JSON，可用 chrome://tracing 或 ui.perfetto.dev 打开
+    public static native void native_SetTraceEnabled(boolean enabled);
+    public static native int native_DumpTrace(String path);
+
+    public static native void native_SetProgramCacheDir(String dir);
+
     public interface EventCallback {
         void onPlayerEvent(int msgType, float msgValue);
     }